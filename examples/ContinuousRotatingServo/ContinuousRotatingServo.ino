@@ -117,4 +117,41 @@ void loop() {
         blinkLED();
     }
     delay(1000);
+
+#if defined(ENABLE_VELOCITY_MODE)
+    /*
+     * Velocity mode with calibrated stop value, deadband of 20 us and 0.5 seconds from stop to maximum speed
+     */
+    Serial.println(F("Velocity mode: rotate clockwise to maximum speed, then counter clockwise and stop"));
+    Servo1.setVelocityModeParameters(MICROSECONDS_FOR_ROTATING_SERVO_STOP, MICROSECONDS_FOR_ROTATING_SERVO_CLOCKWISE_MAX, 20, 200);
+    Servo1.setVelocity(100);
+    delay(2000);
+    Servo1.setVelocity(-100);
+    delay(2000);
+    Servo1.setVelocity(0);
+    while (areInterruptsActive()) {
+        blinkLED();
+    }
+    delay(1000);
+#endif
+
+#if defined(ENABLE_DEAD_RECKONING)
+    /*
+     * Measured degree per second of my servo at 0, 25, 50, 75 and 100 percent velocity
+     */
+    static const uint16_t sDegreesPerSecond[VELOCITY_CALIBRATION_POINTS] = { 0, 60, 150, 220, 260 };
+    Servo1.setVelocityCalibration(sDegreesPerSecond);
+    Serial.println(F("Dead reckoning: rotate one turn clockwise and a half turn back"));
+    Servo1.rotateBy(360, 100);
+    while (areInterruptsActive()) {
+        blinkLED();
+    }
+    Servo1.rotateBy(-180, 50);
+    while (areInterruptsActive()) {
+        blinkLED();
+    }
+    Serial.print(F("Estimated angle="));
+    Serial.println(Servo1.getEstimatedAngleMillidegree() / 1000);
+    delay(1000);
+#endif
 }
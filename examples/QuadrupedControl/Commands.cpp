@@ -155,7 +155,7 @@ void __attribute__((weak)) doBow() {
 
     // Lift front legs
     sServoArray[FRONT_LEFT_LIFT]->setEaseTo(LIFT_LOWEST_ANGLE, sServoSpeed);
-    sServoArray[FRONT_RIGHT_LIFT]->startEaseToD(LIFT_LOWEST_ANGLE, sServoArray[FRONT_LEFT_LIFT]->mMillisForCompleteMove);
+    sServoArray[FRONT_RIGHT_LIFT]->startEaseToD(LIFT_LOWEST_ANGLE, sServoArray[FRONT_LEFT_LIFT]->getMillisForCompleteMove());
     updateAndCheckInputAndWaitForAllServosToStop();
     RETURN_IF_STOP;
 
@@ -137,11 +137,6 @@ void __attribute__((weak)) doRobotArmAutoMove() {
 
     doSetToAutoModeForRobotArm();
 
-    if (sInverseKinematicModeActive) {
-        setEasingTypeForAllServos(EASE_USER_DIRECT);
-        ClawServo.setEasingType(EASE_LINEAR);
-    }
-
     // init start position for first move
     sEndPosition.LeftRightDegree = sServoNextPositionArray[SERVO_BASE_PIVOT];
     sEndPosition.BackFrontDegree = sServoNextPositionArray[SERVO_HORIZONTAL];
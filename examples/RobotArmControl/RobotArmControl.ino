@@ -126,11 +126,6 @@ void setup() {
 
 void loop() {
 
-    // Reset mode to linear for all servos
-    if (sInverseKinematicModeActive) {
-        setEasingTypeForAllServos(EASE_LINEAR);
-    }
-
     checkVCC();
 
 #if defined(ROBOT_ARM_RTC_CONTROL)
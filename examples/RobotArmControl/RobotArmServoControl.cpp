@@ -10,6 +10,7 @@
 #include "RobotArmServoControl.h"
 #include "RobotArmKinematics.h"
 #include "RobotArmControl.h"
+#include "Commands.h"
 
 //#define DEBUG
 
@@ -36,14 +37,10 @@ int sClawServoAngle = CLAW_START_ANGLE;
  * Servo movement
  */
 uint8_t sEasingType = EASE_LINEAR;
-float sLastPercentageOfCompletion;
 uint16_t sServoSpeed = 60;      // in degree/second
 
-// User functions for ServoEasing implementing Inverse kinematics movement
-// TODO test carefully
-float moveInverseKinematicForBase(float aPercentageOfCompletion);
-float moveInverseKinematicForHorizontal(float aPercentageOfCompletion);
-float moveInverseKinematicForLift(float aPercentageOfCompletion);
+// Group move function for ServoEasing implementing Inverse kinematics movement
+void moveInverseKinematic(float aPercentageOfCompletion, int * aDegreeArray, void * aUserDataPointer);
 
 #define STR_HELPER(x) #x
 #define STR(x) STR_HELPER(x)
@@ -58,7 +55,6 @@ void setupRobotArmServos() {
     BasePivotServo.attach(PIVOT_SERVO_PIN, PIVOT_ZERO_DEGREE_VALUE_MICROS, PIVOT_AT_180_DEGREE_VALUE_MICROS);
     BasePivotServo.setTrim(PIVOT_OFFSET + PIVOT_TRIM); // =86
     BasePivotServo.write(PIVOT_NEUTRAL_OFFSET_DEGREE);
-    BasePivotServo.registerUserEaseInFunction(&moveInverseKinematicForBase);
 
     /*
      * Wait for pivot servo and then move horizontal one
@@ -66,7 +62,6 @@ void setupRobotArmServos() {
     delay(200);
     HorizontalServo.attach(HORIZONTAL_SERVO_PIN, HORIZONTAL_ZERO_DEGREE_VALUE_MICROS, HORIZONTAL_AT_180_DEGREE_VALUE_MICROS);
     HorizontalServo.write(HORIZONTAL_NEUTRAL_OFFSET_DEGREE);
-    HorizontalServo.registerUserEaseInFunction(&moveInverseKinematicForHorizontal);
 
     /*
      * Wait for horizontal servo and then move lift and claw servos
@@ -77,11 +72,6 @@ void setupRobotArmServos() {
     LiftServo.write(LIFT_NEUTRAL_OFFSET_DEGREE);
     ClawServo.write(CLAW_START_ANGLE);
 
-    /*
-     * Register functions for smooth moving with inverse kinematics
-     */
-    LiftServo.registerUserEaseInFunction(&moveInverseKinematicForLift);
-
     Serial.println(F("Value for 0 degree=" STR(HORIZONTAL_ZERO_DEGREE_VALUE_MICROS) "us. Value for 180 degree=" STR(HORIZONTAL_AT_180_DEGREE_VALUE_MICROS) "us."));
 }
 
@@ -181,7 +171,22 @@ void closeClaw() {
 }
 
 /*
- * Use inverse kinematics user easing function for movement from current position to the new position
+ * Move from sStartPosition to sEndPosition.
+ * In inverse kinematic mode, the claw moves on a straight line, otherwise each servo moves with its own easing.
+ */
+void moveToEndPosition() {
+    uint16_t tMillisForMove = getDurationMillisForMove();
+    if (sInverseKinematicModeActive) {
+        // The kinematics is solved only once per update for all 3 servos
+        startGroupMoveD(&moveInverseKinematic, SERVO_BASE_PIVOT, 3, tMillisForMove, NULL, false);
+        updateAndCheckInputAndWaitForAllServosToStop();
+    } else {
+        setAllServosD(tMillisForMove, 3, sEndPosition.LeftRightDegree, sEndPosition.BackFrontDegree, sEndPosition.DownUpDegree);
+    }
+}
+
+/*
+ * Use inverse kinematics group move function for movement from current position to the new position
  * If parameter is KEEP_POSITION, the position will not be changed
  */
 bool goToPosition(int aLeftRightMilliMeter, int aBackFrontMilliMeter, int aDownUpMilliMeter) {
@@ -220,9 +225,7 @@ bool goToPosition(int aLeftRightMilliMeter, int aBackFrontMilliMeter, int aDownU
     Serial.print("End: ");
     printPosition(&sEndPosition);
 #endif
-    sLastPercentageOfCompletion = -2.0; // to force first computation
-    setAllServosD(getDurationMillisForMove(), 3, sEndPosition.LeftRightDegree, sEndPosition.BackFrontDegree,
-            sEndPosition.DownUpDegree);
+    moveToEndPosition();
     return true;
 }
 
@@ -252,9 +255,7 @@ bool goToPositionRelative(int aLeftRightDeltaMilliMeter, int aBackFrontDeltaMill
     Serial.print("End: ");
     printPosition(&sEndPosition);
 #endif
-    sLastPercentageOfCompletion = -2.0; // to force first computation
-    setAllServosD(getDurationMillisForMove(), 3, sEndPosition.LeftRightDegree, sEndPosition.BackFrontDegree,
-            sEndPosition.DownUpDegree);
+    moveToEndPosition();
     return true;
 }
 
@@ -282,42 +283,14 @@ void computeNewCurrentAngles(float aPercentageOfCompletion) {
 }
 
 /*
- * Inverse kinematics callback functions for ServoEasing
+ * Inverse kinematics group move function for ServoEasing. Called once per update for base, horizontal and lift servo.
  */
-float moveInverseKinematicForBase(float aPercentageOfCompletion) {
-    if (aPercentageOfCompletion - sLastPercentageOfCompletion > 0.005) {
-#ifdef TRACE
-        Serial.print("B ");
-#endif
-        /*
-         * Use a global variable in order to do it only once for all 3 servos
-         */
-        sLastPercentageOfCompletion = aPercentageOfCompletion;
-        computeNewCurrentAngles(aPercentageOfCompletion);
-    }
-    return sCurrentPosition.LeftRightDegree + EASE_FUNCTION_DEGREE_INDICATOR_OFFSET;
-}
-
-float moveInverseKinematicForHorizontal(float aPercentageOfCompletion) {
-    if (aPercentageOfCompletion - sLastPercentageOfCompletion > 0.005) {
-#ifdef TRACE
-        Serial.print("H ");
-#endif
-        sLastPercentageOfCompletion = aPercentageOfCompletion;
-        computeNewCurrentAngles(aPercentageOfCompletion);
-    }
-    return sCurrentPosition.BackFrontDegree + EASE_FUNCTION_DEGREE_INDICATOR_OFFSET;
-}
-
-float moveInverseKinematicForLift(float aPercentageOfCompletion) {
-    if (aPercentageOfCompletion - sLastPercentageOfCompletion > 0.005) {
-#ifdef TRACE
-        Serial.print("V ");
-#endif
-        sLastPercentageOfCompletion = aPercentageOfCompletion;
-        computeNewCurrentAngles(aPercentageOfCompletion);
-    }
-    return sCurrentPosition.DownUpDegree + EASE_FUNCTION_DEGREE_INDICATOR_OFFSET;
+void moveInverseKinematic(float aPercentageOfCompletion, int * aDegreeArray, void * aUserDataPointer) {
+    (void) aUserDataPointer;
+    computeNewCurrentAngles(aPercentageOfCompletion);
+    aDegreeArray[SERVO_BASE_PIVOT] = sCurrentPosition.LeftRightDegree;
+    aDegreeArray[SERVO_HORIZONTAL] = sCurrentPosition.BackFrontDegree;
+    aDegreeArray[SERVO_LIFT] = sCurrentPosition.DownUpDegree;
 }
 
 void testInverseKinematic() {
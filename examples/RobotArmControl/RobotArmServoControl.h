@@ -26,7 +26,6 @@ extern int sLiftServoAngle;
 extern int sClawServoAngle;
 
 extern uint8_t sEasingType;
-extern float sLastPercentageOfCompletion;
 extern uint16_t sServoSpeed;      // in degree/second
 
 void setupRobotArmServos();
@@ -47,6 +46,7 @@ bool goToPosition(int aLeftRightMilliMeter, int aBackFrontMilliMeter, int aDownU
 bool goToPositionRelative(int aLeftRightDeltaMilliMeter, int aBackFrontDeltaMilliMeter, int aDownUpDeltaMilliMeter);
 
 uint16_t getMaxDeltaMillimeter();
+void moveToEndPosition();
 
 void computeNewCurrentAngles(float aPercentageOfCompletion);
 void testInverseKinematic();
@@ -170,8 +170,8 @@ void loop() {
     Serial.println(F(" degree per second using interrupts"));
 #endif
     Servo1.setEaseTo(45);
-    Servo2.setEaseToD(45, Servo1.mMillisForCompleteMove);
-    Servo3.startEaseToD(45, Servo1.mMillisForCompleteMove);
+    Servo2.setEaseToD(45, Servo1.getMillisForCompleteMove());
+    Servo3.startEaseToD(45, Servo1.getMillisForCompleteMove());
     /*
      * No need to call synchronizeAllServosAndStartInterrupt(), since I know that all durations are the same
      * Since all servos stops at the same time I have to check only one
@@ -148,10 +148,9 @@ void loop() {
 #ifndef PRINT_FOR_SERIAL_PLOTTER
     Serial.println(F("Move to 180/180/0 degree with 30 degree per second using interrupts"));
 #endif
-    sServoNextPositionArray[0] = 180;
-    sServoNextPositionArray[1] = 180;
-    sServoNextPositionArray[2] = 0;
-    setEaseToForAllServosSynchronizeAndStartInterrupt(30);
+    static const int sTargetPositions[] PROGMEM = { 180, 180, 0 };
+    setSpeedForAllServos(30);
+    startEaseToArrayPositions_P(sTargetPositions, 3); // Sets, synchronizes and starts all 3 servos in one pass
     /*
      * Now you can run your program while the servos are moving.
      * Just let the LED blink until servos stop.
@@ -170,7 +169,7 @@ void loop() {
     Serial.println(F("Move to 90/90 degree with 40 degree per second using interrupts"));
 #endif
     Servo1.setEaseTo(90, 80);
-    Servo2.startEaseToD(90, Servo1.mMillisForCompleteMove);
+    Servo2.startEaseToD(90, Servo1.getMillisForCompleteMove());
     // No timing synchronization needed :-)
     // blink until servo stops
     while (areInterruptsActive()) {
@@ -136,7 +136,7 @@ void loop() {
      * An alternative method to synchronize and start
      * Synchronize by simply using the same duration
      */
-    Servo2.startEaseToD(10, Servo1.mMillisForCompleteMove); // This start interrupt for all servos
+    Servo2.startEaseToD(10, Servo1.getMillisForCompleteMove()); // This start interrupt for all servos
     /*
      * Now you can run your program while the servos are moving.
      * Just let the LED blink until servos stop.
@@ -0,0 +1,189 @@
+/*
+ * CalibrationStoreTest.cpp
+ *
+ *  Prints the calibration store dump, writes it to build/CalibrationDump.txt for the check with extras/ServoEasingCalibration.py
+ *  and sends it back to readCalibrationStoreDump() like the python tool does, i.e. each line only after the "OK" for the preceding line.
+ *  Checks that no more than the 64 characters of the AVR serial buffer are waiting, that the record is restored
+ *  and that a corrupted line is rejected.
+ *
+ *  Copyright (C) 2020  Armin Joachimsmeyer
+ *  armin.joachimsmeyer@gmail.com
+ *
+ *  This file is part of ServoEasing https://github.com/ArminJo/ServoEasing.
+ *
+ *  ServoEasing is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/gpl.html>.
+ */
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <Wire.h>
+#include "ServoEasing.h"
+
+#define NUMBER_OF_SERVOS            12
+#define AVR_SERIAL_BUFFER_SIZE      64
+
+#if defined(USE_PCA9685_SERVO_EXPANDER)
+ServoEasing sServos[NUMBER_OF_SERVOS] = { ServoEasing(PCA9685_DEFAULT_ADDRESS), ServoEasing(PCA9685_DEFAULT_ADDRESS), ServoEasing(
+        PCA9685_DEFAULT_ADDRESS), ServoEasing(PCA9685_DEFAULT_ADDRESS), ServoEasing(PCA9685_DEFAULT_ADDRESS), ServoEasing(
+        PCA9685_DEFAULT_ADDRESS), ServoEasing(PCA9685_DEFAULT_ADDRESS), ServoEasing(PCA9685_DEFAULT_ADDRESS), ServoEasing(
+        PCA9685_DEFAULT_ADDRESS), ServoEasing(PCA9685_DEFAULT_ADDRESS), ServoEasing(PCA9685_DEFAULT_ADDRESS), ServoEasing(
+        PCA9685_DEFAULT_ADDRESS) };
+#else
+ServoEasing sServos[NUMBER_OF_SERVOS];
+#endif
+int sNumberOfErrors = 0;
+
+void check(bool aCondition, const char *aText) {
+    if (!aCondition) {
+        printf("Error: %s\n", aText);
+        sNumberOfErrors++;
+    }
+}
+
+/*
+ * Collects the output of printCalibrationStoreDump()
+ */
+class StringPrint: public Print {
+public:
+    size_t write(uint8_t aByte) {
+        mText += (char) aByte;
+        return 1;
+    }
+    std::string mText;
+};
+
+/*
+ * Serial link to the python tool. The next line is only sent after the receiver printed "OK".
+ */
+class AcknowledgingSender: public Stream {
+public:
+    AcknowledgingSender(const std::vector<std::string> &aLines) :
+            mLines(aLines), mNextLine(0), mMaxWaitingCharacters(0) {
+        sendNextLine();
+    }
+    void sendNextLine() {
+        if (mNextLine < mLines.size()) {
+            mReceiveBuffer += mLines[mNextLine++] + "\r\n";
+            if (mReceiveBuffer.size() > mMaxWaitingCharacters) {
+                mMaxWaitingCharacters = mReceiveBuffer.size();
+            }
+        }
+    }
+    int available() {
+        return mReceiveBuffer.size();
+    }
+    int read() {
+        if (mReceiveBuffer.empty()) {
+            return -1;
+        }
+        char tChar = mReceiveBuffer[0];
+        mReceiveBuffer.erase(0, 1);
+        return tChar;
+    }
+    size_t write(uint8_t aByte) {
+        if (aByte == '\n') {
+            mAnswers.push_back(mAnswer);
+            if (mAnswer == "OK") {
+                sendNextLine();
+            }
+            mAnswer.clear();
+        } else {
+            mAnswer += (char) aByte;
+        }
+        return 1;
+    }
+    std::vector<std::string> mLines;
+    size_t mNextLine;
+    std::string mReceiveBuffer;
+    size_t mMaxWaitingCharacters;
+    std::string mAnswer;
+    std::vector<std::string> mAnswers;
+};
+
+/*
+ * @return the lines of the dump, with "CAL:" removed, since it is read by the sketch before calling readCalibrationStoreDump()
+ */
+std::vector<std::string> getDumpLinesForReceiver(const std::string &aDump) {
+    std::vector<std::string> tLines;
+    size_t tStart = 0;
+    size_t tEnd;
+    while ((tEnd = aDump.find('\n', tStart)) != std::string::npos) {
+        tLines.push_back(aDump.substr(tStart, tEnd - tStart));
+        tStart = tEnd + 1;
+    }
+    tLines[0].erase(0, 4);
+    return tLines;
+}
+
+int main() {
+    for (uint_fast8_t i = 0; i < NUMBER_OF_SERVOS; ++i) {
+        sServos[i].attach(i);
+        sServos[i].setTrim(i - 5);
+        sServos[i].setSpeed(10 + i);
+    }
+    sServos[3].setReverseOperation(true);
+    check(saveCalibrationStore(), "saveCalibrationStore() failed");
+    std::vector<uint8_t> tRecord(&EEPROM.mData[CALIBRATION_STORE_EEPROM_START_ADDRESS],
+            &EEPROM.mData[CALIBRATION_STORE_EEPROM_START_ADDRESS + 2 + NUMBER_OF_SERVOS * CALIBRATION_ENTRY_SIZE + 2]);
+
+    StringPrint tDump;
+    printCalibrationStoreDump(&tDump);
+    FILE *tDumpFile = fopen("build/CalibrationDump.txt", "w");
+    if (tDumpFile != NULL) {
+        fputs(tDump.mText.c_str(), tDumpFile);
+        fclose(tDumpFile);
+    }
+    std::vector<std::string> tLines = getDumpLinesForReceiver(tDump.mText);
+    check(tLines.size() == 1 + NUMBER_OF_SERVOS, "dump has not one line for each servo");
+#if defined(USE_PCA9685_SERVO_EXPANDER)
+    check(tLines[1].substr(2 + 2 * 16, 2) == "02", "PCA9685 units are not recorded in the flags");
+#else
+    check(tLines[1].substr(2 + 2 * 16, 2) == "00", "microseconds are recorded as PCA9685 units");
+#endif
+
+    /*
+     * Send the dump back
+     */
+    clearCalibrationStore();
+    uint32_t tNumberOfWrittenBytesBefore = EEPROM.mNumberOfWrittenBytes;
+    AcknowledgingSender tSender(tLines);
+    bool tResult = readCalibrationStoreDump(&tSender);
+    printf("Dump of %u servos received with %u answers, max %u characters waiting, %u EEPROM bytes written\n",
+            (unsigned int) NUMBER_OF_SERVOS, (unsigned int) tSender.mAnswers.size(), (unsigned int) tSender.mMaxWaitingCharacters,
+            (unsigned int) (EEPROM.mNumberOfWrittenBytes - tNumberOfWrittenBytesBefore));
+    check(tResult, "readCalibrationStoreDump() failed");
+    check(tSender.mNextLine == tLines.size() && tSender.mReceiveBuffer == "\r\n", "not all lines were read");
+    check(tSender.mMaxWaitingCharacters <= AVR_SERIAL_BUFFER_SIZE, "lines do not fit into the AVR serial buffer");
+    check(std::equal(tRecord.begin(), tRecord.end(), &EEPROM.mData[CALIBRATION_STORE_EEPROM_START_ADDRESS]),
+            "received record differs from saved record");
+    sServos[0].detach();
+    sServos[0].attach(0);
+    check(sServos[0].mTrimMicrosecondsOrUnits == tRecord[6] + (tRecord[7] << 8) - 0x10000, "received trim is not applied");
+
+    /*
+     * A corrupted line must be rejected without validating the record
+     */
+    tLines[5][10] = (tLines[5][10] == '0') ? '1' : '0';
+    AcknowledgingSender tCorruptedSender(tLines);
+    check(!readCalibrationStoreDump(&tCorruptedSender), "corrupted dump was accepted");
+    check(tCorruptedSender.mAnswers.back() == "ERROR", "corrupted dump was not answered by ERROR");
+    check(tCorruptedSender.mNextLine == 6, "lines were sent after the corrupted line");
+    check(EEPROM.mData[CALIBRATION_STORE_EEPROM_START_ADDRESS] != CALIBRATION_STORE_VERSION, "record of corrupted dump is valid");
+
+    return sNumberOfErrors;
+}
@@ -0,0 +1,129 @@
+/*
+ * ConversionTest.cpp
+ *
+ *  Compares DegreeToMicrosecondsOrUnits() and MicrosecondsOrUnitsToDegree() with the map() and division based
+ *  conversions of version 2.3.2 for several attach() ranges. The new conversions round instead of truncate,
+ *  so the results may differ by 1 microsecond, 1 unit or 1 degree, but never more.
+ *  Also measures the time of both conversions on the host.
+ *
+ *  Copyright (C) 2020  Armin Joachimsmeyer
+ *  armin.joachimsmeyer@gmail.com
+ *
+ *  This file is part of ServoEasing https://github.com/ArminJo/ServoEasing.
+ *
+ *  ServoEasing is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/gpl.html>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "ServoEasing.h"
+
+#define NUMBER_OF_LOOPS     20000
+
+struct ConversionRange {
+    int Microseconds0Degree;
+    int Microseconds180Degree;
+};
+const ConversionRange sRanges[] = { { DEFAULT_MICROSECONDS_FOR_0_DEGREE, DEFAULT_MICROSECONDS_FOR_180_DEGREE }, { 500, 2500 }, {
+        1000, 2000 }, { 2400, 544 }, { 600, 2300 } };
+
+/*
+ * The conversions of version 2.3.2
+ */
+__attribute__((noinline)) int oldDegreeToMicrosecondsOrUnits(ServoEasing *aServo, int aDegree) {
+    return map(aDegree, 0, 180, aServo->mServo0DegreeMicrosecondsOrUnits, aServo->mServo180DegreeMicrosecondsOrUnits);
+}
+
+__attribute__((noinline)) int oldMicrosecondsOrUnitsToDegree(ServoEasing *aServo, int aMicrosecondsOrUnits) {
+    int32_t tDelta = aServo->mServo180DegreeMicrosecondsOrUnits - aServo->mServo0DegreeMicrosecondsOrUnits;
+    int32_t tResult = ((int32_t) (aMicrosecondsOrUnits - aServo->mServo0DegreeMicrosecondsOrUnits) * 180) + (tDelta / 2);
+    return tResult / tDelta;
+}
+
+int main() {
+#if defined(USE_PCA9685_SERVO_EXPANDER)
+    ServoEasing tServo(PCA9685_DEFAULT_ADDRESS);
+    const char *tUnitText = "units";
+#else
+    ServoEasing tServo;
+    const char *tUnitText = "us";
+#endif
+    int tNumberOfErrors = 0;
+    for (uint_fast8_t i = 0; i < sizeof(sRanges) / sizeof(sRanges[0]); ++i) {
+        tServo.attach(0, sRanges[i].Microseconds0Degree, sRanges[i].Microseconds180Degree);
+        int tNumberOfDifferentValues = 0;
+        int tNumberOfDifferentDegrees = 0;
+        for (int tDegree = 0; tDegree <= 180; ++tDegree) {
+            int tDifference = tServo.DegreeToMicrosecondsOrUnits(tDegree) - oldDegreeToMicrosecondsOrUnits(&tServo, tDegree);
+            if (tDifference != 0) {
+                tNumberOfDifferentValues++;
+            }
+            if (abs(tDifference) > 1) {
+                printf("Error: %d degree gives %d instead of %d %s\n", tDegree, tServo.DegreeToMicrosecondsOrUnits(tDegree),
+                        oldDegreeToMicrosecondsOrUnits(&tServo, tDegree), tUnitText);
+                tNumberOfErrors++;
+            }
+        }
+        int tFirst = std::min(tServo.mServo0DegreeMicrosecondsOrUnits, tServo.mServo180DegreeMicrosecondsOrUnits);
+        int tLast = std::max(tServo.mServo0DegreeMicrosecondsOrUnits, tServo.mServo180DegreeMicrosecondsOrUnits);
+        for (int tValue = tFirst; tValue <= tLast; ++tValue) {
+            int tDifference = tServo.MicrosecondsOrUnitsToDegree(tValue) - oldMicrosecondsOrUnitsToDegree(&tServo, tValue);
+            if (tDifference != 0) {
+                tNumberOfDifferentDegrees++;
+            }
+            if (abs(tDifference) > 1) {
+                printf("Error: %d %s gives %d instead of %d degree\n", tValue, tUnitText, tServo.MicrosecondsOrUnitsToDegree(tValue),
+                        oldMicrosecondsOrUnitsToDegree(&tServo, tValue));
+                tNumberOfErrors++;
+            }
+        }
+        printf("%4d to %4d us: %3d of 181 degree values and %3d of %4d %s values differ by 1\n", sRanges[i].Microseconds0Degree,
+                sRanges[i].Microseconds180Degree, tNumberOfDifferentValues, tNumberOfDifferentDegrees, (tLast - tFirst) + 1, tUnitText);
+        tServo.detach();
+    }
+
+    /*
+     * Time of the conversions on the host. This is no replacement for a measurement on an AVR without hardware divider.
+     */
+    tServo.attach(0);
+    volatile int tSum = 0;
+    auto tStart = std::chrono::steady_clock::now();
+    for (uint_fast16_t i = 0; i < NUMBER_OF_LOOPS; ++i) {
+        for (int tDegree = 0; tDegree <= 180; ++tDegree) {
+            tSum += oldDegreeToMicrosecondsOrUnits(&tServo, tDegree);
+            tSum += oldMicrosecondsOrUnitsToDegree(&tServo, tDegree + tServo.mServo0DegreeMicrosecondsOrUnits);
+        }
+    }
+    double tOldNanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - tStart).count();
+    tStart = std::chrono::steady_clock::now();
+    for (uint_fast16_t i = 0; i < NUMBER_OF_LOOPS; ++i) {
+        for (int tDegree = 0; tDegree <= 180; ++tDegree) {
+            tSum += tServo.DegreeToMicrosecondsOrUnits(tDegree);
+            tSum += tServo.MicrosecondsOrUnitsToDegree(tDegree + tServo.mServo0DegreeMicrosecondsOrUnits);
+        }
+    }
+    double tNewNanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - tStart).count();
+    printf("Host time for both conversions: %.2f ns with map() and division, %.2f ns with precomputed factors\n",
+            tOldNanos / (NUMBER_OF_LOOPS * 181), tNewNanos / (NUMBER_OF_LOOPS * 181));
+
+    if (tNumberOfErrors == 0) {
+        printf("Conversion test passed\n");
+    }
+    return tNumberOfErrors;
+}
@@ -0,0 +1,92 @@
+/*
+ * PCA9685BurstTest.cpp
+ *
+ *  Counts the I2C transactions and bytes of moves of 32 servos at 2 PCA9685 expanders
+ *  and checks the final PCA9685 registers and the length of each transaction.
+ *  The Makefile runs it without and with ENABLE_PCA9685_BURST_WRITE etc. to compare the numbers.
+ *
+ *  Copyright (C) 2020  Armin Joachimsmeyer
+ *  armin.joachimsmeyer@gmail.com
+ *
+ *  This file is part of ServoEasing https://github.com/ArminJo/ServoEasing.
+ *
+ *  ServoEasing is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/gpl.html>.
+ */
+
+#include <stdio.h>
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "ServoEasing.h"
+
+#if MAX_EASING_SERVOS < 32
+#error "Compile with -DMAX_EASING_SERVOS=32"
+#endif
+#define NUMBER_OF_SERVOS    32
+
+ServoEasing * sServos[NUMBER_OF_SERVOS];
+int sNumberOfErrors = 0;
+
+/*
+ * Moves the servos with index % aServoDivider == 0 to aDegree and prints the I2C statistics
+ */
+void moveAndPrintStatistics(int aDegree, uint_fast8_t aServoDivider, const char *aText) {
+    Wire.resetStatistics();
+    for (uint_fast8_t i = 0; i < NUMBER_OF_SERVOS; i += aServoDivider) {
+        sServos[i]->setEaseTo(aDegree, 90);
+    }
+    synchronizeAllServosAndStartInterrupt(false);
+    uint_fast16_t tNumberOfUpdates = 0;
+    do {
+        delay(REFRESH_INTERVAL_MILLIS);
+        tNumberOfUpdates++;
+    } while (!updateAllServos());
+    printf("%-18s %3u updates, %5u transactions, %6u bytes, %5.1f bytes and %6.0f us bus time per update\n", aText,
+            (unsigned int) tNumberOfUpdates, Wire.mNumberOfTransactions, Wire.mNumberOfBytes,
+            (float) Wire.mNumberOfBytes / tNumberOfUpdates, (float) Wire.mBusMicros / tNumberOfUpdates);
+    if (Wire.mNumberOfOverflows != 0) {
+        printf("Error: %u transactions are longer than the Wire buffer\n", Wire.mNumberOfOverflows);
+        sNumberOfErrors++;
+    }
+}
+
+int main() {
+    for (uint_fast8_t i = 0; i < NUMBER_OF_SERVOS; ++i) {
+        sServos[i] = new ServoEasing(PCA9685_DEFAULT_ADDRESS + (i / PCA9685_MAX_CHANNELS), &Wire);
+        sServos[i]->attach(i % PCA9685_MAX_CHANNELS);
+        sServos[i]->write(0);
+    }
+    moveAndPrintStatistics(90, 1, "All servos moving");
+    moveAndPrintStatistics(0, 3, "Every 3. moving");
+    moveAndPrintStatistics(45, 16, "2 servos moving");
+
+    for (uint_fast8_t i = 0; i < NUMBER_OF_SERVOS; ++i) {
+        uint8_t tAddress = PCA9685_DEFAULT_ADDRESS + (i / PCA9685_MAX_CHANNELS);
+        uint8_t tChannel = i % PCA9685_MAX_CHANNELS;
+        int tUnits = Wire.getPCA9685OffValue(tAddress, tChannel) - Wire.getPCA9685OnValue(tAddress, tChannel);
+        if (tUnits != sServos[i]->getEndMicrosecondsOrUnitsWithTrim()) {
+            printf("Error: servo %u has %d units in PCA9685 register instead of %d\n", (unsigned int) i, tUnits,
+                    sServos[i]->getEndMicrosecondsOrUnitsWithTrim());
+            sNumberOfErrors++;
+        }
+    }
+    if (Wire.mNumberOfNestedTransmissions != 0) {
+        printf("Error: %u nested transmissions\n", Wire.mNumberOfNestedTransmissions);
+        sNumberOfErrors++;
+    }
+    if (sNumberOfErrors == 0) {
+        printf("PCA9685 burst test passed\n");
+    }
+    return sNumberOfErrors;
+}
@@ -0,0 +1,102 @@
+/*
+ * PackedServoTest.cpp
+ *
+ *  Checks size and moves of ServoEasingPacked. The Makefile runs it for each PCA9685 build configuration.
+ *  On AVR, ServoEasing.h checks the size of 11 bytes by static_assert.
+ *
+ *  Copyright (C) 2020  Armin Joachimsmeyer
+ *  armin.joachimsmeyer@gmail.com
+ *
+ *  This file is part of ServoEasing https://github.com/ArminJo/ServoEasing.
+ *
+ *  ServoEasing is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/gpl.html>.
+ */
+
+#include <stdio.h>
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "ServoEasing.h"
+
+#define PACKED_SERVO_MAX_SIZE   12 // 11 bytes padded to 12 on 16 and 32 bit platforms
+
+ServoEasingPackedProfile sProfile;
+ServoEasingPacked sPackedServos[3];
+int sNumberOfErrors = 0;
+
+void check(bool aCondition, const char *aText) {
+    if (!aCondition) {
+        printf("Error: %s\n", aText);
+        sNumberOfErrors++;
+    }
+}
+
+int main() {
+    printf("sizeof(ServoEasingPacked)=%u sizeof(ServoEasing)=%u\n", (unsigned int) sizeof(ServoEasingPacked),
+            (unsigned int) sizeof(ServoEasing));
+    check(sizeof(ServoEasingPacked) <= PACKED_SERVO_MAX_SIZE, "ServoEasingPacked got bigger than 12 bytes");
+    check(sizeof(ServoEasingPacked) * 4 < sizeof(ServoEasing), "ServoEasingPacked does not save RAM");
+
+    check(!sPackedServos[0].attach(0, 1), "attach() accepted a profile, which is not set");
+    setPackedServoProfile(0, &sProfile, PCA9685_DEFAULT_ADDRESS);
+    setPackedServoArray(sPackedServos, 3);
+    for (uint_fast8_t i = 0; i < 3; ++i) {
+        check(sPackedServos[i].attach(i), "attach() failed");
+        sPackedServos[i].write(0);
+    }
+    check(Wire.getPCA9685OffValue(PCA9685_DEFAULT_ADDRESS, 0) - Wire.getPCA9685OnValue(PCA9685_DEFAULT_ADDRESS, 0)
+            == sProfile.Servo0DegreeUnits, "write(0) did not set the 0 degree pulse");
+
+    /*
+     * Move over the 16 bit millis() overflow
+     */
+    setHostMillis(0xFFFFFF00);
+    sPackedServos[0].startEaseToD(180, 1000, false);
+    sPackedServos[1].startEaseTo(90, 90, false);
+    delay(500);
+    updateAllPackedServos();
+    check(sPackedServos[0].getCurrentAngle() >= 89 && sPackedServos[0].getCurrentAngle() <= 91, "Servo 0 not at 90 degree after 500 ms");
+    check(sPackedServos[1].getCurrentAngle() >= 44 && sPackedServos[1].getCurrentAngle() <= 46, "Servo 1 not at 45 degree after 500 ms");
+    delay(600);
+    check(updateAllPackedServos(), "Servos still moving after 1100 ms");
+    check(sPackedServos[0].getCurrentAngle() == 180, "Servo 0 did not reach 180 degree");
+    check(Wire.getPCA9685OffValue(PCA9685_DEFAULT_ADDRESS, 0) - Wire.getPCA9685OnValue(PCA9685_DEFAULT_ADDRESS, 0)
+            == sProfile.Servo180DegreeUnits, "180 degree pulse not written");
+
+    /*
+     * 180 degree with 1 degree per second require 180 seconds, which are clamped to 65.535 seconds
+     */
+    sPackedServos[2].startEaseTo(180, 1, false);
+    check(sPackedServos[2].mMillisForCompleteMove == 0xFFFF, "Duration not clamped to 65535 ms");
+    delay(0xFFFF);
+    updateAllPackedServos();
+    check(sPackedServos[2].getCurrentAngle() == 180 && !sPackedServos[2].isMoving(), "Servo 2 did not stop after 65535 ms");
+
+    /*
+     * The functions of the default engine include the packed servos
+     */
+    sPackedServos[0].startEaseToD(0, 1000, false);
+    sPackedServos[1].startEaseToD(0, 500, false);
+    check(isOneServoMoving(), "isOneServoMoving() ignores packed servos");
+    synchronizeAllServosAndStartInterrupt(false);
+    check(sPackedServos[1].mMillisForCompleteMove == 1000 && sPackedServos[1].mMillisAtStartMove == sPackedServos[0].mMillisAtStartMove,
+            "synchronizeAllServosAndStartInterrupt() ignores packed servos");
+    stopAllServos();
+    check(!isOneServoMoving() && !sPackedServos[0].isMoving(), "stopAllServos() ignores packed servos");
+
+    if (sNumberOfErrors == 0) {
+        printf("Packed servo test passed\n");
+    }
+    return sNumberOfErrors;
+}
@@ -0,0 +1,132 @@
+/*
+ * SimulationDriverTest.cpp
+ *
+ *  Moves two servos with the ServoEasingSimulationDriver and checks the recorded pulses,
+ *  the flushes, the output of printSimulationRecords() and the ring buffer at the wrap of the total number of records.
+ *
+ *  Copyright (C) 2020  Armin Joachimsmeyer
+ *  armin.joachimsmeyer@gmail.com
+ *
+ *  This file is part of ServoEasing https://github.com/ArminJo/ServoEasing.
+ *
+ *  ServoEasing is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/gpl.html>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "ServoEasing.h"
+
+#if !defined(ENABLE_SERVO_DRIVER_INTERFACE)
+#error "SimulationDriverTest requires -DENABLE_SERVO_DRIVER_INTERFACE"
+#endif
+
+#if defined(USE_PCA9685_SERVO_EXPANDER)
+ServoEasing sServo0(PCA9685_DEFAULT_ADDRESS);
+ServoEasing sServo1(PCA9685_DEFAULT_ADDRESS);
+#else
+ServoEasing sServo0;
+ServoEasing sServo1;
+#endif
+int sNumberOfErrors = 0;
+
+void check(bool aCondition, const char *aText) {
+    if (!aCondition) {
+        printf("Error: %s\n", aText);
+        sNumberOfErrors++;
+    }
+}
+
+/*
+ * Collects the output of printSimulationRecords()
+ */
+class StringPrint: public Print {
+public:
+    size_t write(uint8_t aByte) {
+        mText += (char) aByte;
+        return 1;
+    }
+    std::string mText;
+};
+
+ServoEasingSimulationRecord* getNewestRecord() {
+    return &sSimulationRecordArray[(sSimulationWriteIndex + SIMULATION_DRIVER_NUMBER_OF_RECORDS - 1) % SIMULATION_DRIVER_NUMBER_OF_RECORDS];
+}
+
+int main() {
+    check(sServo0.setDriver(&ServoEasingSimulationDriver) && sServo1.setDriver(&ServoEasingSimulationDriver), "setDriver() failed");
+    sServo0.attach(0);
+    sServo1.attach(1);
+    sServo0.write(0);
+    sServo1.write(180);
+    check(sSimulationNumberOfRecords == 2, "write() was not recorded");
+    check(getNewestRecord()->ServoIndex == sServo1.mServoIndex && getNewestRecord()->Microseconds == sServo1.mCurrentMicrosecondsOrUnits,
+            "wrong record of write()");
+
+    /*
+     * Each update records one pulse of each moving servo and flushes the driver once
+     */
+    uint16_t tNumberOfRecordsBefore = sSimulationNumberOfRecords;
+    uint16_t tNumberOfFlushesBefore = sSimulationNumberOfFlushes;
+    sServo0.startEaseToD(90, 400, false);
+    sServo1.startEaseToD(90, 400, false);
+    uint_fast8_t tNumberOfUpdates = 0;
+    do {
+        delay(REFRESH_INTERVAL_MILLIS);
+        tNumberOfUpdates++;
+    } while (!updateAllServos());
+    check(sSimulationNumberOfFlushes - tNumberOfFlushesBefore == tNumberOfUpdates, "not one flush per update");
+    check(sSimulationNumberOfRecords - tNumberOfRecordsBefore == 2 * tNumberOfUpdates, "not one record per update and moving servo");
+    check(getNewestRecord()->Microseconds == sServo1.DegreeToMicrosecondsOrUnits(90), "end position not recorded");
+    check(getNewestRecord()->Millis == millis(), "wrong time of record");
+
+    /*
+     * printSimulationRecords() prints the last SIMULATION_DRIVER_NUMBER_OF_RECORDS records, oldest first
+     */
+    StringPrint tOutput;
+    printSimulationRecords(&tOutput);
+    uint_fast16_t tNumberOfLines = 0;
+    unsigned long tLastMillis = 0;
+    for (size_t tStart = 0; tStart < tOutput.mText.size(); tStart = tOutput.mText.find('\n', tStart) + 1) {
+        unsigned long tMillis = strtoul(tOutput.mText.c_str() + tStart, NULL, 10);
+        check(tMillis >= tLastMillis, "records are not printed oldest first");
+        tLastMillis = tMillis;
+        tNumberOfLines++;
+    }
+    check(tNumberOfLines == SIMULATION_DRIVER_NUMBER_OF_RECORDS, "not all records of the full array printed");
+
+    /*
+     * The wrap of the total number of records must not change the slot of the next records,
+     * which happened for a number of records like 20, which is no divisor of 0x10000
+     */
+    sSimulationNumberOfRecords = 0xFFFF;
+    uint16_t tWriteIndexBefore = sSimulationWriteIndex;
+    for (int i = 1; i <= 3; ++i) {
+        sServo0.write(i);
+        check(sSimulationRecordArray[(tWriteIndexBefore + i - 1) % SIMULATION_DRIVER_NUMBER_OF_RECORDS].Microseconds
+                == sServo0.DegreeToMicrosecondsOrUnits(i), "record is not in the slot after the previous one");
+    }
+    check(sSimulationNumberOfRecords == 2, "total number of records did not wrap");
+
+    sServo0.detach();
+    check(getNewestRecord()->Microseconds == 0, "detach() was not recorded");
+
+    if (sNumberOfErrors == 0) {
+        printf("Simulation driver test with %d updates passed\n", (int) tNumberOfUpdates);
+    }
+    return sNumberOfErrors;
+}
@@ -0,0 +1,109 @@
+/*
+ * UpdateMaskTest.cpp
+ *
+ *  Moves some of 100 servos, so the update mask and the group masks consist of several words,
+ *  and checks that the loops over the masks process exactly the servos with a set bit.
+ *
+ *  Copyright (C) 2020  Armin Joachimsmeyer
+ *  armin.joachimsmeyer@gmail.com
+ *
+ *  This file is part of ServoEasing https://github.com/ArminJo/ServoEasing.
+ *
+ *  ServoEasing is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/gpl.html>.
+ */
+
+#include <stdio.h>
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "ServoEasing.h"
+
+#if MAX_EASING_SERVOS != 100
+#error "UpdateMaskTest requires -DMAX_EASING_SERVOS=100"
+#endif
+
+ServoEasing sServos[MAX_EASING_SERVOS];
+int sNumberOfErrors = 0;
+
+void check(bool aCondition, const char *aText) {
+    if (!aCondition) {
+        printf("Error: %s\n", aText);
+        sNumberOfErrors++;
+    }
+}
+
+int main() {
+    for (uint_fast8_t i = 0; i < MAX_EASING_SERVOS; ++i) {
+        sServos[i].attach(i);
+        sServos[i].write(0);
+    }
+    check(sServos[MAX_EASING_SERVOS - 1].mServoIndex == MAX_EASING_SERVOS - 1, "last servo did not get the last index");
+
+    /*
+     * One servo in the first, one in a middle and one in the last word
+     */
+    const uint8_t tMovingIndexes[] = { 3, 40, 99 };
+    ServoEasingMask tExpectedMask;
+    tExpectedMask.clearAll();
+    for (uint_fast8_t i = 0; i < sizeof(tMovingIndexes); ++i) {
+        sServos[tMovingIndexes[i]].startEaseToD(90, 400, false);
+        tExpectedMask.setBit(tMovingIndexes[i]);
+    }
+    uint_fast8_t tNumberOfSetBits = 0;
+    for (uint_fast8_t tServoIndex = sServoEasingDefaultEngine.mServoUpdateMask.getNextIndex(0); tServoIndex < MAX_EASING_SERVOS;
+            tServoIndex = sServoEasingDefaultEngine.mServoUpdateMask.getNextIndex(tServoIndex + 1)) {
+        check(tExpectedMask.isBitSet(tServoIndex), "bit of a not started servo is set");
+        tNumberOfSetBits++;
+    }
+    check(tNumberOfSetBits == sizeof(tMovingIndexes), "bit of a started servo is not set");
+
+    uint32_t tNumberOfWritesBefore = sHostServoNumberOfWrites;
+    delay(200);
+    check(!updateAllServos(), "servos stopped after 200 ms");
+    check(sHostServoNumberOfWrites - tNumberOfWritesBefore == sizeof(tMovingIndexes), "not only the moving servos were written");
+    check(isOneServoMoving(), "isOneServoMoving() is false");
+    delay(300);
+    check(updateAllServos(), "servos still moving after 500 ms");
+    check(!isOneServoMoving(), "isOneServoMoving() is true after the move");
+    check(sServoEasingDefaultEngine.mServoUpdateMask.isEmpty(), "update mask not empty after the move");
+    for (uint_fast8_t i = 0; i < sizeof(tMovingIndexes); ++i) {
+        check(sServos[tMovingIndexes[i]].getCurrentAngle() == 90, "servo did not reach 90 degree");
+    }
+    check(sServos[4].getCurrentAngle() == 0, "not started servo was moved");
+
+    /*
+     * A group with members in different words, which are found by the and of two masks
+     */
+    ServoEasingGroup tGroup;
+    tGroup.addServo(&sServos[15]);
+    tGroup.addServo(&sServos[70]);
+    tGroup.addServo(&sServos[98]);
+    check(tGroup.isMember(&sServos[70]) && !tGroup.isMember(&sServos[71]), "wrong group membership");
+    sServos[70].startEaseToD(45, 100, false);
+    sServos[20].startEaseToD(45, 100, false);
+    check(tGroup.isOneServoMoving(), "group isOneServoMoving() is false");
+    sServos[70].stop();
+    check(!tGroup.isOneServoMoving(), "group isOneServoMoving() is true after stop() of its only moving servo");
+    check(sServoEasingDefaultEngine.mServoUpdateMask.getNextIndex(0, &tGroup.mServoMask) == 70, "and of masks is wrong");
+    check(sServoEasingDefaultEngine.mServoUpdateMask.getNextIndex(71, &tGroup.mServoMask) == MAX_EASING_SERVOS,
+            "and of masks has a bit after the last set one");
+    delay(200);
+    updateAllServos();
+    check(sServoEasingDefaultEngine.mServoUpdateMask.isEmpty(), "update mask not empty after the second move");
+
+    if (sNumberOfErrors == 0) {
+        printf("Update mask test with %d servos and %u mask words passed\n", MAX_EASING_SERVOS, (unsigned int) SERVO_EASING_MASK_WORDS);
+    }
+    return sNumberOfErrors;
+}
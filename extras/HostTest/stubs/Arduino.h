@@ -0,0 +1,128 @@
+/*
+ * Arduino.h
+ *
+ *  Minimal Arduino API for compiling and running ServoEasing on a PC.
+ *  millis() and micros() are simulated, delay() only advances the simulated time.
+ *
+ *  Copyright (C) 2020  Armin Joachimsmeyer
+ *  armin.joachimsmeyer@gmail.com
+ *
+ *  This file is part of ServoEasing https://github.com/ArminJo/ServoEasing.
+ *
+ *  ServoEasing is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/gpl.html>.
+ */
+
+#ifndef ARDUINO_HOST_STUB_H
+#define ARDUINO_HOST_STUB_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH    1
+#define LOW     0
+#define INPUT   0
+#define OUTPUT  1
+#define DEC     10
+#define HEX     16
+
+#define PROGMEM
+#define pgm_read_byte(aAddress) (*(const uint8_t *) (aAddress))
+#define pgm_read_word(aAddress) (*(const uint16_t *) (aAddress))
+class __FlashStringHelper;
+#define F(aString) (reinterpret_cast<const __FlashStringHelper *>(aString))
+
+#if !defined(_BV)
+#define _BV(bit) (1 << (bit))
+#endif
+#define constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+
+/*
+ * Simulated time. delay() and setHostMillis() advance it.
+ */
+extern uint32_t sHostMillis;
+void setHostMillis(uint32_t aMillis);
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long aMillis);
+void delayMicroseconds(unsigned int aMicroseconds);
+
+/*
+ * Interrupts are only simulated by calling handleServoTimerInterrupt() from the test.
+ * sHostInterruptsAreDisabled allows to check the restore of the interrupt state.
+ */
+extern bool sHostInterruptsAreDisabled;
+void noInterrupts();
+void interrupts();
+
+void pinMode(uint8_t aPin, uint8_t aMode);
+void digitalWrite(uint8_t aPin, uint8_t aValue);
+int digitalRead(uint8_t aPin);
+int analogRead(uint8_t aPin);
+long map(long aValue, long aFromLow, long aFromHigh, long aToLow, long aToHigh);
+
+class Print {
+public:
+    virtual ~Print() {
+    }
+    virtual size_t write(uint8_t aByte) = 0;
+    size_t print(const __FlashStringHelper *aString);
+    size_t print(const char *aString);
+    size_t print(char aChar);
+    size_t print(unsigned char aValue, int aBase = DEC);
+    size_t print(int aValue, int aBase = DEC);
+    size_t print(unsigned int aValue, int aBase = DEC);
+    size_t print(long aValue, int aBase = DEC);
+    size_t print(unsigned long aValue, int aBase = DEC);
+    size_t print(double aValue, int aDigits = 2);
+    size_t println(const __FlashStringHelper *aString);
+    size_t println(const char *aString);
+    size_t println(char aChar);
+    size_t println(unsigned char aValue, int aBase = DEC);
+    size_t println(int aValue, int aBase = DEC);
+    size_t println(unsigned int aValue, int aBase = DEC);
+    size_t println(long aValue, int aBase = DEC);
+    size_t println(unsigned long aValue, int aBase = DEC);
+    size_t println(double aValue, int aDigits = 2);
+    size_t println();
+};
+
+class Stream: public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    size_t readBytes(char *aBuffer, size_t aLength);
+};
+
+/*
+ * Writes to stdout
+ */
+class HardwareSerial: public Stream {
+public:
+    void begin(unsigned long aBaudrate);
+    size_t write(uint8_t aByte);
+    int available();
+    int read();
+    operator bool() {
+        return true;
+    }
+};
+extern HardwareSerial Serial;
+
+#endif // ARDUINO_HOST_STUB_H
@@ -0,0 +1,46 @@
+/*
+ * EEPROM.h
+ *
+ *  EEPROM stub for the host tests. Counts the bytes written, since each write costs 3.3 ms on AVR.
+ *
+ *  Copyright (C) 2020  Armin Joachimsmeyer
+ *  armin.joachimsmeyer@gmail.com
+ *
+ *  This file is part of ServoEasing https://github.com/ArminJo/ServoEasing.
+ *
+ *  ServoEasing is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/gpl.html>.
+ */
+
+#ifndef EEPROM_HOST_STUB_H
+#define EEPROM_HOST_STUB_H
+
+#include <Arduino.h>
+
+#define E2END   0xFFF // 4 kByte like ATmega2560
+
+class EEPROMClass {
+public:
+    EEPROMClass();
+    uint8_t read(int aAddress);
+    void write(int aAddress, uint8_t aValue);
+    void update(int aAddress, uint8_t aValue);
+    void begin(size_t aSize);
+    bool commit();
+
+    uint8_t mData[E2END + 1];
+    uint32_t mNumberOfWrittenBytes;
+};
+extern EEPROMClass EEPROM;
+
+#endif // EEPROM_HOST_STUB_H
@@ -0,0 +1,357 @@
+/*
+ * HostStubs.cpp
+ *
+ *  Implementation of the Arduino, Servo, Wire and EEPROM stubs for the host tests.
+ *
+ *  Copyright (C) 2020  Armin Joachimsmeyer
+ *  armin.joachimsmeyer@gmail.com
+ *
+ *  This file is part of ServoEasing https://github.com/ArminJo/ServoEasing.
+ *
+ *  ServoEasing is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/gpl.html>.
+ */
+
+#include <stdio.h>
+#include <Arduino.h>
+#include <Servo.h>
+#include <Wire.h>
+#include <EEPROM.h>
+
+/*
+ * Arduino core
+ */
+uint32_t sHostMillis = 0;
+bool sHostInterruptsAreDisabled = false;
+HardwareSerial Serial;
+
+void setHostMillis(uint32_t aMillis) {
+    sHostMillis = aMillis;
+}
+unsigned long millis() {
+    return sHostMillis;
+}
+unsigned long micros() {
+    return sHostMillis * 1000UL;
+}
+void delay(unsigned long aMillis) {
+    sHostMillis += aMillis;
+}
+void delayMicroseconds(unsigned int aMicroseconds __attribute__((unused))) {
+}
+void noInterrupts() {
+    sHostInterruptsAreDisabled = true;
+}
+void interrupts() {
+    sHostInterruptsAreDisabled = false;
+}
+void pinMode(uint8_t aPin __attribute__((unused)), uint8_t aMode __attribute__((unused))) {
+}
+void digitalWrite(uint8_t aPin __attribute__((unused)), uint8_t aValue __attribute__((unused))) {
+}
+int digitalRead(uint8_t aPin __attribute__((unused))) {
+    return LOW;
+}
+int analogRead(uint8_t aPin __attribute__((unused))) {
+    return 512;
+}
+long map(long aValue, long aFromLow, long aFromHigh, long aToLow, long aToHigh) {
+    return (aValue - aFromLow) * (aToHigh - aToLow) / (aFromHigh - aFromLow) + aToLow;
+}
+
+/*
+ * Print and Serial
+ */
+static size_t printNumber(Print *aPrint, unsigned long aValue, int aBase, bool aIsNegative) {
+    char tBuffer[40];
+    char *tPointer = &tBuffer[sizeof(tBuffer) - 1];
+    *tPointer = '\0';
+    do {
+        uint_fast8_t tDigit = aValue % aBase;
+        *--tPointer = tDigit < 10 ? '0' + tDigit : 'A' + tDigit - 10;
+        aValue /= aBase;
+    } while (aValue != 0);
+    if (aIsNegative) {
+        *--tPointer = '-';
+    }
+    return aPrint->print(tPointer);
+}
+size_t Print::print(const __FlashStringHelper *aString) {
+    return print(reinterpret_cast<const char *>(aString));
+}
+size_t Print::print(const char *aString) {
+    size_t tLength = 0;
+    while (*aString != '\0') {
+        tLength += write(*aString++);
+    }
+    return tLength;
+}
+size_t Print::print(char aChar) {
+    return write(aChar);
+}
+size_t Print::print(unsigned char aValue, int aBase) {
+    return printNumber(this, aValue, aBase, false);
+}
+size_t Print::print(int aValue, int aBase) {
+    return print((long) aValue, aBase);
+}
+size_t Print::print(unsigned int aValue, int aBase) {
+    return printNumber(this, aValue, aBase, false);
+}
+size_t Print::print(long aValue, int aBase) {
+    if (aValue < 0 && aBase == DEC) {
+        return printNumber(this, -aValue, aBase, true);
+    }
+    return printNumber(this, aValue, aBase, false);
+}
+size_t Print::print(unsigned long aValue, int aBase) {
+    return printNumber(this, aValue, aBase, false);
+}
+size_t Print::print(double aValue, int aDigits) {
+    char tBuffer[40];
+    snprintf(tBuffer, sizeof(tBuffer), "%.*f", aDigits, aValue);
+    return print(tBuffer);
+}
+size_t Print::println(const __FlashStringHelper *aString) {
+    return print(aString) + println();
+}
+size_t Print::println(const char *aString) {
+    return print(aString) + println();
+}
+size_t Print::println(char aChar) {
+    return print(aChar) + println();
+}
+size_t Print::println(unsigned char aValue, int aBase) {
+    return print(aValue, aBase) + println();
+}
+size_t Print::println(int aValue, int aBase) {
+    return print(aValue, aBase) + println();
+}
+size_t Print::println(unsigned int aValue, int aBase) {
+    return print(aValue, aBase) + println();
+}
+size_t Print::println(long aValue, int aBase) {
+    return print(aValue, aBase) + println();
+}
+size_t Print::println(unsigned long aValue, int aBase) {
+    return print(aValue, aBase) + println();
+}
+size_t Print::println(double aValue, int aDigits) {
+    return print(aValue, aDigits) + println();
+}
+size_t Print::println() {
+    return write('\n');
+}
+size_t Stream::readBytes(char *aBuffer, size_t aLength) {
+    size_t tCount = 0;
+    while (tCount < aLength && available() > 0) {
+        *aBuffer++ = read();
+        tCount++;
+    }
+    return tCount;
+}
+void HardwareSerial::begin(unsigned long aBaudrate __attribute__((unused))) {
+}
+size_t HardwareSerial::write(uint8_t aByte) {
+    putchar(aByte);
+    return 1;
+}
+int HardwareSerial::available() {
+    return 0;
+}
+int HardwareSerial::read() {
+    return -1;
+}
+
+/*
+ * Servo
+ */
+int sHostServoMicroseconds[HOST_SERVO_MAX_PINS];
+uint32_t sHostServoNumberOfWrites = 0;
+
+Servo::Servo() {
+    mPin = -1;
+    mMin = MIN_PULSE_WIDTH;
+    mMax = MAX_PULSE_WIDTH;
+}
+uint8_t Servo::attach(int aPin) {
+    return attach(aPin, MIN_PULSE_WIDTH, MAX_PULSE_WIDTH);
+}
+uint8_t Servo::attach(int aPin, int aMin, int aMax) {
+    if (aPin < 0 || aPin >= HOST_SERVO_MAX_PINS) {
+        return INVALID_SERVO;
+    }
+    mPin = aPin;
+    mMin = aMin;
+    mMax = aMax;
+    return aPin;
+}
+void Servo::detach() {
+    if (mPin >= 0) {
+        sHostServoMicroseconds[mPin] = 0;
+    }
+    mPin = -1;
+}
+void Servo::write(int aValue) {
+    if (aValue < MIN_PULSE_WIDTH) {
+        aValue = map(constrain(aValue, 0, 180), 0, 180, mMin, mMax);
+    }
+    writeMicroseconds(aValue);
+}
+void Servo::writeMicroseconds(int aMicroseconds) {
+    if (mPin >= 0) {
+        // The Servo library clamps to the values given at attach()
+        sHostServoMicroseconds[mPin] = constrain(aMicroseconds, mMin, mMax);
+        sHostServoNumberOfWrites++;
+    }
+}
+int Servo::read() {
+    return map(readMicroseconds(), mMin, mMax, 0, 180);
+}
+int Servo::readMicroseconds() {
+    if (mPin < 0) {
+        return 0;
+    }
+    return sHostServoMicroseconds[mPin];
+}
+bool Servo::attached() {
+    return mPin >= 0;
+}
+
+/*
+ * Wire with PCA9685 emulation
+ */
+#define PCA9685_LED0_REGISTER       0x06
+#define PCA9685_ALL_LED_REGISTER    0xFA
+TwoWire Wire;
+
+TwoWire::TwoWire() {
+    memset(mPCA9685Registers, 0, sizeof(mPCA9685Registers));
+    mClockFrequency = 100000;
+    mAddress = 0;
+    mBufferLength = 0;
+    mIsInTransmission = false;
+    mNumberOfNestedTransmissions = 0;
+    resetStatistics();
+}
+void TwoWire::begin() {
+}
+void TwoWire::setClock(uint32_t aClockFrequency) {
+    mClockFrequency = aClockFrequency;
+}
+void TwoWire::resetStatistics() {
+    mNumberOfTransactions = 0;
+    mNumberOfBytes = 0;
+    mBusMicros = 0;
+    mOrderHash = 0;
+    mNumberOfOverflows = 0;
+}
+void TwoWire::beginTransmission(uint8_t aAddress) {
+    if (mIsInTransmission) {
+        mNumberOfNestedTransmissions++;
+    }
+    mIsInTransmission = true;
+    mAddress = aAddress;
+    mBufferLength = 0;
+}
+size_t TwoWire::write(uint8_t aData) {
+    if (mBufferLength >= sizeof(mBuffer)) {
+        return 0;
+    }
+    mBuffer[mBufferLength++] = aData;
+    return 1;
+}
+size_t TwoWire::write(const uint8_t *aData, size_t aLength) {
+    for (size_t i = 0; i < aLength; ++i) {
+        write(aData[i]);
+    }
+    return aLength;
+}
+
+/*
+ * Statistics are computed and the registers of the PCA9685 are written here
+ */
+uint8_t TwoWire::endTransmission(bool aSendStop __attribute__((unused))) {
+    mIsInTransmission = false;
+    mNumberOfTransactions++;
+    mNumberOfBytes += mBufferLength + 1;
+    // 9 clocks per byte plus start and stop condition
+    mBusMicros += ((((mBufferLength + 1) * 9) + 2) * 1000000UL) / mClockFrequency;
+    if (mBufferLength > HOST_WIRE_BUFFER_SIZE) {
+        mNumberOfOverflows++;
+    }
+    mOrderHash = (mOrderHash * 31) + mAddress;
+    for (uint_fast16_t i = 0; i < mBufferLength; ++i) {
+        mOrderHash = (mOrderHash * 31) + mBuffer[i];
+    }
+
+    uint_fast8_t tExpanderIndex = mAddress - HOST_WIRE_FIRST_PCA9685_ADDRESS;
+    if (tExpanderIndex < HOST_WIRE_NUMBER_OF_PCA9685 && mBufferLength > 0) {
+        uint8_t *tRegisters = mPCA9685Registers[tExpanderIndex];
+        uint8_t tRegister = mBuffer[0];
+        for (uint_fast16_t i = 1; i < mBufferLength; ++i) {
+            tRegisters[tRegister] = mBuffer[i];
+            if (tRegister >= PCA9685_ALL_LED_REGISTER && tRegister < PCA9685_ALL_LED_REGISTER + 4) {
+                for (uint_fast8_t tChannel = 0; tChannel < 16; ++tChannel) {
+                    tRegisters[PCA9685_LED0_REGISTER + (4 * tChannel) + (tRegister - PCA9685_ALL_LED_REGISTER)] = mBuffer[i];
+                }
+            }
+            tRegister++; // auto increment
+        }
+    }
+    return 0;
+}
+uint8_t TwoWire::requestFrom(uint8_t aAddress __attribute__((unused)), uint8_t aQuantity __attribute__((unused))) {
+    return 0;
+}
+int TwoWire::available() {
+    return 0;
+}
+int TwoWire::read() {
+    return -1;
+}
+uint16_t TwoWire::getPCA9685OnValue(uint8_t aAddress, uint8_t aChannel) {
+    uint8_t *tRegisters = &mPCA9685Registers[aAddress - HOST_WIRE_FIRST_PCA9685_ADDRESS][PCA9685_LED0_REGISTER + (4 * aChannel)];
+    return tRegisters[0] | (tRegisters[1] << 8);
+}
+uint16_t TwoWire::getPCA9685OffValue(uint8_t aAddress, uint8_t aChannel) {
+    uint8_t *tRegisters = &mPCA9685Registers[aAddress - HOST_WIRE_FIRST_PCA9685_ADDRESS][PCA9685_LED0_REGISTER + (4 * aChannel)];
+    return tRegisters[2] | (tRegisters[3] << 8);
+}
+
+/*
+ * EEPROM
+ */
+EEPROMClass EEPROM;
+
+EEPROMClass::EEPROMClass() {
+    memset(mData, 0xFF, sizeof(mData)); // erased EEPROM
+    mNumberOfWrittenBytes = 0;
+}
+uint8_t EEPROMClass::read(int aAddress) {
+    return mData[aAddress];
+}
+void EEPROMClass::write(int aAddress, uint8_t aValue) {
+    mData[aAddress] = aValue;
+    mNumberOfWrittenBytes++;
+}
+void EEPROMClass::update(int aAddress, uint8_t aValue) {
+    if (mData[aAddress] != aValue) {
+        write(aAddress, aValue);
+    }
+}
+void EEPROMClass::begin(size_t aSize __attribute__((unused))) {
+}
+bool EEPROMClass::commit() {
+    return true;
+}
@@ -0,0 +1,57 @@
+/*
+ * Servo.h
+ *
+ *  Servo library stub for the host tests. Records the last pulse of each pin and counts the writes.
+ *
+ *  Copyright (C) 2020  Armin Joachimsmeyer
+ *  armin.joachimsmeyer@gmail.com
+ *
+ *  This file is part of ServoEasing https://github.com/ArminJo/ServoEasing.
+ *
+ *  ServoEasing is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/gpl.html>.
+ */
+
+#ifndef SERVO_HOST_STUB_H
+#define SERVO_HOST_STUB_H
+
+#include <Arduino.h>
+
+#define MAX_SERVOS              12
+#define MIN_PULSE_WIDTH         544
+#define MAX_PULSE_WIDTH         2400
+#define REFRESH_INTERVAL        20000
+#define INVALID_SERVO           255
+#define HOST_SERVO_MAX_PINS     256
+
+extern int sHostServoMicroseconds[HOST_SERVO_MAX_PINS]; // last pulse written to pin, 0 -> detached
+extern uint32_t sHostServoNumberOfWrites;
+
+class Servo {
+public:
+    Servo();
+    uint8_t attach(int aPin);
+    uint8_t attach(int aPin, int aMin, int aMax);
+    void detach();
+    void write(int aValue);
+    void writeMicroseconds(int aMicroseconds);
+    int read();
+    int readMicroseconds();
+    bool attached();
+private:
+    int mPin; // -1 -> not attached
+    int mMin;
+    int mMax;
+};
+
+#endif // SERVO_HOST_STUB_H
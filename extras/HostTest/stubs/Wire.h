@@ -0,0 +1,72 @@
+/*
+ * Wire.h
+ *
+ *  Wire library mock for the host tests. It emulates the LED registers of PCA9685 expanders
+ *  including auto increment and the ALL_LED registers, and counts transactions, bytes and bus time.
+ *
+ *  Copyright (C) 2020  Armin Joachimsmeyer
+ *  armin.joachimsmeyer@gmail.com
+ *
+ *  This file is part of ServoEasing https://github.com/ArminJo/ServoEasing.
+ *
+ *  ServoEasing is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/gpl.html>.
+ */
+
+#ifndef WIRE_HOST_STUB_H
+#define WIRE_HOST_STUB_H
+
+#include <Arduino.h>
+
+#define HOST_WIRE_FIRST_PCA9685_ADDRESS     0x40
+#define HOST_WIRE_NUMBER_OF_PCA9685         4
+#define HOST_WIRE_BUFFER_SIZE               32 // like the AVR Wire library
+
+class TwoWire: public Stream {
+public:
+    TwoWire();
+    void begin();
+    void setClock(uint32_t aClockFrequency);
+    void beginTransmission(uint8_t aAddress);
+    uint8_t endTransmission(bool aSendStop = true);
+    size_t write(uint8_t aData);
+    size_t write(const uint8_t *aData, size_t aLength);
+    uint8_t requestFrom(uint8_t aAddress, uint8_t aQuantity);
+    int available();
+    int read();
+
+    /*
+     * Mock functions
+     */
+    void resetStatistics();
+    uint16_t getPCA9685OnValue(uint8_t aAddress, uint8_t aChannel);
+    uint16_t getPCA9685OffValue(uint8_t aAddress, uint8_t aChannel);
+
+    uint32_t mNumberOfTransactions;
+    uint32_t mNumberOfBytes;        // including address byte
+    uint32_t mBusMicros;            // time the bus was busy at mClockFrequency
+    uint32_t mOrderHash;            // hash of all transmitted bytes in order of transmission
+    uint32_t mNumberOfOverflows;    // transactions longer than HOST_WIRE_BUFFER_SIZE
+    bool mIsInTransmission;         // to detect nested transmissions e.g. of ISR and main loop
+    uint32_t mNumberOfNestedTransmissions;
+
+private:
+    uint32_t mClockFrequency;
+    uint8_t mAddress;
+    uint8_t mBuffer[256];
+    uint_fast16_t mBufferLength;
+    uint8_t mPCA9685Registers[HOST_WIRE_NUMBER_OF_PCA9685][256];
+};
+extern TwoWire Wire;
+
+#endif // WIRE_HOST_STUB_H
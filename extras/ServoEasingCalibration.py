@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+"""
+ServoEasingCalibration.py
+
+Converts the calibration store dump of the ServoEasing library into a readable table and back,
+and sends a table to the Arduino.
+The dump is printed by printCalibrationStoreDump(). Its first line is "CAL:" followed by version and number of servos,
+then there is one line for each servo with servo index, the 17 bytes of the entry and the CRC of the line.
+"send" writes the dump line by line and waits for the "OK" of readCalibrationStoreDump() after each line,
+since the Arduino cannot receive while it writes an entry to the EEPROM.
+
+ usage: ServoEasingCalibration.py decode <dump file or ->               prints one line per servo
+        ServoEasingCalibration.py encode <table file or ->              prints the dump
+        ServoEasingCalibration.py send <serial port> <table file or ->  sends the dump to the Arduino, requires pyserial
+
+ Copyright (C) 2024  Armin Joachimsmeyer
+ armin.joachimsmeyer@gmail.com
+
+ This file is part of ServoEasing https://github.com/ArminJo/ServoEasing.
+
+ ServoEasing is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+"""
+
+import struct
+import sys
+
+CALIBRATION_STORE_VERSION = 2
+# 0 and 180 degree, trim, min, max, speed, slew rate velocity and acceleration, flags. Must match CALIBRATION_ENTRY_SIZE in ServoEasing.h.
+ENTRY_FORMAT = "<hhhhhHHHB"
+ENTRY_FIELDS = ("0deg", "180deg", "trim", "min", "max", "speed", "slewVelocity", "slewAcceleration", "flags")
+FLAG_REVERSE = 0x01
+FLAG_PCA9685_UNITS = 0x02  # values are PCA9685 units and not microseconds
+FLAG_NO_SERVO = 0x80
+BAUDRATE = 115200
+
+
+def crc16_ccitt(aData):
+    tCRC = 0xFFFF
+    for tByte in aData:
+        tCRC ^= tByte << 8
+        for _ in range(8):
+            if tCRC & 0x8000:
+                tCRC = ((tCRC << 1) ^ 0x1021) & 0xFFFF
+            else:
+                tCRC = (tCRC << 1) & 0xFFFF
+    return tCRC
+
+
+def decode(aText):
+    tLines = [tLine.strip() for tLine in aText.splitlines() if tLine.strip()]
+    if not tLines or not tLines[0].startswith("CAL:"):
+        sys.exit("Dump must start with CAL:")
+    tVersion, tNumberOfServos = bytes.fromhex(tLines[0][4:])
+    if tVersion != CALIBRATION_STORE_VERSION:
+        sys.exit("Version %d is not supported" % tVersion)
+    if len(tLines) < 1 + tNumberOfServos:
+        sys.exit("Dump too short for %d servos" % tNumberOfServos)
+    tTable = ["# index " + " ".join(ENTRY_FIELDS[:-1]) + " reverse pca9685Units"]
+    for tIndex in range(tNumberOfServos):
+        tLine = bytes.fromhex(tLines[1 + tIndex])
+        if tLine[0] != tIndex or struct.unpack_from("<H", tLine, len(tLine) - 2)[0] != crc16_ccitt(tLine[:-2]):
+            sys.exit("CRC error in line of servo %d" % tIndex)
+        tValues = struct.unpack_from(ENTRY_FORMAT, tLine, 1)
+        tFlags = tValues[-1]
+        if tFlags & FLAG_NO_SERVO:
+            tTable.append("%d unused" % tIndex)
+        else:
+            tTable.append("%d " % tIndex + " ".join(str(v) for v in tValues[:-1])
+                          + " %d %d" % (tFlags & FLAG_REVERSE, 1 if tFlags & FLAG_PCA9685_UNITS else 0))
+    return "\n".join(tTable)
+
+
+def encode(aText):
+    tEntries = []
+    for tLine in aText.splitlines():
+        tLine = tLine.split("#")[0].split()
+        if not tLine:
+            continue
+        if tLine[1] == "unused":
+            tEntries.append(struct.pack(ENTRY_FORMAT, 0, 0, 0, 0, 0, 0, 0, 0, FLAG_NO_SERVO))
+        else:
+            tValues = [int(v) for v in tLine[1:]]
+            tFlags = (FLAG_REVERSE if tValues[8] else 0) | (FLAG_PCA9685_UNITS if tValues[9] else 0)
+            tEntries.append(struct.pack(ENTRY_FORMAT, *(tValues[:8] + [tFlags])))
+    tDump = ["CAL:" + bytes([CALIBRATION_STORE_VERSION, len(tEntries)]).hex().upper()]
+    for tIndex, tEntry in enumerate(tEntries):
+        tLine = bytes([tIndex]) + tEntry
+        tDump.append((tLine + struct.pack("<H", crc16_ccitt(tLine))).hex().upper())
+    return "\n".join(tDump)
+
+
+def send(aPortName, aText):
+    import serial  # pyserial
+
+    with serial.Serial(aPortName, BAUDRATE, timeout=2) as tSerial:
+        for tLine in encode(aText).splitlines():
+            tSerial.write((tLine + "\n").encode())
+            while True:
+                tAnswer = tSerial.readline().decode(errors="replace").strip()
+                if tAnswer == "OK":
+                    break
+                if tAnswer == "ERROR" or tAnswer == "":
+                    sys.exit("Arduino did not accept line " + tLine)
+    return "Calibration of %d servos sent" % (len(encode(aText).splitlines()) - 1)
+
+
+if __name__ == "__main__":
+    if len(sys.argv) == 4 and sys.argv[1] == "send":
+        print(send(sys.argv[2], sys.stdin.read() if sys.argv[3] == "-" else open(sys.argv[3]).read()))
+        sys.exit(0)
+    if len(sys.argv) != 3 or sys.argv[1] not in ("decode", "encode"):
+        sys.exit(__doc__)
+    tInput = sys.stdin.read() if sys.argv[2] == "-" else open(sys.argv[2]).read()
+    print(decode(tInput) if sys.argv[1] == "decode" else encode(tInput))
@@ -32,6 +32,10 @@
 
 #include "ServoEasing.h"
 
+#if defined(ENABLE_POSITION_SNAPSHOT) || defined(ENABLE_CALIBRATION_STORE)
+#include <EEPROM.h>
+#endif
+
 #if defined(ESP8266) || defined(ESP32)
 #include "Ticker.h" // for ServoEasingInterrupt functions
 Ticker Timer20ms;
@@ -89,31 +93,106 @@ IntervalTimer Timer20ms;
 #define DEBUG
 #endif
 
+/*
+ * Disable interrupts and restore the previous interrupt state afterwards, so it can be used in the ISR too.
+ * A plain interrupts() at the end would enable nested interrupts, if called from the ISR.
+ */
+#if defined(__AVR__)
+#define SERVO_EASING_DISABLE_INTERRUPTS()   uint8_t tSREG = SREG; cli()
+#define SERVO_EASING_RESTORE_INTERRUPTS()   SREG = tSREG
+#elif defined(__arm__) // All Cortex M cores
+#define SERVO_EASING_DISABLE_INTERRUPTS()   uint32_t tPRIMASK; __asm__ volatile ("mrs %0, primask\n cpsid i" : "=r" (tPRIMASK) :: "memory")
+#define SERVO_EASING_RESTORE_INTERRUPTS()   __asm__ volatile ("msr primask, %0" :: "r" (tPRIMASK) : "memory")
+#elif defined(ESP8266)
+#define SERVO_EASING_DISABLE_INTERRUPTS()   uint32_t tSavedPS = xt_rsil(15)
+#define SERVO_EASING_RESTORE_INTERRUPTS()   xt_wsr_ps(tSavedPS)
+#elif defined(ESP32)
+// The critical section of the ESP32 saves the interrupt state and locks the other core
+portMUX_TYPE sServoEasingMux = portMUX_INITIALIZER_UNLOCKED;
+#define SERVO_EASING_DISABLE_INTERRUPTS()   portENTER_CRITICAL_SAFE(&sServoEasingMux)
+#define SERVO_EASING_RESTORE_INTERRUPTS()   portEXIT_CRITICAL_SAFE(&sServoEasingMux)
+#else
+// Interrupt state can not be saved, so do not call it from ISR
+#define SERVO_EASING_DISABLE_INTERRUPTS()   noInterrupts()
+#define SERVO_EASING_RESTORE_INTERRUPTS()   interrupts()
+#endif
+
 volatile bool sInterruptsAreActive = false; // true if interrupts are still active, i.e. at least one Servo is moving with interrupts.
 
 /*
- * list to hold all ServoEasing Objects in order to move them together
+ * Engine to hold all ServoEasing Objects in order to move them together. Used by all servos if ENABLE_SERVO_EASING_ENGINES is not defined.
  * Cannot use "static servo_t servos[MAX_SERVOS];" from Servo library since it is static :-(
  */
-uint_fast8_t sServoArrayMaxIndex = 0; // maximum index of an attached servo in sServoArray[]
-ServoEasing * sServoArray[MAX_EASING_SERVOS];
-// used to move all servos
-int sServoNextPositionArray[MAX_EASING_SERVOS];
+ServoEasingEngine sServoEasingDefaultEngine;
+uint_fast8_t & sServoArrayMaxIndex = sServoEasingDefaultEngine.mServoArrayMaxIndex;
+ServoEasing * (&sServoArray)[MAX_EASING_SERVOS] = sServoEasingDefaultEngine.mServoArray;
+int (&sServoNextPositionArray)[MAX_EASING_SERVOS] = sServoEasingDefaultEngine.mServoNextPositionArray;
 
 #if defined(USE_PCA9685_SERVO_EXPANDER)
 #  if ! defined _BV
 #  define _BV(bit) (1 << (bit))
 #  endif
 // Constructor with I2C address required
-ServoEasing::ServoEasing(uint8_t aPCA9685I2CAddress, TwoWire *aI2CClass) { // @suppress("Class members should be properly initialized")
+ServoEasing::ServoEasing(uint8_t aPCA9685I2CAddress, TwoWire *aI2CClass,
+        MaxEasingServosMustBeEqualForAllFiles<MAX_EASING_SERVOS> * aMaxEasingServosCheck __attribute__((unused))) { // @suppress("Class members should be properly initialized")
     mPCA9685I2CAddress = aPCA9685I2CAddress;
     mI2CClass = aI2CClass;
 
     // On an ESP8266 it was NOT initialized to 0 :-(.
     mTrimMicrosecondsOrUnits = 0;
     mSpeed = START_EASE_TO_SPEED;
+#if defined(ENABLE_SERVO_EASING_ENGINES)
+    mEngine = &sServoEasingDefaultEngine;
+#endif
+#if defined(ENABLE_SERVO_DRIVER_INTERFACE)
+    mDriver = NULL;
+#endif
+#if defined(ENABLE_SERVO_EASING_ENGINES) || defined(ENABLE_SERVO_DRIVER_INTERFACE)
+    mServoIndex = INVALID_SERVO; // not yet attached, required for setEngine() and setDriver()
+#endif
     mServoMoves = false;
     mOperateServoReverse = false;
+    mServo0DegreeMicrosecondsOrUnits = 0;
+    mServo180DegreeMicrosecondsOrUnits = 180;
+    computeConversionFactorsAndOffsets();
+#if defined(ENABLE_WRITE_TARGET_TRACKING)
+    mIsTrackingTarget = false;
+#endif
+#if defined(ENABLE_SLEW_RATE_LIMITED_WRITE)
+    mSlewRateMaxVelocity = 0;
+    mSlewRateMaxAcceleration = 0;
+#endif
+#if defined(ENABLE_CALIBRATION_TABLE)
+    mCalibrationTable = NULL;
+#endif
+#if defined(ENABLE_VELOCITY_MODE)
+    mIsVelocityMove = false;
+    mVelocityShift8 = 0;
+#endif
+#if defined(ENABLE_DEAD_RECKONING)
+    mVelocityCalibrationPositive = NULL;
+    mVelocityCalibrationNegative = NULL;
+    mEstimatedAngleMillidegree = 0;
+    mEstimatedTurns = 0;
+    mMillisAtLastIntegration = 0;
+    mRotateByDirection = 0;
+#endif
+#if defined(ENABLE_MIN_AND_MAX_CONSTRAINTS)
+    mMinMicrosecondsOrUnits = 0;
+    mMaxMicrosecondsOrUnits = 0;
+    mNumberOfClampedWrites = 0;
+    computeMinMaxConstraintWithTrimAndReverse();
+#endif
+#if defined(ENABLE_IDLE_POWER_OFF)
+    mIsPoweredOff = false;
+    mIdlePowerOffMillis = 0;
+    mNumberOfPowerOffs = 0;
+    mPowerOffMillis = 0;
+#endif
+#if defined(ENABLE_INPUT_FILTER)
+    mInputFilterType = INPUT_FILTER_NONE;
+    mNumberOfSuppressedWrites = 0;
+#endif
 
 #if defined(USE_SERVO_LIB)
     mServoIsConnectedToExpander = true;
@@ -121,6 +200,9 @@ ServoEasing::ServoEasing(uint8_t aPCA9685I2CAddress, TwoWire *aI2CClass) { // @s
 #ifndef PROVIDE_ONLY_LINEAR_MOVEMENT
     mEasingType = EASE_LINEAR;
     mUserEaseInFunction = NULL;
+    mUserEaseInFunctionWithUserData = NULL;
+    mUserEaseInFunctionFixedPoint = NULL;
+    mUserDataPointer = NULL;
 #endif
 
 #if defined(MEASURE_SERVO_EASING_INTERRUPT_TIMING)
@@ -128,19 +210,55 @@ ServoEasing::ServoEasing(uint8_t aPCA9685I2CAddress, TwoWire *aI2CClass) { // @s
 #endif
 }
 
-void ServoEasing::I2CInit() {
+static void I2CInit(TwoWire * aI2CClass) {
 // Initialize I2C
-    mI2CClass->begin();
-    mI2CClass->setClock(I2C_CLOCK_FREQUENCY); // 1000000 does not work for me, maybe because of parasitic breadboard capacities
+    aI2CClass->begin();
+    aI2CClass->setClock(I2C_CLOCK_FREQUENCY); // 1000000 does not work for me, maybe because of parasitic breadboard capacities
+}
+
+static void PCA9685Reset(TwoWire * aI2CClass) {
+#if defined(ENABLE_PCA9685_SHADOW_REGISTERS)
+    clearBufferedPCA9685PWM(aI2CClass, PCA9685_GENERAL_CALL_ADDRESS, PCA9685_ALL_CHANNELS); // registers of all expanders are reset
+#endif
+    // Send software reset to expander(s)
+    aI2CClass->beginTransmission(PCA9685_GENERAL_CALL_ADDRESS);
+    aI2CClass->write(PCA9685_SOFTWARE_RESET);
+    aI2CClass->endTransmission();
+}
+
+TwoWire * sInitializedPCA9685I2CClasses[PCA9685_MAX_I2C_BUSES]; // NULL -> entry is unused
+
+/*
+ * Initializes I2C and software resets all PCA9685 expanders at the first call for this bus.
+ * The general call reset resets every expander of the bus, so it is never sent again,
+ * since then expanders of this bus may already be in use, even by another engine or by packed servos.
+ * @return true if the bus was initialized and reset by this call
+ */
+bool initializePCA9685Bus(TwoWire * aI2CClass) {
+    for (uint_fast8_t i = 0; i < PCA9685_MAX_I2C_BUSES; ++i) {
+        if (sInitializedPCA9685I2CClasses[i] == aI2CClass) {
+            return false;
+        }
+        if (sInitializedPCA9685I2CClasses[i] == NULL) {
+            sInitializedPCA9685I2CClasses[i] = aI2CClass;
+            I2CInit(aI2CClass);
+            PCA9685Reset(aI2CClass);
+            return true;
+        }
+    }
+    // More buses than PCA9685_MAX_I2C_BUSES. We cannot remember this bus, so initialize it each time, but never reset it.
+    I2CInit(aI2CClass);
+    return false;
+}
+
+void ServoEasing::I2CInit() {
+    ::I2CInit(mI2CClass);
 }
 /*
- * Initialize I2C and software reset all PCA9685 expanders
+ * Software reset all PCA9685 expanders of the bus
  */
 void ServoEasing::PCA9685Reset() {
-    // Send software reset to expander(s)
-    mI2CClass->beginTransmission(PCA9685_GENERAL_CALL_ADDRESS);
-    mI2CClass->write(PCA9685_SOFTWARE_RESET);
-    mI2CClass->endTransmission();
+    ::PCA9685Reset(mI2CClass);
 }
 
 /*
@@ -177,6 +295,9 @@ void ServoEasing::I2CWriteByte(uint8_t aAddress, uint8_t aData) {
  * 4096 means output is signal fully off
  */
 void ServoEasing::setPWM(uint16_t aPWMOffValueAsUnits) {
+#if defined(ENABLE_PCA9685_BURST_WRITE)
+    clearBufferedPCA9685PWM(mI2CClass, mPCA9685I2CAddress, mServoPin); // a buffered pulse must not overwrite this value at the next flush
+#endif
     mI2CClass->beginTransmission(mPCA9685I2CAddress);
     // +2 since we we do not set the begin value, it is fixed at 0
     mI2CClass->write((PCA9685_FIRST_PWM_REGISTER + 2) + 4 * mServoPin);
@@ -197,11 +318,14 @@ void ServoEasing::setPWM(uint16_t aPWMOffValueAsUnits) {
 
 /**
  * Here you can specify an on/start value for the pulse in order not to start all pulses at the same time.
- * Is used by writeMicrosecondsOrUnits() with onValue as mServoPin * 235
+ * Is used by writeMicrosecondsOrUnitsDirect() with onValue as mServoPin * 235
  * Requires 550 us to send data => 8.8 ms for 16 Servos, 17.6 ms for 32 servos. => more than 2 expander boards
  * cannot be connected to one I2C bus, if all servos must be able to move simultaneously.
  */
 void ServoEasing::setPWM(uint16_t aPWMOnStartValueAsUnits, uint16_t aPWMPulseDurationAsUnits) {
+#if defined(ENABLE_PCA9685_SHADOW_REGISTERS)
+    clearBufferedPCA9685PWM(mI2CClass, mPCA9685I2CAddress, mServoPin); // shadow of this channel is no longer valid
+#endif
     mI2CClass->beginTransmission(mPCA9685I2CAddress);
     mI2CClass->write((PCA9685_FIRST_PWM_REGISTER) + 4 * mServoPin);
     mI2CClass->write(aPWMOnStartValueAsUnits);
@@ -221,6 +345,22 @@ void ServoEasing::setPWM(uint16_t aPWMOnStartValueAsUnits, uint16_t aPWMPulseDur
 #endif
 }
 
+/*
+ * @return true if the signal of this servo is generated by a PCA9685 expander
+ */
+bool ServoEasing::isConnectedToPCA9685Expander() {
+#if defined(ENABLE_SERVO_DRIVER_INTERFACE)
+    if (mDriver != NULL) {
+        return false;
+    }
+#endif
+#if defined(USE_SERVO_LIB)
+    return mServoIsConnectedToExpander;
+#else
+    return true;
+#endif
+}
+
 int ServoEasing::MicrosecondsToPCA9685Units(int aMicroseconds) {
     /*
      * 4096 units per 20 milliseconds => aMicroseconds / 4.8828
@@ -228,10 +368,338 @@ int ServoEasing::MicrosecondsToPCA9685Units(int aMicroseconds) {
     return ((4096L * aMicroseconds) / REFRESH_INTERVAL_MICROS);
 }
 
+#if defined(ENABLE_PCA9685_BURST_WRITE)
+/*
+ * Burst write: the values of one update are collected for each expander and then sent with one transfer for each range
+ * of contiguous changed channels. One transfer saves the I2C address, the register address and the endTransmission() overhead
+ * for each additional channel. The on value of a channel is fixed as in ServoEasing::setPWM(), so only the pulse is buffered.
+ * With ENABLE_PCA9685_SHADOW_REGISTERS the last sent pulse of each channel is kept, and only the register bytes which differ are sent.
+ */
+PCA9685BurstBuffer sPCA9685BurstBufferArray[PCA9685_BURST_MAX_EXPANDERS];
+bool sPCA9685BurstIsActive;
+#if defined(ENABLE_PCA9685_SHADOW_REGISTERS)
+uint32_t sPCA9685NumberOfSavedBytes; // compared to sending all 4 registers of each changed channel
+
+uint32_t getPCA9685NumberOfSavedBytes() {
+    return sPCA9685NumberOfSavedBytes;
+}
+#endif
+#if defined(ENABLE_PCA9685_ALL_LED_WRITE)
+bool sPCA9685AllLEDWriteIsAllowed;
+#endif
+
+static PCA9685BurstBuffer * getPCA9685BurstBuffer(TwoWire * aI2CClass, uint8_t aPCA9685I2CAddress) {
+    for (uint_fast8_t i = 0; i < PCA9685_BURST_MAX_EXPANDERS; ++i) {
+        PCA9685BurstBuffer * tBuffer = &sPCA9685BurstBufferArray[i];
+        if (tBuffer->I2CClass == NULL) {
+            // first use of this expander
+            tBuffer->I2CClass = aI2CClass;
+            tBuffer->PCA9685I2CAddress = aPCA9685I2CAddress;
+            return tBuffer;
+        }
+        if (tBuffer->I2CClass == aI2CClass && tBuffer->PCA9685I2CAddress == aPCA9685I2CAddress) {
+            return tBuffer;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * @return false if burst is not active or no buffer is left for this expander. Then the value must be written at once.
+ */
+bool bufferPCA9685PWM(TwoWire * aI2CClass, uint8_t aPCA9685I2CAddress, uint8_t aChannel, uint16_t aPulseUnits) {
+    if (!sPCA9685BurstIsActive) {
+        return false;
+    }
+    PCA9685BurstBuffer * tBuffer = getPCA9685BurstBuffer(aI2CClass, aPCA9685I2CAddress);
+    if (tBuffer == NULL) {
+        return false;
+    }
+    tBuffer->PulseUnits[aChannel] = aPulseUnits;
+    tBuffer->ChannelChangedMask |= 1U << aChannel;
+    return true;
+}
+
+/*
+ * Must be called for each value written directly to the expander.
+ * @param aPCA9685I2CAddress - PCA9685_GENERAL_CALL_ADDRESS matches all expanders at aI2CClass
+ * @param aChannel - PCA9685_ALL_CHANNELS clears all channels of the expander
+ */
+void clearBufferedPCA9685PWM(TwoWire * aI2CClass, uint8_t aPCA9685I2CAddress, uint8_t aChannel) {
+    uint16_t tMask = (aChannel == PCA9685_ALL_CHANNELS) ? 0xFFFF : (1U << aChannel);
+    for (uint_fast8_t i = 0; i < PCA9685_BURST_MAX_EXPANDERS; ++i) {
+        PCA9685BurstBuffer * tBuffer = &sPCA9685BurstBufferArray[i];
+        if (tBuffer->I2CClass == aI2CClass
+                && (tBuffer->PCA9685I2CAddress == aPCA9685I2CAddress || aPCA9685I2CAddress == PCA9685_GENERAL_CALL_ADDRESS)) {
+            tBuffer->ChannelChangedMask &= ~tMask;
+#if defined(ENABLE_PCA9685_SHADOW_REGISTERS)
+            tBuffer->ShadowIsValidMask &= ~tMask; // the next write of this channel must send all 4 registers
+#endif
+        }
+    }
+}
+
+#if defined(ENABLE_PCA9685_ALL_LED_WRITE)
+/*
+ * Writes ON = 0 and OFF = aPulseUnits to all 16 channels of the expander with one transfer of 5 bytes
+ */
+static void writePCA9685AllLEDRegisters(TwoWire * aI2CClass, uint8_t aPCA9685I2CAddress, uint16_t aPulseUnits) {
+    clearBufferedPCA9685PWM(aI2CClass, aPCA9685I2CAddress, PCA9685_ALL_CHANNELS); // ON values are no longer distributed
+    aI2CClass->beginTransmission(aPCA9685I2CAddress);
+    aI2CClass->write(PCA9685_ALL_LED_ON_L_REGISTER); // auto increment is enabled by PCA9685Init()
+    aI2CClass->write(0);
+    aI2CClass->write(0);
+    aI2CClass->write(aPulseUnits);
+    aI2CClass->write(aPulseUnits >> 8);
+    aI2CClass->endTransmission();
+}
+
+/*
+ * @return true if all 16 channels got the same value, which was then sent with the ALL_LED registers
+ */
+static bool flushPCA9685AllLEDBurst(PCA9685BurstBuffer * aBuffer) {
+    if (aBuffer->ChannelChangedMask != 0xFFFF) {
+        return false;
+    }
+    uint16_t tPulseUnits = aBuffer->PulseUnits[0];
+    for (uint_fast8_t tChannel = 1; tChannel < PCA9685_MAX_CHANNELS; ++tChannel) {
+        if (aBuffer->PulseUnits[tChannel] != tPulseUnits) {
+            return false;
+        }
+    }
+    writePCA9685AllLEDRegisters(aBuffer->I2CClass, aBuffer->PCA9685I2CAddress, tPulseUnits);
+    return true;
+}
+
+/*
+ * Collects the values written until the next flushPCA9685Bursts(), which then uses the ALL_LED registers
+ * for expanders with identical values for all 16 channels.
+ * @return false if collecting is already active, i.e. if called by updateAllServos(). Otherwise flushPCA9685Bursts() must be called.
+ */
+bool startPCA9685AllLEDWrite() {
+    if (sPCA9685BurstIsActive) {
+        return false;
+    }
+    sPCA9685AllLEDWriteIsAllowed = true;
+    sPCA9685BurstIsActive = true;
+    return true;
+}
+
+/*
+ * Stops all servos of the default engine and switches all outputs of their expanders off with one transfer for each expander.
+ * Outputs of these expanders, which are not used by servos, are switched off too.
+ * The next write to a servo switches its output on again.
+ */
+void emergencyStopAllServos() {
+    disableServoEasingInterrupt();
+    for (uint_fast8_t tServoIndex = 0; tServoIndex <= sServoArrayMaxIndex; ++tServoIndex) {
+        ServoEasing * tServo = sServoArray[tServoIndex];
+        if (tServo == NULL || !tServo->isConnectedToPCA9685Expander()) {
+            continue;
+        }
+        // Switch each expander off only once
+        bool tExpanderIsSwitchedOff = false;
+        for (uint_fast8_t i = 0; i < tServoIndex; ++i) {
+            ServoEasing * tPreviousServo = sServoArray[i];
+            if (tPreviousServo != NULL && tPreviousServo->isConnectedToPCA9685Expander() && tPreviousServo->mI2CClass == tServo->mI2CClass
+                    && tPreviousServo->mPCA9685I2CAddress == tServo->mPCA9685I2CAddress) {
+                tExpanderIsSwitchedOff = true;
+                break;
+            }
+        }
+        if (!tExpanderIsSwitchedOff) {
+            writePCA9685AllLEDRegisters(tServo->mI2CClass, tServo->mPCA9685I2CAddress, PCA9685_FULL_OFF_VALUE);
+        }
+    }
+    stopAllServos();
+}
+#endif // defined(ENABLE_PCA9685_ALL_LED_WRITE)
+
+#if defined(ENABLE_PCA9685_SHADOW_REGISTERS)
+/*
+ * @param aRegisterIndex - 0 to 63 for ON_L, ON_H, OFF_L and OFF_H of channel 0 to 15
+ * @return the new value if the channel has changed, else the value of the shadow
+ */
+static uint8_t getPCA9685RegisterByte(PCA9685BurstBuffer * aBuffer, uint_fast8_t aRegisterIndex) {
+    uint_fast8_t tChannel = aRegisterIndex / 4;
+    uint16_t tValue = tChannel * ((4096 - (DEFAULT_PCA9685_UNITS_FOR_180_DEGREE + 100)) / 15); // on value tChannel * 233
+    if (aRegisterIndex & 0x02) {
+        // off value
+        tValue += ((aBuffer->ChannelChangedMask >> tChannel) & 1) ?
+                aBuffer->PulseUnits[tChannel] : aBuffer->ShadowPulseUnits[tChannel];
+    }
+    if (aRegisterIndex & 0x01) {
+        tValue >>= 8;
+    }
+    return tValue;
+}
+
+/*
+ * @return true if the register byte must be sent, because the channel changed and its shadow is invalid or differs
+ */
+static bool isPCA9685RegisterByteChanged(PCA9685BurstBuffer * aBuffer, uint_fast8_t aRegisterIndex) {
+    uint_fast8_t tChannel = aRegisterIndex / 4;
+    if (!((aBuffer->ChannelChangedMask >> tChannel) & 1)) {
+        return false;
+    }
+    if (!((aBuffer->ShadowIsValidMask >> tChannel) & 1)) {
+        return true;
+    }
+    if (!(aRegisterIndex & 0x02)) {
+        return false; // on value is fixed
+    }
+    uint16_t tOldOffValue = aBuffer->ShadowPulseUnits[tChannel];
+    uint16_t tNewOffValue = aBuffer->PulseUnits[tChannel];
+    // the on value is added to both, so compare the sums
+    uint16_t tOnValue = tChannel * ((4096 - (DEFAULT_PCA9685_UNITS_FOR_180_DEGREE + 100)) / 15);
+    tOldOffValue += tOnValue;
+    tNewOffValue += tOnValue;
+    if (aRegisterIndex & 0x01) {
+        return (tOldOffValue >> 8) != (tNewOffValue >> 8);
+    }
+    return (uint8_t) tOldOffValue != (uint8_t) tNewOffValue;
+}
+
+static void sendPCA9685RegisterBytes(PCA9685BurstBuffer * aBuffer, uint_fast8_t aFirstIndex, uint_fast8_t aLastIndex) {
+    TwoWire * tI2CClass = aBuffer->I2CClass;
+    tI2CClass->beginTransmission(aBuffer->PCA9685I2CAddress);
+    tI2CClass->write((PCA9685_FIRST_PWM_REGISTER) + aFirstIndex); // auto increment is enabled by PCA9685Init()
+    for (uint_fast8_t i = aFirstIndex; i <= aLastIndex; ++i) {
+        tI2CClass->write(getPCA9685RegisterByte(aBuffer, i));
+    }
+    tI2CClass->endTransmission();
+}
+
+/*
+ * Sends all changed register bytes and ends the collecting of values.
+ * Unchanged bytes between changed ones are sent too, if this is shorter than starting a new transfer
+ * with I2C address and register address, and if their content is known.
+ */
+void flushPCA9685Bursts() {
+    sPCA9685BurstIsActive = false;
+#  if defined(ENABLE_PCA9685_ALL_LED_WRITE)
+    bool tAllLEDWriteIsAllowed = sPCA9685AllLEDWriteIsAllowed;
+    sPCA9685AllLEDWriteIsAllowed = false;
+#  endif
+    for (uint_fast8_t i = 0; i < PCA9685_BURST_MAX_EXPANDERS; ++i) {
+        PCA9685BurstBuffer * tBuffer = &sPCA9685BurstBufferArray[i];
+        if (tBuffer->ChannelChangedMask == 0) {
+            continue;
+        }
+#  if defined(ENABLE_PCA9685_ALL_LED_WRITE)
+        if (tAllLEDWriteIsAllowed && flushPCA9685AllLEDBurst(tBuffer)) {
+            continue;
+        }
+#  endif
+        uint_fast16_t tNumberOfBytesToSend = 0;
+        uint_fast16_t tNumberOfBytesSent = 0;
+        bool tTransferIsOpen = false;
+        uint_fast8_t tFirstIndex = 0; // start of the current transfer
+        uint_fast8_t tLastIndex = 0; // last changed byte of the current transfer
+        for (uint_fast8_t tIndex = 0; tIndex < PCA9685_MAX_CHANNELS * 4; ++tIndex) {
+            uint_fast8_t tChannel = tIndex / 4;
+            uint16_t tChannelMask = 1U << tChannel;
+            if (!(tBuffer->ChannelChangedMask & tChannelMask)) {
+                continue;
+            }
+            if ((tIndex & 0x03) == 0) {
+                tNumberOfBytesToSend += 4;
+            }
+            if (!isPCA9685RegisterByteChanged(tBuffer, tIndex)) {
+                continue;
+            }
+            if (tTransferIsOpen) {
+                // Check if the gap bytes can be sent with the current transfer
+                bool tAppend = (tIndex - tLastIndex) <= (PCA9685_MAX_GAP_BYTES + 1) && (tIndex - tFirstIndex) < PCA9685_MAX_BYTES_PER_BURST;
+                for (uint_fast8_t j = tLastIndex + 1; tAppend && j < tIndex; ++j) {
+                    uint16_t tGapChannelMask = 1U << (j / 4);
+                    tAppend = (tBuffer->ChannelChangedMask & tGapChannelMask) || (tBuffer->ShadowIsValidMask & tGapChannelMask);
+                }
+                if (!tAppend) {
+                    sendPCA9685RegisterBytes(tBuffer, tFirstIndex, tLastIndex);
+                    tNumberOfBytesSent += (tLastIndex - tFirstIndex) + 1;
+                    tTransferIsOpen = false;
+                }
+            }
+            if (!tTransferIsOpen) {
+                tTransferIsOpen = true;
+                tFirstIndex = tIndex;
+            }
+            tLastIndex = tIndex;
+        }
+        if (tTransferIsOpen) {
+            sendPCA9685RegisterBytes(tBuffer, tFirstIndex, tLastIndex);
+            tNumberOfBytesSent += (tLastIndex - tFirstIndex) + 1;
+        }
+        if (tNumberOfBytesToSend > tNumberOfBytesSent) {
+            sPCA9685NumberOfSavedBytes += tNumberOfBytesToSend - tNumberOfBytesSent;
+        }
+
+        // Update shadow
+        for (uint_fast8_t tChannel = 0; tChannel < PCA9685_MAX_CHANNELS; ++tChannel) {
+            if ((tBuffer->ChannelChangedMask >> tChannel) & 1) {
+                tBuffer->ShadowPulseUnits[tChannel] = tBuffer->PulseUnits[tChannel];
+            }
+        }
+        tBuffer->ShadowIsValidMask |= tBuffer->ChannelChangedMask;
+        tBuffer->ChannelChangedMask = 0;
+    }
+}
+
+#else
+
+/*
+ * Sends all buffered values and ends the collecting of values
+ */
+void flushPCA9685Bursts() {
+    sPCA9685BurstIsActive = false;
+#  if defined(ENABLE_PCA9685_ALL_LED_WRITE)
+    bool tAllLEDWriteIsAllowed = sPCA9685AllLEDWriteIsAllowed;
+    sPCA9685AllLEDWriteIsAllowed = false;
+#  endif
+    for (uint_fast8_t i = 0; i < PCA9685_BURST_MAX_EXPANDERS; ++i) {
+        PCA9685BurstBuffer * tBuffer = &sPCA9685BurstBufferArray[i];
+#  if defined(ENABLE_PCA9685_ALL_LED_WRITE)
+        if (tAllLEDWriteIsAllowed && flushPCA9685AllLEDBurst(tBuffer)) {
+            continue;
+        }
+#  endif
+        uint16_t tMask = tBuffer->ChannelChangedMask;
+        uint_fast8_t tChannel = 0;
+        while (tMask != 0) {
+            if (!(tMask & 1)) {
+                tMask >>= 1;
+                tChannel++;
+                continue;
+            }
+            // start of a range of changed channels
+            TwoWire * tI2CClass = tBuffer->I2CClass;
+            tI2CClass->beginTransmission(tBuffer->PCA9685I2CAddress);
+            tI2CClass->write((PCA9685_FIRST_PWM_REGISTER) + 4 * tChannel); // auto increment is enabled by PCA9685Init()
+            uint_fast8_t tNumberOfChannels = 0;
+            do {
+                uint16_t tOnValue = tChannel * ((4096 - (DEFAULT_PCA9685_UNITS_FOR_180_DEGREE + 100)) / 15); // tChannel * 233
+                uint16_t tOffValue = tOnValue + tBuffer->PulseUnits[tChannel];
+                tI2CClass->write(tOnValue);
+                tI2CClass->write(tOnValue >> 8);
+                tI2CClass->write(tOffValue);
+                tI2CClass->write(tOffValue >> 8);
+                tMask >>= 1;
+                tChannel++;
+                tNumberOfChannels++;
+            } while ((tMask & 1) && tNumberOfChannels < PCA9685_MAX_CHANNELS_PER_BURST);
+            tI2CClass->endTransmission();
+        }
+        tBuffer->ChannelChangedMask = 0;
+    }
+}
+#endif // defined(ENABLE_PCA9685_SHADOW_REGISTERS)
+#endif // defined(ENABLE_PCA9685_BURST_WRITE)
+
 #endif // defined(USE_PCA9685_SERVO_EXPANDER)
 
 // Constructor without I2C address
-ServoEasing::ServoEasing() // @suppress("Class members should be properly initialized")
+ServoEasing::ServoEasing(MaxEasingServosMustBeEqualForAllFiles<MAX_EASING_SERVOS> * aMaxEasingServosCheck __attribute__((unused))) // @suppress("Class members should be properly initialized")
 #if ! defined(DO_NOT_USE_SERVO_LIB)
 :
         Servo()
@@ -240,8 +708,58 @@ ServoEasing::ServoEasing() // @suppress("Class members should be properly initia
     // On an ESP8266 it was NOT initialized to 0 :-(.
     mTrimMicrosecondsOrUnits = 0;
     mSpeed = START_EASE_TO_SPEED;
+#if defined(ENABLE_SERVO_EASING_ENGINES)
+    mEngine = &sServoEasingDefaultEngine;
+#endif
+#if defined(ENABLE_SERVO_DRIVER_INTERFACE)
+    mDriver = NULL;
+#endif
+#if defined(ENABLE_SERVO_EASING_ENGINES) || defined(ENABLE_SERVO_DRIVER_INTERFACE)
+    mServoIndex = INVALID_SERVO; // not yet attached, required for setEngine() and setDriver()
+#endif
     mServoMoves = false;
     mOperateServoReverse = false;
+    mServo0DegreeMicrosecondsOrUnits = 0;
+    mServo180DegreeMicrosecondsOrUnits = 180;
+    computeConversionFactorsAndOffsets();
+#if defined(ENABLE_WRITE_TARGET_TRACKING)
+    mIsTrackingTarget = false;
+#endif
+#if defined(ENABLE_SLEW_RATE_LIMITED_WRITE)
+    mSlewRateMaxVelocity = 0;
+    mSlewRateMaxAcceleration = 0;
+#endif
+#if defined(ENABLE_CALIBRATION_TABLE)
+    mCalibrationTable = NULL;
+#endif
+#if defined(ENABLE_VELOCITY_MODE)
+    mIsVelocityMove = false;
+    mVelocityShift8 = 0;
+#endif
+#if defined(ENABLE_DEAD_RECKONING)
+    mVelocityCalibrationPositive = NULL;
+    mVelocityCalibrationNegative = NULL;
+    mEstimatedAngleMillidegree = 0;
+    mEstimatedTurns = 0;
+    mMillisAtLastIntegration = 0;
+    mRotateByDirection = 0;
+#endif
+#if defined(ENABLE_MIN_AND_MAX_CONSTRAINTS)
+    mMinMicrosecondsOrUnits = 0;
+    mMaxMicrosecondsOrUnits = 0;
+    mNumberOfClampedWrites = 0;
+    computeMinMaxConstraintWithTrimAndReverse();
+#endif
+#if defined(ENABLE_IDLE_POWER_OFF)
+    mIsPoweredOff = false;
+    mIdlePowerOffMillis = 0;
+    mNumberOfPowerOffs = 0;
+    mPowerOffMillis = 0;
+#endif
+#if defined(ENABLE_INPUT_FILTER)
+    mInputFilterType = INPUT_FILTER_NONE;
+    mNumberOfSuppressedWrites = 0;
+#endif
 
 #if defined(USE_SERVO_LIB)
     mServoIsConnectedToExpander = false;
@@ -249,6 +767,9 @@ ServoEasing::ServoEasing() // @suppress("Class members should be properly initia
 #ifndef PROVIDE_ONLY_LINEAR_MOVEMENT
     mEasingType = EASE_LINEAR;
     mUserEaseInFunction = NULL;
+    mUserEaseInFunctionWithUserData = NULL;
+    mUserEaseInFunctionFixedPoint = NULL;
+    mUserDataPointer = NULL;
 #endif
 
 #if defined(MEASURE_SERVO_EASING_INTERRUPT_TIMING)
@@ -293,38 +814,29 @@ uint8_t ServoEasing::attach(int aPin, int aMicrosecondsForServoLowDegree, int aM
             aMicrosecondsForServoHighDegree);
 
     mServoPin = aPin;
-#if defined(USE_PCA9685_SERVO_EXPANDER)
-#  if defined(USE_SERVO_LIB)
-    if (mServoIsConnectedToExpander) {
-        mServo0DegreeMicrosecondsOrUnits = MicrosecondsToPCA9685Units(tMicrosecondsForServo0Degree);
-        mServo180DegreeMicrosecondsOrUnits = MicrosecondsToPCA9685Units(tMicrosecondsForServo180Degree);
-    } else {
-        mServo0DegreeMicrosecondsOrUnits = tMicrosecondsForServo0Degree;
-        mServo180DegreeMicrosecondsOrUnits = tMicrosecondsForServo180Degree;
-    }
-#  else
-    mServo0DegreeMicrosecondsOrUnits = MicrosecondsToPCA9685Units(tMicrosecondsForServo0Degree);
-    mServo180DegreeMicrosecondsOrUnits = MicrosecondsToPCA9685Units(tMicrosecondsForServo180Degree);
-#  endif
-#else
-    mServo0DegreeMicrosecondsOrUnits = tMicrosecondsForServo0Degree;
-    mServo180DegreeMicrosecondsOrUnits = tMicrosecondsForServo180Degree;
+    mServo0DegreeMicrosecondsOrUnits = ServoEasingDriver::toMicrosecondsOrUnits(this, tMicrosecondsForServo0Degree);
+    mServo180DegreeMicrosecondsOrUnits = ServoEasingDriver::toMicrosecondsOrUnits(this, tMicrosecondsForServo180Degree);
+    computeConversionFactorsAndOffsets();
+#if defined(ENABLE_MIN_AND_MAX_CONSTRAINTS)
+    computeMinMaxConstraintWithTrimAndReverse(); // reverse depends on the 0 and 180 degree values
+#endif
+
+#if defined(ENABLE_IDLE_POWER_OFF)
+    mIsPoweredOff = false;
+    mMillisAtLastActivity = SERVO_ENGINE(this)->getMillis();
 #endif
 
     /*
      * Now put this servo instance into list of servos
      */
-    mServoIndex = INVALID_SERVO; // flag indicating an invalid servo index
-    for (uint_fast8_t tServoIndex = 0; tServoIndex < MAX_EASING_SERVOS; ++tServoIndex) {
-        if (sServoArray[tServoIndex] == NULL) {
-            sServoArray[tServoIndex] = this;
-            mServoIndex = tServoIndex;
-            if (tServoIndex > sServoArrayMaxIndex) {
-                sServoArrayMaxIndex = tServoIndex;
-            }
-            break;
-        }
+    mServoIndex = SERVO_ENGINE(this)->registerServo(this); // INVALID_SERVO if list is full
+#if defined(ENABLE_CALIBRATION_STORE)
+    if (mServoIndex != INVALID_SERVO && loadCalibration()) {
+        // The Servo library clamps all values to the ones given at its attach()
+        tMicrosecondsForServo0Degree = mServo0DegreeMicrosecondsOrUnits;
+        tMicrosecondsForServo180Degree = mServo180DegreeMicrosecondsOrUnits;
     }
+#endif
 
 #if defined(TRACE)
     Serial.print("Index=");
@@ -343,80 +855,84 @@ uint8_t ServoEasing::attach(int aPin, int aMicrosecondsForServoLowDegree, int aM
     printStatic(&Serial);
 #endif
 
-#if defined(USE_PCA9685_SERVO_EXPANDER)
-#  if defined(USE_SERVO_LIB)
-    if (mServoIsConnectedToExpander) {
-        if (mServoIndex == 0) {
-            I2CInit();          // init only once
-            PCA9685Reset();     // reset only once
-        }
-        PCA9685Init(); // initialize at every attach is simpler but initializing once for every board would be sufficient.
-        return mServoIndex;
-    }
-#  else
-    if (mServoIndex == 0) {
-        I2CInit();          // init only once
-        PCA9685Reset();     // reset only once
-    }
-    PCA9685Init(); // initialize at every attach is simpler but initializing once for every board would be sufficient.
-    return mServoIndex;
-#  endif
-#elif defined(USE_LEIGHTWEIGHT_SERVO_LIB)
-    if(aPin != 9 && aPin != 10) {
-        return false;
-    }
-    return aPin;
-#endif // defined(USE_PCA9685_SERVO_EXPANDER)
+    return ServoEasingDriver::attach(this, tMicrosecondsForServo0Degree, tMicrosecondsForServo180Degree);
+}
 
-#if ! defined(DO_NOT_USE_SERVO_LIB)
-    if (mServoIndex == INVALID_SERVO) {
-        return INVALID_SERVO;
+void ServoEasing::detach() {
+    if (mServoIndex != INVALID_SERVO) {
+        SERVO_ENGINE(this)->unregisterServo(mServoIndex);
+        ServoEasingDriver::detach(this);
     }
-#  if defined(ARDUINO_ARCH_APOLLO3)
-    Servo::attach(aPin, tMicrosecondsForServo0Degree, tMicrosecondsForServo180Degree);
-    return aPin; // Sparkfun apollo3 Servo library has no return value for attach :-(
-#  else
-    return Servo::attach(aPin, tMicrosecondsForServo0Degree, tMicrosecondsForServo180Degree);
-#  endif
-#endif //! defined(DO_NOT_USE_SERVO_LIB)
+    mServoMoves = false; // safety net to enable right update handling if accidentally called
+    mServoIndex = INVALID_SERVO;
 }
 
-void ServoEasing::detach() {
+#if defined(ENABLE_SERVO_DRIVER_INTERFACE)
+const ServoEasingDriverInterface * sServoDriverArray[MAX_SERVO_DRIVERS]; // all driver tables set by setDriver(), to be flushed
+
+/**
+ * The functions of aDriver are used for this servo from the next attach() on. NULL selects the driver selected at compile time.
+ * Has no effect if servo is attached.
+ * @return false if servo is attached or if more than MAX_SERVO_DRIVERS different driver tables are used
+ */
+bool ServoEasing::setDriver(const ServoEasingDriverInterface * aDriver) {
     if (mServoIndex != INVALID_SERVO) {
-        sServoArray[mServoIndex] = NULL;
-        // If servo with highest index in array was detached, we want to find new sServoArrayMaxIndex
-        while (sServoArray[sServoArrayMaxIndex] == NULL && sServoArrayMaxIndex > 0) {
-            sServoArrayMaxIndex--;
+        return false;
+    }
+    if (aDriver != NULL) {
+        uint_fast8_t i = 0;
+        while (sServoDriverArray[i] != aDriver) {
+            if (sServoDriverArray[i] == NULL) {
+                sServoDriverArray[i] = aDriver;
+                break;
+            }
+            if (++i >= MAX_SERVO_DRIVERS) {
+                return false;
+            }
         }
+    }
+    mDriver = aDriver;
+    return true;
+}
 
-#if defined(USE_PCA9685_SERVO_EXPANDER)
-#  if defined(USE_SERVO_LIB)
-        if (mServoIsConnectedToExpander) {
-            setPWM(0); // set signal fully off
-        } else {
-            Servo::detach();
+/**
+ * Calls flush() of all driver tables set by setDriver(), so drivers can send the values of all servos in one transfer.
+ * Called by updateAllServos() of engines and groups and by write().
+ * If you call update() of single servos in your loop, call it after the last update().
+ */
+void flushAllServoDrivers() {
+    for (uint_fast8_t i = 0; i < MAX_SERVO_DRIVERS && sServoDriverArray[i] != NULL; ++i) {
+        if (sServoDriverArray[i]->flush != NULL) {
+            sServoDriverArray[i]->flush();
         }
-#  else
-        setPWM(0); // set signal fully off
-#  endif
-#elif defined(USE_LEIGHTWEIGHT_SERVO_LIB)
-        deinitLightweightServoPin9_10(mServoPin == 9); // disable output and change to input
-#else
-        Servo::detach();
+    }
+}
 #endif
+
+#if defined(ENABLE_SERVO_EASING_ENGINES)
+/**
+ * The servo is put into the list of aServoEasingEngine at the next attach() and is then updated by updateAllServos() of this engine.
+ * Has no effect if servo is attached.
+ */
+void ServoEasing::setEngine(ServoEasingEngine * aServoEasingEngine) {
+    if (mServoIndex == INVALID_SERVO) {
+        mEngine = aServoEasingEngine;
     }
-    mServoMoves = false; // safety net to enable right update handling if accidentally called
-    mServoIndex = INVALID_SERVO;
 }
+#endif
 
 /**
  * @note Reverse means, that values for 180 and 0 degrees are swapped by: aValue = mServo180DegreeMicrosecondsOrUnits - (aValue - mServo0DegreeMicrosecondsOrUnits)
  * Be careful, if you specify different end values, it may not behave, as you expect.
  * For this case better use the attach function with 5 parameter.
- * This flag is only used at writeMicrosecondsOrUnits()
+ * This flag is only used at writeMicrosecondsOrUnitsDirect()
  */
 void ServoEasing::setReverseOperation(bool aOperateServoReverse) {
     mOperateServoReverse = aOperateServoReverse;
+    computeConversionFactorsAndOffsets();
+#if defined(ENABLE_MIN_AND_MAX_CONSTRAINTS)
+    computeMinMaxConstraintWithTrimAndReverse();
+#endif
 }
 
 uint_fast16_t ServoEasing::getSpeed() {
@@ -427,1203 +943,4222 @@ void ServoEasing::setSpeed(uint_fast16_t aDegreesPerSecond) {
     mSpeed = aDegreesPerSecond;
 }
 
+#if defined(ENABLE_VELOCITY_MODE)
 /**
- * @param aTrimDegrees This trim value is always added to the degree/units/microseconds value requested
+ * Configure velocity mode for a continuous rotating servo. Can be called before or after attach().
+ * @param aStopMicroseconds The calibrated pulse, at which the servo really stops, e.g. 1512 instead of MICROSECONDS_FOR_ROTATING_SERVO_STOP.
+ * @param aMicrosecondsForMaxPositiveVelocity Pulse for velocity 100, e.g. MICROSECONDS_FOR_ROTATING_SERVO_CLOCKWISE_MAX.
+ *        The pulse for velocity -100 is the one mirrored at the stop pulse.
+ * @param aDeadbandMicroseconds Pulses nearer than this to the stop pulse do not move the servo. They are skipped for velocities != 0.
+ * @param aMaxAccelerationPercentPerSecond 0 means no acceleration limit. 200 -> 0.5 seconds from stop to maximum velocity.
  */
-void ServoEasing::setTrim(int aTrimDegrees, bool aDoWrite) {
-    if (aTrimDegrees >= 0) {
-        setTrimMicrosecondsOrUnits(DegreeToMicrosecondsOrUnits(aTrimDegrees) - mServo0DegreeMicrosecondsOrUnits, aDoWrite);
+void ServoEasing::setVelocityModeParameters(int aStopMicroseconds, int aMicrosecondsForMaxPositiveVelocity, uint8_t aDeadbandMicroseconds,
+        uint_fast16_t aMaxAccelerationPercentPerSecond) {
+    int tStop = ServoEasingDriver::toMicrosecondsOrUnits(this, aStopMicroseconds);
+    int tMax = ServoEasingDriver::toMicrosecondsOrUnits(this, aMicrosecondsForMaxPositiveVelocity);
+    aDeadbandMicroseconds = ServoEasingDriver::toMicrosecondsOrUnits(this, aDeadbandMicroseconds);
+    mVelocityStopMicrosecondsOrUnits = tStop;
+    mVelocityDeadbandMicrosecondsOrUnits = aDeadbandMicroseconds;
+    int32_t tRange = tMax - tStop; // signed
+    if (tRange > 0) {
+        tRange -= aDeadbandMicroseconds;
     } else {
-        setTrimMicrosecondsOrUnits(-(DegreeToMicrosecondsOrUnits(-aTrimDegrees) - mServo0DegreeMicrosecondsOrUnits), aDoWrite);
+        tRange += aDeadbandMicroseconds;
+    }
+    // velocity 100 percent is 25600 -> factor = (tRange * 65536) / 25600
+    mVelocityFactorShift16 = (tRange * 256) / 100;
+    uint32_t tMaxAcceleration = ((uint32_t) aMaxAccelerationPercentPerSecond * 256) / 1000;
+    if (aMaxAccelerationPercentPerSecond != 0 && tMaxAcceleration == 0) {
+        tMaxAcceleration = 1;
     }
+    mVelocityMaxAccelerationShift8 = tMaxAcceleration;
 }
 
 /**
- * @param aTrimMicrosecondsOrUnits This trim value is always added to the degree/units/microseconds value requested
- * @note It is only used/added at writeMicrosecondsOrUnits()
+ * Start ramping to a new velocity. The ramp is done by update() / the interrupt.
+ * @param aVelocityPercent -100 to 100, 0 is stop
  */
-void ServoEasing::setTrimMicrosecondsOrUnits(int aTrimMicrosecondsOrUnits, bool aDoWrite) {
-    mTrimMicrosecondsOrUnits = aTrimMicrosecondsOrUnits;
-    if (aDoWrite) {
-        writeMicrosecondsOrUnits(mCurrentMicrosecondsOrUnits);
+void ServoEasing::setVelocity(int aVelocityPercent, bool aStartUpdateByInterrupt) {
+    if (aVelocityPercent > 100) {
+        aVelocityPercent = 100;
+    } else if (aVelocityPercent < -100) {
+        aVelocityPercent = -100;
+    }
+#if defined(ENABLE_DEAD_RECKONING)
+    integrateEstimatedAngle(); // with the old velocity
+    mRotateByDirection = 0; // a new velocity terminates rotateBy()
+#endif
+    mTargetVelocityShift8 = aVelocityPercent * 256;
+    if (!mIsVelocityMove || !mServoMoves) {
+#if defined(ENABLE_WRITE_TARGET_TRACKING)
+        mIsTrackingTarget = false;
+#endif
+        mMillisAtStartMove = SERVO_ENGINE(this)->getMillis(); // used as timestamp of last update here
+        mIsVelocityMove = true;
+        mServoMoves = true;
+        SERVO_ENGINE(this)->setServoUpdateMaskBit(mServoIndex);
+        if (aStartUpdateByInterrupt) {
+            SERVO_ENGINE(this)->startUpdateByInterrupt(true);
+        }
     }
 }
 
-#ifndef PROVIDE_ONLY_LINEAR_MOVEMENT
-void ServoEasing::setEasingType(uint_fast8_t aEasingType) {
-    mEasingType = aEasingType;
+/*
+ * @return Current (ramped) velocity in percent
+ */
+int ServoEasing::getVelocity() {
+    return mVelocityShift8 / 256;
 }
 
-uint_fast8_t ServoEasing::getEasingType() {
-    return (mEasingType);
-}
-
-void ServoEasing::registerUserEaseInFunction(float (*aUserEaseInFunction)(float aPercentageOfCompletion)) {
-    mUserEaseInFunction = aUserEaseInFunction;
-}
-#endif
-
-void ServoEasing::write(int aValue) {
-#if defined(TRACE)
-    Serial.print(F("write "));
-    Serial.print(aValue);
-    Serial.print(' ');
-#endif
-    /*
-     * Check for valid initialization of servo.
-     */
-    if (mServoIndex == INVALID_SERVO) {
-#if defined(TRACE)
-        Serial.print(F("Error: detached servo"));
-#endif
-        return;
+/*
+ * Compute pulse for velocity. Velocity 0 gives exactly the stop pulse, all other values skip the deadband.
+ */
+int ServoEasing::VelocityToMicrosecondsOrUnits(int32_t aVelocityShift8) {
+    if (aVelocityShift8 == 0) {
+        return mVelocityStopMicrosecondsOrUnits;
     }
-    if (aValue < 400) { // treat values less than 400 as angles in degrees (valid values in microseconds are handled as microseconds)
-        sServoNextPositionArray[mServoIndex] = aValue;
-        aValue = DegreeToMicrosecondsOrUnits(aValue);
+    int tDeadband = mVelocityDeadbandMicrosecondsOrUnits;
+    if (mVelocityFactorShift16 < 0) {
+        tDeadband = -tDeadband;
     }
-    writeMicrosecondsOrUnits(aValue);
+    if (aVelocityShift8 < 0) {
+        tDeadband = -tDeadband;
+    }
+    return mVelocityStopMicrosecondsOrUnits + tDeadband + ((aVelocityShift8 * mVelocityFactorShift16) >> 16);
 }
 
-/**
- * Before sending the value to the underlying Servo library, trim and reverse is applied
+/*
+ * Called by update() while velocity is ramped
+ * @return true if target velocity was reached
  */
-void ServoEasing::writeMicrosecondsOrUnits(int aValue) {
-    /*
-     * Check for valid initialization of servo.
-     */
-    if (mServoIndex == INVALID_SERVO) {
-#if defined(TRACE)
-        Serial.print(F("Error: detached servo"));
-#endif
-        return;
+bool ServoEasing::updateVelocity() {
+    uint32_t tMillis = SERVO_ENGINE(this)->getMillis();
+    int32_t tMillisSinceLastUpdate = tMillis - mMillisAtStartMove;
+    if (tMillisSinceLastUpdate > 4 * REFRESH_INTERVAL_MILLIS) {
+        tMillisSinceLastUpdate = 4 * REFRESH_INTERVAL_MILLIS; // update was not called for a long time, avoid big jumps
     }
+    mMillisAtStartMove = tMillis;
 
-    mCurrentMicrosecondsOrUnits = aValue;
-
-#if defined(TRACE)
-    Serial.print(mServoIndex);
-    Serial.print('/');
-    Serial.print(mServoPin);
-    Serial.print(F(" us/u="));
-    Serial.print(aValue);
-    if (mTrimMicrosecondsOrUnits != 0) {
-        Serial.print(" t=");
-        Serial.print(aValue + mTrimMicrosecondsOrUnits);
+    int32_t tVelocity = mVelocityShift8;
+#if defined(ENABLE_DEAD_RECKONING)
+    integrateEstimatedAngle();
+    if (mRotateByDirection != 0) {
+        /*
+         * Check if we must start to brake in order to stop at the target of rotateBy()
+         * Braking distance is speed * stop time / 2 with stop time = velocity / acceleration.
+         */
+        int32_t tRemainingMillidegree = mRotateByRemainingMillidegree;
+        uint32_t tDegreesPerSecond = VelocityToDegreesPerSecond(tVelocity);
+        // stop also if we would pass the target before the next update
+        bool tMustBrake = tRemainingMillidegree <= (int32_t) (tDegreesPerSecond * (REFRESH_INTERVAL_MILLIS / 2));
+        if (!tMustBrake && mVelocityMaxAccelerationShift8 != 0) {
+            if (tRemainingMillidegree > 0x7FFFF) {
+                tRemainingMillidegree = 0x7FFFF; // avoid overflow below
+            }
+            tMustBrake = ((uint32_t) tRemainingMillidegree * 2 * mVelocityMaxAccelerationShift8)
+                    <= tDegreesPerSecond * (uint32_t) abs(tVelocity);
+        }
+        if (tMustBrake) {
+            mTargetVelocityShift8 = 0;
+        }
     }
-#endif // TRACE
-
-// Apply trim - this is the only place mTrimMicrosecondsOrUnits is evaluated
-    aValue += mTrimMicrosecondsOrUnits;
-// Apply reverse, values for 0 to 180 are swapped if reverse - this is the only place mOperateServoReverse is evaluated
-// (except in the DegreeToMicrosecondsOrUnitsWithTrimAndReverse() function for external testing purposes)
-    if (mOperateServoReverse) {
-        aValue = mServo180DegreeMicrosecondsOrUnits - (aValue - mServo0DegreeMicrosecondsOrUnits);
-#if defined(TRACE)
-        Serial.print(F(" r="));
-        Serial.print(aValue);
 #endif
+    int32_t tTargetVelocity = mTargetVelocityShift8;
+    if (mVelocityMaxAccelerationShift8 == 0) {
+        tVelocity = tTargetVelocity;
+    } else {
+        int32_t tVelocityChange = mVelocityMaxAccelerationShift8 * tMillisSinceLastUpdate;
+        if (tVelocity < tTargetVelocity) {
+            tVelocity += tVelocityChange;
+            if (tVelocity > tTargetVelocity) {
+                tVelocity = tTargetVelocity;
+            }
+        } else if (tVelocity > tTargetVelocity) {
+            tVelocity -= tVelocityChange;
+            if (tVelocity < tTargetVelocity) {
+                tVelocity = tTargetVelocity;
+            }
+        }
     }
+    mVelocityShift8 = tVelocity;
 
-#if defined(PRINT_FOR_SERIAL_PLOTTER)
-    Serial.print(' ');
-    Serial.print(aValue);
+    int tNewMicrosecondsOrUnits = VelocityToMicrosecondsOrUnits(tVelocity);
+    if (tNewMicrosecondsOrUnits != mCurrentMicrosecondsOrUnits) {
+        writeMicrosecondsOrUnitsDirect(tNewMicrosecondsOrUnits);
+    }
+    if (tVelocity == tTargetVelocity) {
+#if defined(ENABLE_DEAD_RECKONING)
+        if (mRotateByDirection != 0) {
+            if (tVelocity != 0) {
+                return false; // keep on checking the angle estimate
+            }
+            mRotateByDirection = 0;
+        }
 #endif
+        mIsVelocityMove = false;
+        mServoMoves = false;
+        return true;
+    }
+    return false;
+}
+#endif // defined(ENABLE_VELOCITY_MODE)
 
-#if defined(USE_LEIGHTWEIGHT_SERVO_LIB)
-    writeMicrosecondsLightweightServo(aValue, (mServoPin == 9));
+#if defined(ENABLE_DEAD_RECKONING)
+/**
+ * Set the measured speed of the servo for the angle estimate
+ * @param aDegreesPerSecondArray VELOCITY_CALIBRATION_POINTS values in degree per second for 0, 25, 50, 75 and 100 percent velocity.
+ *        The array must be valid as long as it is used by this servo.
+ * @param aDegreesPerSecondArrayForNegativeVelocity The same for -25 to -100 percent. NULL -> use aDegreesPerSecondArray.
+ */
+void ServoEasing::setVelocityCalibration(const uint16_t * aDegreesPerSecondArray, const uint16_t * aDegreesPerSecondArrayForNegativeVelocity) {
+    integrateEstimatedAngle(); // with the old calibration
+    mVelocityCalibrationPositive = aDegreesPerSecondArray;
+    if (aDegreesPerSecondArrayForNegativeVelocity == NULL) {
+        aDegreesPerSecondArrayForNegativeVelocity = aDegreesPerSecondArray;
+    }
+    mVelocityCalibrationNegative = aDegreesPerSecondArrayForNegativeVelocity;
+}
 
-#elif defined(USE_PCA9685_SERVO_EXPANDER)
-#  if defined(TRACE)
-    Serial.print(F(" s="));
-    Serial.print(mServoPin * (4096 - (DEFAULT_PCA9685_UNITS_FOR_180_DEGREE + 100)) / 15); // mServoPin * 233
-#  endif
-#  if defined(USE_SERVO_LIB)
-    if (mServoIsConnectedToExpander) {
-        setPWM(mServoPin * ((4096 - (DEFAULT_PCA9685_UNITS_FOR_180_DEGREE + 100)) / 15), aValue); // mServoPin * 233
-    } else {
-        Servo::writeMicroseconds(aValue); // requires 7 us
+/*
+ * Interpolate the calibration values. A segment is 25 percent = 6400 in Q8,
+ * and x / 6400 is computed as (x * 41) >> 18 to avoid the division.
+ * @return Degree per second for the absolute value of the velocity, 0 if no calibration is set.
+ *         uint16_t, since the calibration values can be up to 0xFFFF, which does not fit into int on AVR.
+ */
+uint16_t ServoEasing::VelocityToDegreesPerSecond(int32_t aVelocityShift8) {
+    const uint16_t * tCalibration = mVelocityCalibrationPositive;
+    if (aVelocityShift8 < 0) {
+        tCalibration = mVelocityCalibrationNegative;
+        aVelocityShift8 = -aVelocityShift8;
     }
-#  else
-    /*
-     * Distribute the servo start time over the 20 ms period.
-     * Unexpectedly this even saves 20 bytes Flash for an ATMega328P
-     */
-    setPWM(mServoPin * ((4096 - (DEFAULT_PCA9685_UNITS_FOR_180_DEGREE + 100)) / 15), aValue); // mServoPin * 233
-#  endif
+    if (tCalibration == NULL) {
+        return 0;
+    }
+    uint_fast8_t tSegment = ((uint32_t) aVelocityShift8 * 41) >> 18;
+    if (tSegment >= VELOCITY_CALIBRATION_POINTS - 1) {
+        tSegment = VELOCITY_CALIBRATION_POINTS - 2;
+    }
+    int32_t tRemainder = aVelocityShift8 - ((int32_t) tSegment * 6400);
+    int32_t tDegreesPerSecond = tCalibration[tSegment]
+            + ((((int32_t) tCalibration[tSegment + 1] - tCalibration[tSegment]) * tRemainder * 41) >> 18);
+    // (x * 41) >> 18 is slightly greater than x / 6400, so 100 percent may exceed the last calibration value
+    if (tDegreesPerSecond < 0) {
+        tDegreesPerSecond = 0;
+    } else if (tDegreesPerSecond > 0xFFFF) {
+        tDegreesPerSecond = 0xFFFF;
+    }
+    return tDegreesPerSecond;
+}
 
-#else
-    Servo::writeMicroseconds(aValue); // requires 7 us
-#endif
+/*
+ * Add the rotation since the last call, assuming the servo turned with the current velocity.
+ * The speed is in degree per second, so speed * milliseconds gives millidegree without any division.
+ * The speed is at most 0xFFFF degree per second, so the interval is integrated in steps of 0x7FFF ms to fit into int32_t.
+ */
+void ServoEasing::integrateEstimatedAngle() {
+    uint32_t tMillis = SERVO_ENGINE(this)->getMillis();
+    uint32_t tMillisSinceLastIntegration = tMillis - mMillisAtLastIntegration;
+    mMillisAtLastIntegration = tMillis;
+    int32_t tVelocity = mVelocityShift8;
+    if (tVelocity != 0) {
+        int32_t tDegreesPerSecond = VelocityToDegreesPerSecond(tVelocity);
+        if (tVelocity < 0) {
+            tDegreesPerSecond = -tDegreesPerSecond;
+        }
+        while (tMillisSinceLastIntegration > 0) {
+            uint16_t tMillisOfStep = 0x7FFF;
+            if (tMillisSinceLastIntegration < tMillisOfStep) {
+                tMillisOfStep = tMillisSinceLastIntegration;
+            }
+            tMillisSinceLastIntegration -= tMillisOfStep;
+            addToEstimatedAngle(tDegreesPerSecond * tMillisOfStep);
+        }
+    }
+}
 
-#if defined(TRACE)
-    Serial.println();
-#endif
+/*
+ * The angle is kept between 0 and MILLIDEGREE_PER_TURN - 1 and the full turns are counted separately,
+ * so the estimate does not overflow after 5965 turns.
+ */
+void ServoEasing::addToEstimatedAngle(int32_t aMillidegree) {
+    if (mRotateByDirection != 0) {
+        mRotateByRemainingMillidegree -= aMillidegree * mRotateByDirection;
+        if (mRotateByRemainingMillidegree < 0) {
+            mRotateByRemainingMillidegree = 0; // target passed, brake as fast as possible
+        }
+    }
+    if (aMillidegree >= MILLIDEGREE_PER_TURN || aMillidegree <= -MILLIDEGREE_PER_TURN) {
+        // avoid the 32 bit division for the normal case of less than one turn per update
+        mEstimatedTurns += aMillidegree / MILLIDEGREE_PER_TURN;
+        aMillidegree %= MILLIDEGREE_PER_TURN;
+    }
+    int32_t tAngleMillidegree = mEstimatedAngleMillidegree + aMillidegree;
+    if (tAngleMillidegree < 0) {
+        tAngleMillidegree += MILLIDEGREE_PER_TURN;
+        mEstimatedTurns--;
+    } else if (tAngleMillidegree >= MILLIDEGREE_PER_TURN) {
+        tAngleMillidegree -= MILLIDEGREE_PER_TURN;
+        mEstimatedTurns++;
+    }
+    mEstimatedAngleMillidegree = tAngleMillidegree;
 }
 
-int ServoEasing::MicrosecondsOrUnitsToDegree(int aMicrosecondsOrUnits) {
-    /*
-     * Formula for microseconds:
-     * (aMicrosecondsOrUnits - mServo0DegreeMicrosecondsOrUnits) * (180 / 1856) // 1856 = 180 - 0 degree micros
-     * Formula for PCA9685 units
-     * (aMicrosecondsOrUnits - mServo0DegreeMicrosecondsOrUnits) * (180 / 380) // 380 = 180 - 0 degree units
-     * Formula for both without rounding
-     * map(aMicrosecondsOrUnits, mServo0DegreeMicrosecondsOrUnits, mServo180DegreeMicrosecondsOrUnits, 0, 180)
-     */
+/*
+ * @return Estimated angle within the current turn, 0 to 359999. The turns are returned by getEstimatedTurns().
+ */
+int32_t ServoEasing::getEstimatedAngleMillidegree() {
+    integrateEstimatedAngle();
+    return mEstimatedAngleMillidegree;
+}
 
-// map with rounding
-    int32_t tResult = aMicrosecondsOrUnits - mServo0DegreeMicrosecondsOrUnits;
-#if defined(USE_PCA9685_SERVO_EXPANDER)
-#  if defined(USE_SERVO_LIB)
-    if (mServoIsConnectedToExpander) {
-        tResult = (tResult * 180) + 190;
-    } else {
-        tResult = (tResult * 180) + 928;
-    }
-#  else
-    tResult = (tResult * 180) + 190;
-#  endif
-#else
-    tResult = (tResult * 180) + 928;
-#endif
-    return (tResult / (mServo180DegreeMicrosecondsOrUnits - mServo0DegreeMicrosecondsOrUnits));
+/*
+ * @return Estimated number of full turns, negative for turns in negative direction.
+ */
+int32_t ServoEasing::getEstimatedTurns() {
+    integrateEstimatedAngle();
+    return mEstimatedTurns;
+}
 
+/*
+ * Sets the estimated angle, e.g. to 0 at a reference position. Angles outside 0 to 359999 also set the turns.
+ */
+void ServoEasing::setEstimatedAngleMillidegree(int32_t aEstimatedAngleMillidegree) {
+    integrateEstimatedAngle(); // to set mMillisAtLastIntegration
+    mEstimatedAngleMillidegree = 0;
+    mEstimatedTurns = 0;
+    int8_t tRotateByDirection = mRotateByDirection;
+    mRotateByDirection = 0; // setting the angle must not change the remaining angle of rotateBy()
+    addToEstimatedAngle(aEstimatedAngleMillidegree);
+    mRotateByDirection = tRotateByDirection;
 }
 
 /**
- * We have around 10 us per degree
+ * Rotate by aDegrees with aVelocityPercent using the angle estimate. Open loop, so accuracy depends on the calibration.
+ * @return false if no calibration was set by setVelocityCalibration()
  */
-int ServoEasing::DegreeToMicrosecondsOrUnits(int aDegree) {
-// For microseconds and PCA9685 units:
-    return map(aDegree, 0, 180, mServo0DegreeMicrosecondsOrUnits, mServo180DegreeMicrosecondsOrUnits);
+bool ServoEasing::rotateBy(int aDegrees, int aVelocityPercent, bool aStartUpdateByInterrupt) {
+    if (mVelocityCalibrationPositive == NULL) {
+        return false;
+    }
+    integrateEstimatedAngle();
+    mRotateByRemainingMillidegree = (int32_t) abs(aDegrees) * 1000;
+    aVelocityPercent = abs(aVelocityPercent);
+    int8_t tDirection = 1;
+    if (aDegrees < 0) {
+        tDirection = -1;
+        aVelocityPercent = -aVelocityPercent;
+    }
+    setVelocity(aVelocityPercent, aStartUpdateByInterrupt);
+    mRotateByDirection = tDirection;
+    return true;
 }
+#endif // defined(ENABLE_DEAD_RECKONING)
 
+#if defined(ENABLE_MIN_AND_MAX_CONSTRAINTS)
 /**
- * Mainly for testing, since trim and reverse are applied at each write.
+ * All values written to the servo are clamped to these limits. Must be called after attach().
+ * The limits are given like the values for write(), i.e. without trim and reverse,
+ * but they are converted to the values written to the servo here and at each change of trim or reverse.
+ * So clamping requires only 2 compares in writeMicrosecondsOrUnitsDirect().
+ * @param aMinDegreeOrMicrosecond Values < 400 are taken as degree, like in write()
  */
-int ServoEasing::DegreeToMicrosecondsOrUnitsWithTrimAndReverse(int aDegree) {
-// For microseconds and PCA9685 units:
-    int tResultValue = map(aDegree, 0, 180, mServo0DegreeMicrosecondsOrUnits, mServo180DegreeMicrosecondsOrUnits);
-    tResultValue += mTrimMicrosecondsOrUnits;
-    if (mOperateServoReverse) {
-        tResultValue = mServo180DegreeMicrosecondsOrUnits - (tResultValue - mServo0DegreeMicrosecondsOrUnits);
+void ServoEasing::setMinMaxConstraint(int aMinDegreeOrMicrosecond, int aMaxDegreeOrMicrosecond) {
+    if (aMinDegreeOrMicrosecond < 400) {
+        aMinDegreeOrMicrosecond = DegreeToMicrosecondsOrUnits(aMinDegreeOrMicrosecond);
     }
-    return tResultValue;
+    if (aMaxDegreeOrMicrosecond < 400) {
+        aMaxDegreeOrMicrosecond = DegreeToMicrosecondsOrUnits(aMaxDegreeOrMicrosecond);
+    }
+    mMinMicrosecondsOrUnits = aMinDegreeOrMicrosecond;
+    mMaxMicrosecondsOrUnits = aMaxDegreeOrMicrosecond;
+    computeMinMaxConstraintWithTrimAndReverse();
 }
 
-void ServoEasing::easeTo(int aDegree) {
-    easeTo(aDegree, mSpeed);
+void ServoEasing::removeMinMaxConstraint() {
+    mMinMicrosecondsOrUnits = 0;
+    mMaxMicrosecondsOrUnits = 0;
+    computeMinMaxConstraintWithTrimAndReverse();
 }
 
-/**
- * Blocking move without interrupt
- * @param aDegreesPerSecond Can range from 1 to the physically maximum value of 450
+/*
+ * Apply trim and reverse to the limits in the same way as writeMicrosecondsOrUnitsDirect() does it for the values
  */
-void ServoEasing::easeTo(int aDegree, uint_fast16_t aDegreesPerSecond) {
-    startEaseTo(aDegree, aDegreesPerSecond, false);
-    do {
-        // First do the delay, then check for update, since we are likely called directly after start and there is nothing to move yet
-        delay(REFRESH_INTERVAL_MILLIS); // 20 ms
-#if defined(PRINT_FOR_SERIAL_PLOTTER)
-    } while (!updateAllServos());
-#else
-    } while (!update());
-#endif
+void ServoEasing::computeMinMaxConstraintWithTrimAndReverse() {
+    if (mMinMicrosecondsOrUnits >= mMaxMicrosecondsOrUnits) {
+        // no constraint
+        mMinMicrosecondsOrUnitsWithTrimAndReverse = 0;
+        mMaxMicrosecondsOrUnitsWithTrimAndReverse = 0x7FFF;
+        return;
+    }
+    int tMin = mMinMicrosecondsOrUnits + mTrimMicrosecondsOrUnits;
+    int tMax = mMaxMicrosecondsOrUnits + mTrimMicrosecondsOrUnits;
+    if (mOperateServoReverse) {
+        // min and max are swapped by reverse
+        int tReversedMin = mServo180DegreeMicrosecondsOrUnits - (tMax - mServo0DegreeMicrosecondsOrUnits);
+        tMax = mServo180DegreeMicrosecondsOrUnits - (tMin - mServo0DegreeMicrosecondsOrUnits);
+        tMin = tReversedMin;
+    }
+    mMinMicrosecondsOrUnitsWithTrimAndReverse = tMin;
+    mMaxMicrosecondsOrUnitsWithTrimAndReverse = tMax;
 }
 
-void ServoEasing::easeToD(int aDegree, uint_fast16_t aMillisForMove) {
-    startEaseToD(aDegree, aMillisForMove, false);
-    do {
-        delay(REFRESH_INTERVAL_MILLIS); // 20 ms
-#if defined(PRINT_FOR_SERIAL_PLOTTER)
-    } while (!updateAllServos());
-#else
-    } while (!update());
-#endif
+/*
+ * @return Number of values clamped by the limits of setMinMaxConstraint(). Saturates at 0xFFFF.
+ */
+uint16_t ServoEasing::getNumberOfClampedWrites() {
+    // Counter is incremented by ISR, so read the 2 bytes atomically
+    SERVO_EASING_DISABLE_INTERRUPTS();
+    uint16_t tNumberOfClampedWrites = mNumberOfClampedWrites;
+    SERVO_EASING_RESTORE_INTERRUPTS();
+    return tNumberOfClampedWrites;
 }
+#endif // defined(ENABLE_MIN_AND_MAX_CONSTRAINTS)
 
-bool ServoEasing::setEaseTo(int aDegree) {
-    return startEaseTo(aDegree, mSpeed, false);
+#if defined(ENABLE_IDLE_POWER_OFF)
+/**
+ * Switch the pulse off, if the servo was not written for aMillisUntilPowerOff milliseconds.
+ * The check is done by updateAllServos(), which is called by the interrupt started here or by the user.
+ * @param aMillisUntilPowerOff 0 -> no automatic power off
+ */
+void ServoEasing::setIdlePowerOffMillis(uint16_t aMillisUntilPowerOff) {
+    mIdlePowerOffMillis = aMillisUntilPowerOff;
+    mMillisAtLastActivity = SERVO_ENGINE(this)->getMillis();
+    if (aMillisUntilPowerOff != 0 && mServoIndex != INVALID_SERVO) {
+        armIdlePowerOff();
+    }
 }
 
-/**
- * Sets easing parameter, but does not start interrupt
- * @return false if servo was still moving
+/*
+ * Let updateAllServos() check this servo for power off and start the interrupt, which is not running after a plain write().
+ * While the power off is pending, the interrupt keeps running and calls updateAllServos() every 20 ms.
  */
-bool ServoEasing::setEaseTo(int aDegree, uint_fast16_t aDegreesPerSecond) {
-    return startEaseTo(aDegree, aDegreesPerSecond, false);
+void ServoEasing::armIdlePowerOff() {
+    ServoEasingEngine * tEngine = SERVO_ENGINE(this);
+    tEngine->setServoUpdateMaskBit(mServoIndex);
+    if (!tEngine->mIdlePowerOffIsPending) {
+        tEngine->mIdlePowerOffIsPending = true; // keeps the interrupt running, even if no servo moves
+        tEngine->startUpdateByInterrupt(true);
+    }
 }
 
-/**
- * Starts interrupt for update()
+/*
+ * Called by updateAllServos()
+ * @return true if power off of this servo is pending
  */
-bool ServoEasing::startEaseTo(int aDegree) {
-    return startEaseTo(aDegree, mSpeed, true);
+bool ServoEasing::checkIdlePowerOff() {
+    if (mIdlePowerOffMillis == 0 || mIsPoweredOff || mServoMoves) {
+        return false;
+    }
+    if (SERVO_ENGINE(this)->getMillis() - mMillisAtLastActivity < mIdlePowerOffMillis) {
+        return true;
+    }
+    powerOff();
+    return false;
 }
 
 /**
- * Sets up all the values required for a smooth move to new value
- * returns false if servo was still moving
+ * Switch the pulse off, but keep the servo in the list of servos and keep all its values.
+ * PCA9685 channels are set to full off, other servos are detached from the timer.
+ * Without a pulse, most servos are not holding their position any more!
  */
-bool ServoEasing::startEaseTo(int aDegree, uint_fast16_t aDegreesPerSecond, bool aStartUpdateByInterrupt) {
-    int tCurrentAngle = MicrosecondsOrUnitsToDegree(mCurrentMicrosecondsOrUnits);
-    if (aDegree == tCurrentAngle) {
-        // no effective movement -> return
-        return !mServoMoves;
+void ServoEasing::powerOff() {
+    if (mIsPoweredOff || mServoIndex == INVALID_SERVO) {
+        return;
     }
-    if (aDegreesPerSecond == 0) {
-#if defined(DEBUG)
-        Serial.println(F("Speed is 0 -> set to 1"));
+#if defined(TRACE)
+    Serial.print(mServoIndex);
+    Serial.println(F(" power off"));
 #endif
-        aDegreesPerSecond = 1;
+    ServoEasingDriver::powerOff(this);
+    mIsPoweredOff = true;
+    if (mNumberOfPowerOffs != 0xFFFF) {
+        mNumberOfPowerOffs++;
     }
-    uint_fast16_t tMillisForCompleteMove = abs(aDegree - tCurrentAngle) * 1000L / aDegreesPerSecond;
+    mMillisAtLastActivity = SERVO_ENGINE(this)->getMillis();
+}
 
-#ifndef PROVIDE_ONLY_LINEAR_MOVEMENT
-    if ((mEasingType & CALL_STYLE_MASK) == CALL_STYLE_BOUNCING_OUT_IN) {
-        // bouncing has double movement, so take double time
-        tMillisForCompleteMove *= 2;
-    }
+/*
+ * Called by writeMicrosecondsOrUnitsDirect() if powered off.
+ * Only the output is enabled again. The list of servos and the PCA9685 are not touched, since they are still valid.
+ * For PCA9685 the full off bit is cleared by the following write of the pulse.
+ */
+void ServoEasing::reengage() {
+#if defined(TRACE)
+    Serial.print(mServoIndex);
+    Serial.println(F(" re-engage"));
 #endif
-    return startEaseToD(aDegree, tMillisForCompleteMove, aStartUpdateByInterrupt);
+    ServoEasingDriver::reengage(this);
+    mIsPoweredOff = false;
+    mPowerOffMillis += SERVO_ENGINE(this)->getMillis() - mMillisAtLastActivity;
 }
 
-/**
- * Lower level function with time instead of speed parameter
- * Sets easing parameter, but does not start
+bool ServoEasing::isPoweredOff() {
+    return mIsPoweredOff;
+}
+
+/*
+ * @return Number of power offs. Saturates at 0xFFFF.
  */
-bool ServoEasing::setEaseToD(int aDegree, uint_fast16_t aMillisForMove) {
-    return startEaseToD(aDegree, aMillisForMove, false);
+uint16_t ServoEasing::getNumberOfPowerOffs() {
+    return mNumberOfPowerOffs;
+}
+
+/*
+ * @return Milliseconds the servo was powered off, including the current power off period.
+ */
+uint32_t ServoEasing::getPowerOffMillis() {
+    if (mIsPoweredOff) {
+        return mPowerOffMillis + (SERVO_ENGINE(this)->getMillis() - mMillisAtLastActivity);
+    }
+    return mPowerOffMillis;
 }
+#endif // defined(ENABLE_IDLE_POWER_OFF)
 
+#if defined(ENABLE_SLEW_RATE_LIMITED_WRITE)
 /**
- * Lower level function with time instead of speed parameter
- * @return false if servo was still moving
+ * Limits speed and acceleration of all following write() and writeMicrosecondsOrUnits() calls.
+ * The value written is then only the target, which is approached by update() / the interrupt.
+ * Must be called after attach(), since the limits are converted to microseconds or units here.
+ * @param aMaxDegreesPerSecond 0 disables the limit, i.e. write() behaves like before
+ * @param aMaxDegreesPerSecondSquared 0 means no acceleration limit
  */
-bool ServoEasing::startEaseToD(int aDegree, uint_fast16_t aMillisForMove, bool aStartUpdateByInterrupt) {
+void ServoEasing::setSlewRateLimit(uint_fast16_t aMaxDegreesPerSecond, uint_fast16_t aMaxDegreesPerSecondSquared) {
+    uint32_t tSpan = abs(mServo180DegreeMicrosecondsOrUnits - mServo0DegreeMicrosecondsOrUnits); // microseconds or units per 180 degree
     /*
-     * Check for valid initialization of servo.
+     * Velocity is stored as (microseconds or units / 256) per millisecond
+     * 540 degree per second for a MG90 gives 1400 for microseconds and 290 for PCA9685 units
      */
-    if (mServoIndex == INVALID_SERVO) {
-#if defined(TRACE)
-        Serial.print(F("Error: detached servo"));
-#endif
-        return true;
+    uint32_t tMaxVelocity = ((uint32_t) aMaxDegreesPerSecond * tSpan * 256) / (180L * 1000L);
+    if (tMaxVelocity > 0x7FFF) {
+        tMaxVelocity = 0x7FFF;
     }
-// write the position also to sServoNextPositionArray
-    sServoNextPositionArray[mServoIndex] = aDegree;
-    mEndMicrosecondsOrUnits = DegreeToMicrosecondsOrUnits(aDegree);
-    int tCurrentMicrosecondsOrUnits = mCurrentMicrosecondsOrUnits;
-    mDeltaMicrosecondsOrUnits = mEndMicrosecondsOrUnits - tCurrentMicrosecondsOrUnits;
-
-    mMillisForCompleteMove = aMillisForMove;
-    mStartMicrosecondsOrUnits = tCurrentMicrosecondsOrUnits;
+    if (aMaxDegreesPerSecond != 0 && tMaxVelocity == 0) {
+        tMaxVelocity = 1;
+    }
+    mSlewRateMaxVelocity = tMaxVelocity;
+    /*
+     * Acceleration is stored as (microseconds or units / 65536) per millisecond squared
+     * (aMaxDegreesPerSecondSquared * tSpan * 65536) / (180 * 1000 * 1000) = (aMaxDegreesPerSecondSquared * tSpan) / 2747
+     * 1000 degree per second squared gives 675 for microseconds and 138 for PCA9685 units
+     */
+    uint32_t tMaxAcceleration = ((uint32_t) aMaxDegreesPerSecondSquared * tSpan) / 2747;
+    if (tMaxAcceleration > 0xFFFF) {
+        tMaxAcceleration = 0xFFFF;
+    }
+    if (aMaxDegreesPerSecondSquared != 0 && tMaxAcceleration == 0) {
+        tMaxAcceleration = 1;
+    }
+    mSlewRateMaxAcceleration = tMaxAcceleration;
+}
 
-#ifndef PROVIDE_ONLY_LINEAR_MOVEMENT
-    if ((mEasingType & CALL_STYLE_MASK) == CALL_STYLE_BOUNCING_OUT_IN) {
-        // bouncing has same end position as start position
-        mEndMicrosecondsOrUnits = tCurrentMicrosecondsOrUnits;
+/*
+ * Called by updateWriteTarget() for a movement started by writeMicrosecondsOrUnits() if a slew rate limit is set.
+ * Position is kept with 8 bit fraction to support slow speeds.
+ * Deceleration starts if the stopping distance v^2 / 2a reaches the remaining distance.
+ * This check requires only multiplications.
+ * @return true if target was reached
+ */
+bool ServoEasing::updateSlewRateLimitedMove(int aTargetMicrosecondsOrUnits) {
+    uint32_t tMillis = SERVO_ENGINE(this)->getMillis();
+    int32_t tMillisSinceLastUpdate = tMillis - mMillisAtStartMove;
+    if (tMillisSinceLastUpdate == 0) {
+        return false;
     }
-#endif
+    if (tMillisSinceLastUpdate > 4 * REFRESH_INTERVAL_MILLIS) {
+        // update was not called for a long time, avoid big jumps
+        tMillisSinceLastUpdate = 4 * REFRESH_INTERVAL_MILLIS;
+    }
+    mMillisAtStartMove = tMillis;
 
-    mMillisAtStartMove = millis();
+    int32_t tTargetShift8 = (int32_t) aTargetMicrosecondsOrUnits << 8;
+    int32_t tRemainingShift8 = tTargetShift8 - mTrackingPositionShift8;
+    int32_t tDirection = (tRemainingShift8 >= 0) ? 1 : -1;
+    int32_t tVelocity = mTrackingVelocity;
 
-#if defined(TRACE)
-    printDynamic(&Serial, true);
-#elif defined(DEBUG)
-    printDynamic(&Serial);
-#endif
+    if (mSlewRateMaxAcceleration == 0) {
+        tVelocity = tDirection * (int32_t) mSlewRateMaxVelocity;
+    } else {
+        int32_t tAbsoluteRemaining = (tRemainingShift8 * tDirection) >> 8;
+        if (tAbsoluteRemaining > 0x3FFF) {
+            tAbsoluteRemaining = 0x3FFF; // avoid overflow below
+        }
+        int32_t tVelocityChange = ((int32_t) mSlewRateMaxAcceleration * tMillisSinceLastUpdate) >> 8;
+        if (tVelocityChange == 0) {
+            tVelocityChange = 1;
+        }
+        /*
+         * Brake if moving away from target or if stopping distance is reached
+         */
+        if ((tVelocity * tDirection) < 0
+                || (tVelocity * tVelocity) >= (2 * (int32_t) mSlewRateMaxAcceleration * tAbsoluteRemaining)) {
+            if (tVelocity > 0) {
+                tVelocity -= tVelocityChange;
+                if (tVelocity < 0) {
+                    tVelocity = 0;
+                }
+            } else {
+                tVelocity += tVelocityChange;
+                if (tVelocity > 0) {
+                    tVelocity = 0;
+                }
+            }
+        } else {
+            tVelocity += tDirection * tVelocityChange;
+            if (tVelocity > (int32_t) mSlewRateMaxVelocity) {
+                tVelocity = mSlewRateMaxVelocity;
+            } else if (tVelocity < -(int32_t) mSlewRateMaxVelocity) {
+                tVelocity = -(int32_t) mSlewRateMaxVelocity;
+            }
+        }
+        if (tVelocity == 0 && tAbsoluteRemaining != 0) {
+            // avoid getting stuck in front of the target due to rounding
+            tVelocity = tDirection;
+        }
+    }
 
-    bool tReturnValue = !mServoMoves;
+    bool tTargetReached = false;
+    mTrackingPositionShift8 += tVelocity * tMillisSinceLastUpdate;
+    if ((tDirection > 0 && mTrackingPositionShift8 >= tTargetShift8) || (tDirection < 0 && mTrackingPositionShift8 <= tTargetShift8)) {
+        mTrackingPositionShift8 = tTargetShift8;
+        tVelocity = 0;
+        tTargetReached = true;
+    }
+    mTrackingVelocity = tVelocity;
 
-// Check after printDynamic() to see the values
-    if (mDeltaMicrosecondsOrUnits != 0) {
-        mServoMoves = true;
-        if (aStartUpdateByInterrupt) {
-            enableServoEasingInterrupt();
-        }
+    int tNewMicrosecondsOrUnits = (mTrackingPositionShift8 + 0x80) >> 8;
+    if (tNewMicrosecondsOrUnits != mCurrentMicrosecondsOrUnits) {
+        writeMicrosecondsOrUnitsDirect(tNewMicrosecondsOrUnits);
     }
-    return tReturnValue;
+    return tTargetReached;
 }
+#endif // defined(ENABLE_SLEW_RATE_LIMITED_WRITE)
 
-void ServoEasing::stop() {
-    mServoMoves = false;
-    if (!isOneServoMoving()) {
-        // disable interrupt only if all servos stopped. This enables independent movements of servos with one interrupt handler.
-        disableServoEasingInterrupt();
-    }
+#if defined(ENABLE_INPUT_FILTER)
+/**
+ * Sets a filter for the values of all following write() and writeMicrosecondsOrUnits() calls.
+ * The filter is computed once at every call of update(), i.e. every 20 ms if called by interrupt.
+ * Only integer arithmetic is used.
+ * @param aFilterType INPUT_FILTER_NONE, INPUT_FILTER_IIR, INPUT_FILTER_ONE_EURO or INPUT_FILTER_DEADBAND
+ * @param aParameter For INPUT_FILTER_IIR and INPUT_FILTER_ONE_EURO: the filter shift. 1 -> output moves 1/2 of the way at each update,
+ *                   3 -> 1/8 of the way. INPUT_FILTER_ONE_EURO uses this value only at rest.
+ *                   For INPUT_FILTER_DEADBAND: changes smaller or equal this value (in microseconds or units) are ignored.
+ * @param aSpeedCoefficient Only for INPUT_FILTER_ONE_EURO: the bigger, the faster the filter follows quick changes of the input.
+ *                   The filter coefficient is increased by aSpeedCoefficient / 256 per microsecond or unit per update.
+ */
+void ServoEasing::setInputFilter(uint8_t aFilterType, uint8_t aParameter, uint8_t aSpeedCoefficient) {
+    mInputFilterType = aFilterType;
+    mInputFilterParameter = aParameter;
+    mInputFilterSpeedCoefficient = aSpeedCoefficient;
 }
 
-void ServoEasing::continueWithInterrupts() {
-    mServoMoves = true;
-    enableServoEasingInterrupt();
+/**
+ * @return Number of updates, where the filtered value was equal to the current servo value and therefore nothing was written
+ *         to the servo (since last resetInputFilterStatistics()). The counter stops at 0xFFFF.
+ */
+uint16_t ServoEasing::getNumberOfSuppressedWrites() {
+    // Counter is incremented by ISR, so read the 2 bytes atomically
+    SERVO_EASING_DISABLE_INTERRUPTS();
+    uint16_t tNumberOfSuppressedWrites = mNumberOfSuppressedWrites;
+    SERVO_EASING_RESTORE_INTERRUPTS();
+    return tNumberOfSuppressedWrites;
 }
 
-void ServoEasing::continueWithoutInterrupts() {
-    mServoMoves = true;
+void ServoEasing::resetInputFilterStatistics() {
+    SERVO_EASING_DISABLE_INTERRUPTS();
+    mNumberOfSuppressedWrites = 0;
+    SERVO_EASING_RESTORE_INTERRUPTS();
 }
 
 /*
- * returns true if endAngle was reached / servo stopped
+ * Computes one step of the input filter
+ * @return true if output of filter equals the input
  */
-#ifdef PROVIDE_ONLY_LINEAR_MOVEMENT
-bool ServoEasing::update() {
+bool ServoEasing::updateInputFilter(int * aFilteredMicrosecondsOrUnits) {
+    int tInput = mTargetMicrosecondsOrUnits;
+    int32_t tInputShift8 = (int32_t) tInput << 8;
+    int32_t tDifferenceShift8 = tInputShift8 - mInputFilterStateShift8;
+
+    if (mInputFilterType == INPUT_FILTER_DEADBAND) {
+        // Accept only changes, which are bigger than deadband
+        if (abs(tInput - (int) (mInputFilterStateShift8 >> 8)) > mInputFilterParameter) {
+            mInputFilterStateShift8 = tInputShift8;
+        }
+        *aFilteredMicrosecondsOrUnits = mInputFilterStateShift8 >> 8;
+        return true; // Nothing more to do until next write()
 
-    if (!mServoMoves) {
-        return true;
-    }
+    } else if (mInputFilterType == INPUT_FILTER_ONE_EURO) {
+        /*
+         * Adaptive smoothing: the filter coefficient is increased with the (smoothed) speed of the input.
+         * -> strong smoothing at rest, little lag for fast movements.
+         */
+        int tInputChange = tInput - mInputFilterLastInput;
+        mInputFilterLastInput = tInput;
+        mInputFilterDerivative = (mInputFilterDerivative + tInputChange) / 2; // division rounds towards 0 so it decays to 0
+        uint32_t tCoefficientShift8 = (256 >> mInputFilterParameter)
+                + (uint32_t) abs(mInputFilterDerivative) * mInputFilterSpeedCoefficient;
+        if (tCoefficientShift8 > 256) {
+            tCoefficientShift8 = 256;
+        }
+        mInputFilterStateShift8 += (tDifferenceShift8 * (int32_t) tCoefficientShift8) / 256;
 
-    uint32_t tMillisSinceStart = millis() - mMillisAtStartMove;
-    if (tMillisSinceStart >= mMillisForCompleteMove) {
-        // end of time reached -> write end position and return true
-        writeMicrosecondsOrUnits(mEndMicrosecondsOrUnits);
-        mServoMoves = false;
-        return true;
+    } else {
+        // INPUT_FILTER_IIR
+        mInputFilterStateShift8 += tDifferenceShift8 >> mInputFilterParameter;
     }
+
     /*
-     * Use faster non float arithmetic
-     * Linear movement: new position is: start position + total delta * (millis_done / millis_total aka "percentage of completion")
-     * 40 us to compute
-     */
-    uint_fast16_t tNewMicrosecondsOrUnits = mStartMicrosecondsOrUnits
-    + ((mDeltaMicrosecondsOrUnits * (int32_t) tMillisSinceStart) / mMillisForCompleteMove);
-    /*
-     * Write new position only if changed
+     * Snap to input if we are near enough, since the filter approaches the input only asymptotically
      */
-    if (tNewMicrosecondsOrUnits != mCurrentMicrosecondsOrUnits) {
-        writeMicrosecondsOrUnits(tNewMicrosecondsOrUnits);
+    tDifferenceShift8 = tInputShift8 - mInputFilterStateShift8;
+    if (tDifferenceShift8 > -0x80 && tDifferenceShift8 < 0x80) {
+        mInputFilterStateShift8 = tInputShift8;
+        *aFilteredMicrosecondsOrUnits = tInput;
+        return mInputFilterType == INPUT_FILTER_IIR || mInputFilterDerivative == 0;
     }
+    *aFilteredMicrosecondsOrUnits = (mInputFilterStateShift8 + 0x80) >> 8;
     return false;
 }
+#endif // defined(ENABLE_INPUT_FILTER)
 
-#else // PROVIDE_ONLY_LINEAR_MOVEMENT
-bool ServoEasing::update() {
-
-    if (!mServoMoves) {
-#  if defined(PRINT_FOR_SERIAL_PLOTTER)
-        // call it always for serial plotter
-        writeMicrosecondsOrUnits(mCurrentMicrosecondsOrUnits);
-#  endif
+#if defined(ENABLE_WRITE_TARGET_TRACKING)
+bool ServoEasing::isWriteTargetTracked() {
+#  if defined(ENABLE_SLEW_RATE_LIMITED_WRITE)
+    if (mSlewRateMaxVelocity != 0) {
         return true;
     }
-
-    uint32_t tMillisSinceStart = millis() - mMillisAtStartMove;
-    if (tMillisSinceStart >= mMillisForCompleteMove) {
-        // end of time reached -> write end position and return true
-        writeMicrosecondsOrUnits(mEndMicrosecondsOrUnits);
-        mServoMoves = false;
+#  endif
+#  if defined(ENABLE_INPUT_FILTER)
+    if (mInputFilterType != INPUT_FILTER_NONE) {
         return true;
     }
-
-    int tNewMicrosecondsOrUnits;
-    if (mEasingType == EASE_LINEAR) {
-        /*
-         * Use faster non float arithmetic
-         * Linear movement: new position is: start position + total delta * (millis_done / millis_total aka "percentage of completion")
-         * 40 us to compute
-         * Cast to int32 required for mMillisForCompleteMove for 32 bit platforms, otherwise we divide signed by unsigned. Thanks to drifkind.
-         */
-        tNewMicrosecondsOrUnits = mStartMicrosecondsOrUnits
-                + ((mDeltaMicrosecondsOrUnits * (int32_t) tMillisSinceStart) / (int32_t) mMillisForCompleteMove);
-    } else {
-        /*
-         * Non linear movement -> use floats
-         * Compute tPercentageOfCompletion - from 0.0 to 1.0
-         * The expected result of easing function is from 0.0 to 1.0
-         * or from EASE_FUNCTION_DEGREE_OFFSET to EASE_FUNCTION_DEGREE_OFFSET + 180 for direct degree result
-         */
-        float tPercentageOfCompletion = (float) tMillisSinceStart / (float) mMillisForCompleteMove;
-        float tEaseResult = 0.0;
-
-        uint_fast8_t tCallStyle = mEasingType & CALL_STYLE_MASK; // Values are CALL_STYLE_DIRECT, CALL_STYLE_OUT, CALL_STYLE_IN_OUT, CALL_STYLE_BOUNCING_OUT_IN
-
-        if (tCallStyle == CALL_STYLE_DIRECT) {
-            // Use IN function direct: Call with PercentageOfCompletion | 0.0 to 1.0. Result is from 0.0 to 1.0
-            tEaseResult = callEasingFunction(tPercentageOfCompletion);
-
-        } else if (tCallStyle == CALL_STYLE_OUT) {
-            // Use IN function to generate OUT function: Call with (1 - PercentageOfCompletion) | 1.0 to 0.0. Result = (1 - result)
-            tEaseResult = 1.0 - (callEasingFunction(1.0 - tPercentageOfCompletion));
-
-        } else {
-            if (tPercentageOfCompletion <= 0.5) {
-                if (tCallStyle == CALL_STYLE_IN_OUT) {
-                    // In the first half, call with (2 * PercentageOfCompletion) | 0.0 to 1.0. Result = (0.5 * result)
-                    tEaseResult = 0.5 * (callEasingFunction(2.0 * tPercentageOfCompletion));
-                }
-                if (tCallStyle == CALL_STYLE_BOUNCING_OUT_IN) {
-                    // In the first half, call with (1 - (2 * PercentageOfCompletion)) | 1.0 to 0.0. Result = (1 - result) -> call OUT function faster.
-                    tEaseResult = 1.0 - (callEasingFunction(1.0 - (2.0 * tPercentageOfCompletion)));
-                }
-            } else {
-                if (tCallStyle == CALL_STYLE_IN_OUT) {
-                    // In the second half, call with (2 - (2 * PercentageOfCompletion)) | 1.0 to 0.0. Result = ( 1- (0.5 * result))
-                    tEaseResult = 1.0 - (0.5 * (callEasingFunction(2.0 - (2.0 * tPercentageOfCompletion))));
-                }
-                if (tCallStyle == CALL_STYLE_BOUNCING_OUT_IN) {
-                    // In the second half, call with ((2 * PercentageOfCompletion) - 1) | 0.0 to 1.0. Result = (1- result) -> call OUT function faster and backwards.
-                    tEaseResult = 1.0 - (callEasingFunction((2.0 * tPercentageOfCompletion) - 1.0));
-                }
-            }
-        }
-
-        if (tEaseResult >= 2) {
-            tNewMicrosecondsOrUnits = DegreeToMicrosecondsOrUnits(tEaseResult - EASE_FUNCTION_DEGREE_INDICATOR_OFFSET + 0.5);
-        } else {
-            int tDeltaMicroseconds = mDeltaMicrosecondsOrUnits * tEaseResult;
-            tNewMicrosecondsOrUnits = mStartMicrosecondsOrUnits + tDeltaMicroseconds;
-        }
-    }
-
-#  if defined(PRINT_FOR_SERIAL_PLOTTER)
-    // call it always for serial plotter
-    writeMicrosecondsOrUnits(tNewMicrosecondsOrUnits);
-#  else
-    /*
-     * Write new position only if changed
-     */
-    if (tNewMicrosecondsOrUnits != mCurrentMicrosecondsOrUnits) {
-        writeMicrosecondsOrUnits(tNewMicrosecondsOrUnits);
-    }
 #  endif
     return false;
 }
 
-float ServoEasing::callEasingFunction(float aPercentageOfCompletion) {
-    uint_fast8_t tEasingType = mEasingType & EASE_TYPE_MASK;
-
-    switch (tEasingType) {
-
-    case EASE_USER_DIRECT:
-        if (mUserEaseInFunction != NULL) {
-            return mUserEaseInFunction(aPercentageOfCompletion);
-        } else {
-            return 0.0;
+/*
+ * Called by update() for a movement started by writeMicrosecondsOrUnits() if a slew rate limit or an input filter is set.
+ * First the filter is applied to the target, then the filtered value is approached with slew rate limit.
+ * @return true if target was reached
+ */
+bool ServoEasing::updateWriteTarget() {
+    int tTargetMicrosecondsOrUnits = mTargetMicrosecondsOrUnits;
+    bool tTargetReached = true;
+#  if defined(ENABLE_INPUT_FILTER)
+    if (mInputFilterType != INPUT_FILTER_NONE) {
+        tTargetReached = updateInputFilter(&tTargetMicrosecondsOrUnits);
+        if (tTargetMicrosecondsOrUnits == mCurrentMicrosecondsOrUnits && mNumberOfSuppressedWrites != 0xFFFF) {
+            mNumberOfSuppressedWrites++; // filter output did not change, so no write to servo
         }
+    }
+#  endif
 
-    case EASE_QUADRATIC_IN:
-        return QuadraticEaseIn(aPercentageOfCompletion);
-    case EASE_CUBIC_IN:
-        return CubicEaseIn(aPercentageOfCompletion);
-    case EASE_QUARTIC_IN:
-        return QuarticEaseIn(aPercentageOfCompletion);
-#  ifndef KEEP_SERVO_EASING_LIBRARY_SMALL
-    case EASE_SINE_IN:
-        return SineEaseIn(aPercentageOfCompletion);
-    case EASE_CIRCULAR_IN:
-        return CircularEaseIn(aPercentageOfCompletion);
-    case EASE_BACK_IN:
-        return BackEaseIn(aPercentageOfCompletion);
-    case EASE_ELASTIC_IN:
-        return ElasticEaseIn(aPercentageOfCompletion);
-    case EASE_BOUNCE_OUT:
-        return EaseOutBounce(aPercentageOfCompletion);
+#  if defined(ENABLE_SLEW_RATE_LIMITED_WRITE)
+    if (mSlewRateMaxVelocity != 0) {
+        tTargetReached = updateSlewRateLimitedMove(tTargetMicrosecondsOrUnits) && tTargetReached;
+    } else
 #  endif
-    default:
-        return 0.0;
+    if (tTargetMicrosecondsOrUnits != mCurrentMicrosecondsOrUnits) {
+        writeMicrosecondsOrUnitsDirect(tTargetMicrosecondsOrUnits);
     }
-}
 
-#endif //PROVIDE_ONLY_LINEAR_MOVEMENT
+    if (tTargetReached) {
+        mIsTrackingTarget = false;
+        mServoMoves = false;
+    }
+    return tTargetReached;
+}
+#endif // defined(ENABLE_WRITE_TARGET_TRACKING)
 
-bool ServoEasing::isMoving() {
-    return mServoMoves;
+/**
+ * @param aTrimDegrees This trim value is always added to the degree/units/microseconds value requested
+ */
+void ServoEasing::setTrim(int aTrimDegrees, bool aDoWrite) {
+    if (aTrimDegrees >= 0) {
+        setTrimMicrosecondsOrUnits(DegreeToMicrosecondsOrUnits(aTrimDegrees) - mServo0DegreeMicrosecondsOrUnits, aDoWrite);
+    } else {
+        setTrimMicrosecondsOrUnits(-(DegreeToMicrosecondsOrUnits(-aTrimDegrees) - mServo0DegreeMicrosecondsOrUnits), aDoWrite);
+    }
 }
 
-/*
- * Call yield here (actually only for ESP8266), so the user do not need to care for it in long running loops.
- * yield() will only allow higher priority tasks to run.
- * This call is dangerous for ESP32, since the timer is detached AFTER mServoMoves is set to false in handleServoTimerInterrupt(),
- * and one core may check mServoMoves and started a new move with initializing the timer, and then the timer gets detached by handleServoTimerInterrupt()
- * which leads to an error: CORRUPT HEAP: Bad head at ...
+/**
+ * @param aTrimMicrosecondsOrUnits This trim value is always added to the degree/units/microseconds value requested
+ * @note It is only used/added at writeMicrosecondsOrUnitsDirect()
  */
-bool ServoEasing::isMovingAndCallYield() {
-#if defined(ESP8266)
-    yield(); // Not required for ESP32, since our code is running on CPU1 and using yield seems to disturb the I2C interface
+void ServoEasing::setTrimMicrosecondsOrUnits(int aTrimMicrosecondsOrUnits, bool aDoWrite) {
+    mTrimMicrosecondsOrUnits = aTrimMicrosecondsOrUnits;
+    computeConversionFactorsAndOffsets();
+#if defined(ENABLE_MIN_AND_MAX_CONSTRAINTS)
+    computeMinMaxConstraintWithTrimAndReverse();
 #endif
-    return mServoMoves;
+    if (aDoWrite) {
+        writeMicrosecondsOrUnitsDirect(mCurrentMicrosecondsOrUnits);
+    }
 }
 
-int ServoEasing::getCurrentAngle() {
-    return MicrosecondsOrUnitsToDegree(mCurrentMicrosecondsOrUnits);
+#ifndef PROVIDE_ONLY_LINEAR_MOVEMENT
+void ServoEasing::setEasingType(uint_fast8_t aEasingType) {
+    mEasingType = aEasingType;
 }
 
-int ServoEasing::getEndMicrosecondsOrUnits() {
-    return mEndMicrosecondsOrUnits;
+uint_fast8_t ServoEasing::getEasingType() {
+    return (mEasingType);
 }
 
-/*
- * Not used internally
- */
-int ServoEasing::getEndMicrosecondsOrUnitsWithTrim() {
-    return mEndMicrosecondsOrUnits + mTrimMicrosecondsOrUnits;
+void ServoEasing::registerUserEaseInFunction(float (*aUserEaseInFunction)(float aPercentageOfCompletion)) {
+    mUserEaseInFunction = aUserEaseInFunction;
+    mUserEaseInFunctionWithUserData = NULL;
+    mUserEaseInFunctionFixedPoint = NULL;
 }
 
-int ServoEasing::getDeltaMicrosecondsOrUnits() {
-    return mDeltaMicrosecondsOrUnits;
+/**
+ * Register a user function, which gets the servo and a user data pointer as additional parameters.
+ * The servo gives access to e.g. getMillisForCompleteMove() or getEndMicrosecondsOrUnits(),
+ * the user data allows to keep state for the move without global variables.
+ * @param aUserDataPointer passed to each call of aUserEaseInFunction, may be NULL.
+ */
+void ServoEasing::registerUserEaseInFunctionWithUserData(
+        float (*aUserEaseInFunction)(float aPercentageOfCompletion, ServoEasing * aServoEasing, void * aUserDataPointer),
+        void * aUserDataPointer) {
+    mUserEaseInFunction = NULL;
+    mUserEaseInFunctionWithUserData = aUserEaseInFunction;
+    mUserEaseInFunctionFixedPoint = NULL;
+    mUserDataPointer = aUserDataPointer;
 }
 
-int ServoEasing::getMillisForCompleteMove() {
-    return mMillisForCompleteMove;
+/**
+ * Register a user function using fixed point numbers instead of float. EASE_FIXED_POINT_ONE (0x4000) corresponds to 1.0.
+ * The call styles (IN, OUT, IN_OUT, BOUNCING) are then also computed with integer arithmetic.
+ * Returning degree values is not supported for this function.
+ * @param aUserDataPointer passed to each call of aUserEaseInFunction together with the servo, may be NULL.
+ */
+void ServoEasing::registerUserEaseInFunctionFixedPoint(
+        int16_t (*aUserEaseInFunction)(int16_t aPercentageOfCompletionFixedPoint, ServoEasing * aServoEasing, void * aUserDataPointer),
+        void * aUserDataPointer) {
+    mUserEaseInFunction = NULL;
+    mUserEaseInFunctionWithUserData = NULL;
+    mUserEaseInFunctionFixedPoint = aUserEaseInFunction;
+    mUserDataPointer = aUserDataPointer;
 }
 
-void ServoEasing::print(Print * aSerial, bool doExtendedOutput) {
-    printDynamic(aSerial, doExtendedOutput);
-    printStatic(aSerial);
+void * ServoEasing::getUserDataPointer() {
+    return mUserDataPointer;
 }
+#endif
 
-/*
- * Prints values which may change from move to move.
- */
-void ServoEasing::printDynamic(Print * aSerial, bool doExtendedOutput) {
-// pin is static but it is required for identifying the servo
-    aSerial->print(mServoIndex);
-    aSerial->print('/');
-    aSerial->print(mServoPin);
-    aSerial->print(F(": "));
-
-    aSerial->print(MicrosecondsOrUnitsToDegree(mCurrentMicrosecondsOrUnits));
-    if (doExtendedOutput) {
-        aSerial->print('|');
-        aSerial->print(mCurrentMicrosecondsOrUnits);
+void ServoEasing::write(int aValue) {
+#if defined(TRACE)
+    Serial.print(F("write "));
+    Serial.print(aValue);
+    Serial.print(' ');
+#endif
+    /*
+     * Check for valid initialization of servo.
+     */
+    if (mServoIndex == INVALID_SERVO) {
+#if defined(TRACE)
+        Serial.print(F("Error: detached servo"));
+#endif
+        return;
     }
-
-    aSerial->print(F(" -> "));
-    aSerial->print(MicrosecondsOrUnitsToDegree(mEndMicrosecondsOrUnits));
-    if (doExtendedOutput) {
-        aSerial->print('|');
-        aSerial->print(mEndMicrosecondsOrUnits);
+    if (aValue < 400) { // treat values less than 400 as angles in degrees (valid values in microseconds are handled as microseconds)
+        SERVO_ENGINE(this)->mServoNextPositionArray[mServoIndex] = aValue;
+        aValue = DegreeToMicrosecondsOrUnits(aValue);
     }
+    writeMicrosecondsOrUnits(aValue);
+}
 
-    aSerial->print(F(" = "));
-    int tDelta;
-    if (mDeltaMicrosecondsOrUnits >= 0) {
-        tDelta = MicrosecondsOrUnitsToDegree(mDeltaMicrosecondsOrUnits + mServo0DegreeMicrosecondsOrUnits);
-    } else {
-        tDelta = -MicrosecondsOrUnitsToDegree(mServo0DegreeMicrosecondsOrUnits - mDeltaMicrosecondsOrUnits);
+/**
+ * Write value direct to servo, or if a slew rate limit or an input filter is set,
+ * use value as new target, which is processed by update().
+ */
+void ServoEasing::writeMicrosecondsOrUnits(int aValue) {
+#if defined(ENABLE_WRITE_TARGET_TRACKING)
+    if (isWriteTargetTracked() && mServoIndex != INVALID_SERVO) {
+        mTargetMicrosecondsOrUnits = aValue;
+        if (!mServoMoves || !mIsTrackingTarget) {
+            // Start processing of target from current position with velocity 0
+#  if defined(ENABLE_SLEW_RATE_LIMITED_WRITE)
+            mTrackingPositionShift8 = (int32_t) mCurrentMicrosecondsOrUnits << 8;
+            mTrackingVelocity = 0;
+            mMillisAtStartMove = SERVO_ENGINE(this)->getMillis(); // used as timestamp of last update here
+#  endif
+#  if defined(ENABLE_INPUT_FILTER)
+            mInputFilterStateShift8 = (int32_t) mCurrentMicrosecondsOrUnits << 8;
+            mInputFilterDerivative = 0;
+            mInputFilterLastInput = mCurrentMicrosecondsOrUnits;
+#  endif
+            mIsTrackingTarget = true;
+            mServoMoves = true;
+            SERVO_ENGINE(this)->setServoUpdateMaskBit(mServoIndex);
+            SERVO_ENGINE(this)->startUpdateByInterrupt(true);
+        }
+        return;
     }
-    aSerial->print(tDelta);
-    if (doExtendedOutput) {
-        aSerial->print('|');
-        aSerial->print(mDeltaMicrosecondsOrUnits);
+#endif
+    writeMicrosecondsOrUnitsDirect(aValue);
+#if defined(ENABLE_SERVO_DRIVER_INTERFACE)
+    if (mDriver != NULL && mDriver->flush != NULL) {
+        mDriver->flush();
     }
+#endif
+}
 
-    aSerial->print(F(" in "));
-    aSerial->print(mMillisForCompleteMove);
-    aSerial->print(F(" ms"));
+/**
+ * Internal write function, called by update() and by writeMicrosecondsOrUnits().
+ * Before sending the value to the underlying Servo library, trim and reverse is applied
+ */
+void ServoEasing::writeMicrosecondsOrUnitsDirect(int aValue) {
+    /*
+     * Check for valid initialization of servo.
+     */
+    if (mServoIndex == INVALID_SERVO) {
+#if defined(TRACE)
+        Serial.print(F("Error: detached servo"));
+#endif
+        return;
+    }
 
-    aSerial->print(F(" with speed="));
-    aSerial->print(mSpeed);
+    mCurrentMicrosecondsOrUnits = aValue;
 
-    if (doExtendedOutput) {
-        aSerial->print(F(" mMillisAtStartMove="));
-        aSerial->print(mMillisAtStartMove);
+#if defined(ENABLE_IDLE_POWER_OFF)
+    if (mIsPoweredOff) {
+        reengage();
     }
+    mMillisAtLastActivity = SERVO_ENGINE(this)->getMillis();
+    if (mIdlePowerOffMillis != 0) {
+        armIdlePowerOff();
+    }
+#endif
 
-    aSerial->println();
-}
+#if defined(TRACE)
+    Serial.print(mServoIndex);
+    Serial.print('/');
+    Serial.print(mServoPin);
+    Serial.print(F(" us/u="));
+    Serial.print(aValue);
+    if (mTrimMicrosecondsOrUnits != 0) {
+        Serial.print(" t=");
+        Serial.print(aValue + mTrimMicrosecondsOrUnits);
+    }
+#endif // TRACE
 
 /*
- * Prints values which normally does NOT change from move to move.
- * call with
+ * Apply trim and reverse - this is the only place trim and reverse are evaluated
+ * (except in the DegreeToMicrosecondsOrUnitsWithTrimAndReverse() function for external testing purposes)
+ * Reverse: aValue = mServo180DegreeMicrosecondsOrUnits - ((aValue + mTrimMicrosecondsOrUnits) - mServo0DegreeMicrosecondsOrUnits)
+ * which is combined with the trim to one offset by computeConversionFactorsAndOffsets().
  */
-void ServoEasing::printStatic(Print * aSerial) {
-
-    aSerial->print(F("0="));
-    aSerial->print(mServo0DegreeMicrosecondsOrUnits);
-    aSerial->print(F(" 180="));
-    aSerial->print(mServo180DegreeMicrosecondsOrUnits);
-
-    aSerial->print(F(" trim="));
-    if (mTrimMicrosecondsOrUnits >= 0) {
-        aSerial->print(MicrosecondsOrUnitsToDegree(mTrimMicrosecondsOrUnits + mServo0DegreeMicrosecondsOrUnits));
+    if (mOperateServoReverse) {
+        aValue = mTrimAndReverseOffsetMicrosecondsOrUnits - aValue;
+#if defined(TRACE)
+        Serial.print(F(" r="));
+        Serial.print(aValue);
+#endif
     } else {
-        aSerial->print(-MicrosecondsOrUnitsToDegree(mServo0DegreeMicrosecondsOrUnits - mTrimMicrosecondsOrUnits));
+        aValue += mTrimAndReverseOffsetMicrosecondsOrUnits;
     }
-    aSerial->print('|');
-    aSerial->print(mTrimMicrosecondsOrUnits);
 
-    aSerial->print(F(" reverse="));
-    aSerial->print(mOperateServoReverse);
+#if defined(ENABLE_MIN_AND_MAX_CONSTRAINTS)
+    // Clamp the value, which is really written to the servo. Limits are already adjusted for trim and reverse.
+    if (aValue < mMinMicrosecondsOrUnitsWithTrimAndReverse) {
+        aValue = mMinMicrosecondsOrUnitsWithTrimAndReverse;
+        if (mNumberOfClampedWrites != 0xFFFF) {
+            mNumberOfClampedWrites++;
+        }
+    } else if (aValue > mMaxMicrosecondsOrUnitsWithTrimAndReverse) {
+        aValue = mMaxMicrosecondsOrUnitsWithTrimAndReverse;
+        if (mNumberOfClampedWrites != 0xFFFF) {
+            mNumberOfClampedWrites++;
+        }
+    }
+#endif
 
-#ifndef PROVIDE_ONLY_LINEAR_MOVEMENT
-    aSerial->print(F(" easingType=0x"));
-    aSerial->print(mEasingType, HEX);
+#if defined(PRINT_FOR_SERIAL_PLOTTER)
+    Serial.print(' ');
+    Serial.print(aValue);
 #endif
 
-#if defined(USE_PCA9685_SERVO_EXPANDER)
-    aSerial->print(F(" PCA9685I2CAddress=0x"));
-    aSerial->print(mPCA9685I2CAddress, HEX);
-    aSerial->print(F(" &Wire=0x"));
+#if defined(USE_PCA9685_SERVO_EXPANDER) && defined(TRACE)
+    Serial.print(F(" s="));
+    Serial.print(mServoPin * (4096 - (DEFAULT_PCA9685_UNITS_FOR_180_DEGREE + 100)) / 15); // mServoPin * 233
+#endif
+    ServoEasingDriver::write(this, aValue);
 
-//    aSerial->print((uintptr_t) mI2CClass, HEX); // defined since C++11
-    aSerial->print((uint_fast16_t) mI2CClass, HEX);
+#if defined(TRACE)
+    Serial.println();
+#endif
+}
 
-#  if defined(USE_SERVO_LIB)
-    aSerial->print(F(" at expander="));
-    aSerial->print(mServoIsConnectedToExpander);
-#  endif
+int ServoEasing::MicrosecondsOrUnitsToDegree(int aMicrosecondsOrUnits) {
+#if defined(ENABLE_CALIBRATION_TABLE)
+    ServoEasingCalibrationTable * tTable = mCalibrationTable;
+    if (tTable != NULL) {
+        /*
+         * Values at the points are monotonic, so search the segment, which contains the value.
+         * Values outside the table are extrapolated by the first or last segment.
+         */
+        uint_fast8_t tSegment = 0;
+        bool tIsIncreasing = tTable->MicrosecondsOrUnitsAtPoint[tTable->NumberOfSegments] > tTable->MicrosecondsOrUnitsAtPoint[0];
+        while (tSegment < (uint_fast8_t) (tTable->NumberOfSegments - 1)) {
+            int tValueAtSegmentEnd = tTable->MicrosecondsOrUnitsAtPoint[tSegment + 1];
+            if ((tIsIncreasing && aMicrosecondsOrUnits <= tValueAtSegmentEnd)
+                    || (!tIsIncreasing && aMicrosecondsOrUnits >= tValueAtSegmentEnd)) {
+                break;
+            }
+            tSegment++;
+        }
+        return (tTable->InverseOffsetShift16[tSegment] + (int32_t) aMicrosecondsOrUnits * tTable->InverseSlopeShift16[tSegment]
+                + 0x8000) >> 16;
+    }
 #endif
+    /*
+     * Formula for microseconds:
+     * (aMicrosecondsOrUnits - mServo0DegreeMicrosecondsOrUnits) * (180 / 1856) // 1856 = 180 - 0 degree micros
+     * Formula for PCA9685 units
+     * (aMicrosecondsOrUnits - mServo0DegreeMicrosecondsOrUnits) * (180 / 380) // 380 = 180 - 0 degree units
+     * Formula for both without rounding
+     * map(aMicrosecondsOrUnits, mServo0DegreeMicrosecondsOrUnits, mServo180DegreeMicrosecondsOrUnits, 0, 180)
+     */
 
-    aSerial->print(F(" MAX_EASING_SERVOS="));
-    aSerial->print(MAX_EASING_SERVOS);
+// map with rounding, but with the factor computed by computeConversionFactorsAndOffsets() instead of a division
+    int32_t tResult = (int32_t) (aMicrosecondsOrUnits - mServo0DegreeMicrosecondsOrUnits) * mMicrosecondsOrUnitsToDegreeFactorShift16;
+    return (tResult + 0x8000) >> 16;
+}
 
-    aSerial->print(F(" this=0x"));
-    aSerial->println((uint_fast16_t) this, HEX);
+/**
+ * We have around 10 us per degree
+ */
+int ServoEasing::DegreeToMicrosecondsOrUnits(int aDegree) {
+#if defined(ENABLE_CALIBRATION_TABLE)
+    ServoEasingCalibrationTable * tTable = mCalibrationTable;
+    if (tTable != NULL) {
+        // No division here: segment index by multiplication with reciprocal, then offset + slope of segment
+        int_fast8_t tSegment = 0;
+        if (aDegree > 0) {
+            tSegment = ((uint32_t) aDegree * tTable->DegreeToSegmentFactorShift16) >> 16;
+            if (tSegment >= tTable->NumberOfSegments) {
+                tSegment = tTable->NumberOfSegments - 1;
+            }
+        }
+        return tTable->OffsetMicrosecondsOrUnits[tSegment] + (((int32_t) aDegree * tTable->SlopeShift8[tSegment]) >> 8);
+    }
+#endif
+// For microseconds and PCA9685 units. Same as map(aDegree, 0, 180, mServo0DegreeMicrosecondsOrUnits, mServo180DegreeMicrosecondsOrUnits) but with rounding.
+    return mServo0DegreeMicrosecondsOrUnits + ((((int32_t) aDegree * mDegreeToMicrosecondsOrUnitsFactorShift8) + 0x80) >> 8);
 }
 
 /*
- * Clips the unsigned degree value and handles unsigned underflow.
- * returns 0 if aDegreeToClip >= 218
- * returns 180 if 180 <= aDegreeToClip < 218
+ * Compute the factors for the conversion between degree and microseconds or units and the combined trim and reverse offset.
+ * Must be called after each change of mServo0DegreeMicrosecondsOrUnits, mServo180DegreeMicrosecondsOrUnits,
+ * mTrimMicrosecondsOrUnits or mOperateServoReverse.
  */
-int clipDegreeSpecial(uint_fast8_t aDegreeToClip) {
-    if (aDegreeToClip) {
-        return aDegreeToClip;
+void ServoEasing::computeConversionFactorsAndOffsets() {
+    int32_t tDeltaMicrosecondsOrUnits = mServo180DegreeMicrosecondsOrUnits - mServo0DegreeMicrosecondsOrUnits;
+    if (tDeltaMicrosecondsOrUnits == 0) {
+        tDeltaMicrosecondsOrUnits = 1; // avoid division by zero for invalid attach() parameters
     }
-    if (aDegreeToClip < 218) {
-        return 180;
+    // Rounding by adding half of the divisor. The sign of the delta is taken into account.
+    mDegreeToMicrosecondsOrUnitsFactorShift8 = ((tDeltaMicrosecondsOrUnits * 256) + (tDeltaMicrosecondsOrUnits > 0 ? 90 : -90)) / 180;
+    int32_t tHalfDelta = tDeltaMicrosecondsOrUnits / 2;
+    mMicrosecondsOrUnitsToDegreeFactorShift16 = ((180L * 65536L) + (tDeltaMicrosecondsOrUnits > 0 ? tHalfDelta : -tHalfDelta))
+            / tDeltaMicrosecondsOrUnits;
+
+    if (mOperateServoReverse) {
+        mTrimAndReverseOffsetMicrosecondsOrUnits = mServo180DegreeMicrosecondsOrUnits + mServo0DegreeMicrosecondsOrUnits
+                - mTrimMicrosecondsOrUnits;
+    } else {
+        mTrimAndReverseOffsetMicrosecondsOrUnits = mTrimMicrosecondsOrUnits;
     }
-    return 0;
 }
 
-/*
- * The recommended test if at least one servo is moving yet.
+#if defined(ENABLE_CALIBRATION_TABLE)
+/**
+ * Use a piecewise linear mapping between degree and microseconds instead of the linear one given by attach().
+ * The table is computed here once, so the conversions need no division. Must be called after attach().
+ * @param aCalibrationTable Storage for the computed table. Must be valid as long as it is used by this servo.
+ * @param aMicrosecondsArray Microseconds for equidistant degree values from 0 to 180 degree,
+ *        e.g. 9 values for 0, 22.5, 45, ... 180 degree. Values must be increasing or decreasing.
+ * @param aNumberOfPoints 2 to CALIBRATION_TABLE_MAX_POINTS
+ * @return false if parameters are invalid
  */
-bool areInterruptsActive() {
-#if defined(ESP8266)
-    yield(); // required for ESP8266
+bool ServoEasing::setCalibrationTable(ServoEasingCalibrationTable * aCalibrationTable, const int * aMicrosecondsArray,
+        uint8_t aNumberOfPoints) {
+    if (aNumberOfPoints < 2 || aNumberOfPoints > CALIBRATION_TABLE_MAX_POINTS) {
+        return false;
+    }
+    uint8_t tNumberOfSegments = aNumberOfPoints - 1;
+    aCalibrationTable->NumberOfSegments = tNumberOfSegments;
+    aCalibrationTable->DegreeToSegmentFactorShift16 = ((uint32_t) tNumberOfSegments << 16) / 180;
+
+    for (uint_fast8_t i = 0; i < aNumberOfPoints; ++i) {
+        aCalibrationTable->MicrosecondsOrUnitsAtPoint[i] = ServoEasingDriver::toMicrosecondsOrUnits(this, aMicrosecondsArray[i]);
+    }
+
+    for (uint_fast8_t i = 0; i < tNumberOfSegments; ++i) {
+        int32_t tValueAtStart = aCalibrationTable->MicrosecondsOrUnitsAtPoint[i];
+        int32_t tDeltaValue = aCalibrationTable->MicrosecondsOrUnitsAtPoint[i + 1] - tValueAtStart;
+        if (tDeltaValue == 0) {
+            return false; // not monotonic
+        }
+        // Degree at start of segment is (i * 180) / tNumberOfSegments, the width of a segment is 180 / tNumberOfSegments
+        int32_t tSlopeShift8 = (tDeltaValue * 256 * tNumberOfSegments) / 180;
+        aCalibrationTable->SlopeShift8[i] = tSlopeShift8;
+        aCalibrationTable->OffsetMicrosecondsOrUnits[i] = tValueAtStart - ((int32_t) i * 180 * tSlopeShift8) / (256L * tNumberOfSegments);
+
+        int32_t tInverseSlopeShift16 = (180L * 65536L) / (tDeltaValue * tNumberOfSegments);
+        aCalibrationTable->InverseSlopeShift16[i] = tInverseSlopeShift16;
+        aCalibrationTable->InverseOffsetShift16[i] = (((int32_t) i * 180 * 65536L) / tNumberOfSegments)
+                - tValueAtStart * tInverseSlopeShift16;
+    }
+
+    mCalibrationTable = aCalibrationTable;
+    // Keep the 0 and 180 degree values consistent for reverse and all other computations
+    mServo0DegreeMicrosecondsOrUnits = aCalibrationTable->MicrosecondsOrUnitsAtPoint[0];
+    mServo180DegreeMicrosecondsOrUnits = aCalibrationTable->MicrosecondsOrUnitsAtPoint[tNumberOfSegments];
+    computeConversionFactorsAndOffsets();
+#if defined(ENABLE_MIN_AND_MAX_CONSTRAINTS)
+    computeMinMaxConstraintWithTrimAndReverse();
 #endif
-    return sInterruptsAreActive;
+    return true;
 }
 
 /*
- * Update all servos from list and check if all servos have stopped.
- * Defined weak in order to be able to overwrite it.
+ * Back to linear mapping between the 0 and 180 degree values of the table
  */
-#if defined(STM32F1xx) && STM32_CORE_VERSION_MAJOR == 1 &&  STM32_CORE_VERSION_MINOR <= 8 // for "Generic STM32F1 series" from STM32 Boards from STM32 cores of Arduino Board manager
-__attribute__((weak)) void handleServoTimerInterrupt(HardwareTimer * aDummy __attribute__((unused))) // changed in stm32duino 1.9 - 5/2020
-#else
-__attribute__((weak)) void handleServoTimerInterrupt()
-#endif
-{
-#if defined(USE_PCA9685_SERVO_EXPANDER)
-// Otherwise it will hang forever in I2C transfer
-    interrupts();
-#endif
-    if (updateAllServos()) {
-        // disable interrupt only if all servos stopped. This enables independent movements of servos with this interrupt handler.
-        disableServoEasingInterrupt();
-    }
+void ServoEasing::removeCalibrationTable() {
+    mCalibrationTable = NULL;
 }
+#endif // defined(ENABLE_CALIBRATION_TABLE)
 
-/*
- * Timer1 is used for the Arduino Servo library.
- * To have non blocking easing functions its unused channel B is used to generate an interrupt 100 us before the end of the 20 ms Arduino Servo refresh period.
- * This interrupt then updates all servo values for the next refresh period.
- * First interrupt is triggered not directly, but after 20 ms, since we are often called here at the time of the last interrupt of the preceding servo move.
+/**
+ * Mainly for testing, since trim and reverse are applied at each write.
  */
-void enableServoEasingInterrupt() {
-#if defined(__AVR__)
-#  if defined(__AVR_ATmega1280__) || defined(__AVR_ATmega2560__)
-#    if defined(USE_PCA9685_SERVO_EXPANDER) && ! defined(USE_SERVO_LIB)
-// set timer 5 to 20 ms, since the servo library does not do this for us
-    TCCR5A = _BV(WGM11);// FastPWM Mode mode TOP (20 ms) determined by ICR1 - non-inverting Compare Output mode OC1A+OC1B
-    TCCR5B = _BV(WGM13) | _BV(WGM12) | _BV(CS11);// set prescaler to 8, FastPWM mode mode bits WGM13 + WGM12
-    ICR5 = (F_CPU / 8) / REFRESH_FREQUENCY; // 40000 - set period to 50 Hz / 20 ms
-#    endif
-
-    TIFR5 |= _BV(OCF5B);     // clear any pending interrupts;
-    TIMSK5 |= _BV(OCIE5B);// enable the output compare B interrupt
-    OCR5B = ((clockCyclesPerMicrosecond() * REFRESH_INTERVAL_MICROS) / 8) - 100;// update values 100 us before the new servo period starts
+int ServoEasing::DegreeToMicrosecondsOrUnitsWithTrimAndReverse(int aDegree) {
+// For microseconds and PCA9685 units:
+    int tResultValue = DegreeToMicrosecondsOrUnits(aDegree);
+    if (mOperateServoReverse) {
+        return mTrimAndReverseOffsetMicrosecondsOrUnits - tResultValue;
+    }
+    return tResultValue + mTrimAndReverseOffsetMicrosecondsOrUnits;
+}
 
-#  elif defined(__AVR_ATmega4809__) // Uno WiFi Rev 2, Nano Every
-    // TCB1 is used by Tone()
-    // TCB2 is used by Servo, but we cannot hijack the ISR, so we must use a dedicated timer for the 20 ms interrupt
-    // TCB3 is used by millis()
-    // Must use TCA0, since TCBx have only prescaler %2. Use single mode, because it seems to be easier :-)
-    TCA0.SINGLE.CTRLB = TCA_SINGLE_WGMODE_NORMAL_gc; // Frequency mode, top = PER
-    TCA0.SINGLE.PER = (((F_CPU / 1000000) * REFRESH_INTERVAL_MICROS) / 8); // (F_CPU / 1000000) = clockCyclesPerMicrosecond()
-//    TCA0.SINGLE.PER = ((clockCyclesPerMicrosecond() * REFRESH_INTERVAL_MICROS) / 8); // clockCyclesPerMicrosecond() is no macro here!
-    TCA0.SINGLE.INTCTRL = TCA_SINGLE_OVF_bm; // Overflow interrupt
-    TCA0.SINGLE.CTRLA = TCA_SINGLE_CLKSEL_DIV8_gc | TCA_SINGLE_ENABLE_bm; // set prescaler to 8
+void ServoEasing::easeTo(int aDegree) {
+    easeTo(aDegree, mSpeed);
+}
 
-#  else // defined(__AVR_ATmega1280__) || defined(__AVR_ATmega2560__)
-    /*
-     * Standard AVR use timer 1
-     */
-#    if defined(USE_PCA9685_SERVO_EXPANDER) && ! defined(USE_SERVO_LIB)
-//    // set timer 1 to 20 ms, since the servo library does not do this for us
-    TCCR1A = _BV(WGM11);     // FastPWM Mode mode TOP (20 ms) determined by ICR1 - non-inverting Compare Output mode OC1A+OC1B
-    TCCR1B = _BV(WGM13) | _BV(WGM12) | _BV(CS11);     // set prescaler to 8, FastPWM mode mode bits WGM13 + WGM12
-    ICR1 = (F_CPU / 8) / REFRESH_FREQUENCY; // 40000 - set period to 50 Hz / 20 ms
-#    endif
+/**
+ * Blocking move without interrupt
+ * @param aDegreesPerSecond Can range from 1 to the physically maximum value of 450
+ */
+void ServoEasing::easeTo(int aDegree, uint_fast16_t aDegreesPerSecond) {
+    startEaseTo(aDegree, aDegreesPerSecond, false);
+    do {
+        // First do the delay, then check for update, since we are likely called directly after start and there is nothing to move yet
+        delay(REFRESH_INTERVAL_MILLIS); // 20 ms
+#if defined(PRINT_FOR_SERIAL_PLOTTER)
+    } while (!updateAllServos());
+#else
+    } while (!update());
+#endif
+}
 
-    TIFR1 |= _BV(OCF1B);    // clear any pending interrupts;
-    TIMSK1 |= _BV(OCIE1B);    // enable the output compare B interrupt
+void ServoEasing::easeToD(int aDegree, uint_fast16_t aMillisForMove) {
+    startEaseToD(aDegree, aMillisForMove, false);
+    do {
+        delay(REFRESH_INTERVAL_MILLIS); // 20 ms
+#if defined(PRINT_FOR_SERIAL_PLOTTER)
+    } while (!updateAllServos());
+#else
+    } while (!update());
+#endif
+}
+
+bool ServoEasing::setEaseTo(int aDegree) {
+    return startEaseTo(aDegree, mSpeed, false);
+}
+
+/**
+ * Sets easing parameter, but does not start interrupt
+ * @return false if servo was still moving
+ */
+bool ServoEasing::setEaseTo(int aDegree, uint_fast16_t aDegreesPerSecond) {
+    return startEaseTo(aDegree, aDegreesPerSecond, false);
+}
+
+/**
+ * Starts interrupt for update()
+ */
+bool ServoEasing::startEaseTo(int aDegree) {
+    return startEaseTo(aDegree, mSpeed, true);
+}
+
+/**
+ * Sets up all the values required for a smooth move to new value
+ * returns false if servo was still moving
+ */
+bool ServoEasing::startEaseTo(int aDegree, uint_fast16_t aDegreesPerSecond, bool aStartUpdateByInterrupt) {
+    int tCurrentAngle = MicrosecondsOrUnitsToDegree(mCurrentMicrosecondsOrUnits);
+    if (aDegree == tCurrentAngle) {
+        // no effective movement -> return
+        return !mServoMoves;
+    }
+    if (aDegreesPerSecond == 0) {
+#if defined(DEBUG)
+        Serial.println(F("Speed is 0 -> set to 1"));
+#endif
+        aDegreesPerSecond = 1;
+    }
+    uint_fast16_t tMillisForCompleteMove = abs(aDegree - tCurrentAngle) * 1000L / aDegreesPerSecond;
+
+#ifndef PROVIDE_ONLY_LINEAR_MOVEMENT
+    if ((mEasingType & CALL_STYLE_MASK) == CALL_STYLE_BOUNCING_OUT_IN) {
+        // bouncing has double movement, so take double time
+        tMillisForCompleteMove *= 2;
+    }
+#endif
+    return startEaseToD(aDegree, tMillisForCompleteMove, aStartUpdateByInterrupt);
+}
+
+/**
+ * Lower level function with time instead of speed parameter
+ * Sets easing parameter, but does not start
+ */
+bool ServoEasing::setEaseToD(int aDegree, uint_fast16_t aMillisForMove) {
+    return startEaseToD(aDegree, aMillisForMove, false);
+}
+
+/**
+ * Lower level function with time instead of speed parameter
+ * @return false if servo was still moving
+ */
+bool ServoEasing::startEaseToD(int aDegree, uint_fast16_t aMillisForMove, bool aStartUpdateByInterrupt) {
     /*
-     * Misuse the Input Capture Noise Canceler Bit as a flag, that signals that interrupts are enabled again.
-     * It is required if disableServoEasingInterrupt() is suppressed e.g. by an overwritten handleServoTimerInterrupt() function
-     * because the servo interrupt is used to synchronize e.g. NeoPixel updates.
+     * Check for valid initialization of servo.
      */
-    TCCR1B |= _BV(ICNC1);
-#    ifndef USE_LEIGHTWEIGHT_SERVO_LIB
-// update values 100 us before the new servo period starts
-    OCR1B = ((clockCyclesPerMicrosecond() * REFRESH_INTERVAL_MICROS) / 8) - 100;
-#    endif
-#  endif
+    if (mServoIndex == INVALID_SERVO) {
+#if defined(TRACE)
+        Serial.print(F("Error: detached servo"));
+#endif
+        return true;
+    }
+#if defined(ENABLE_WRITE_TARGET_TRACKING)
+    mIsTrackingTarget = false; // an easing move terminates a slew rate limited or filtered move
+#endif
+#if defined(ENABLE_VELOCITY_MODE)
+    mIsVelocityMove = false;
+#endif
+// write the position also to mServoNextPositionArray of the engine
+    SERVO_ENGINE(this)->mServoNextPositionArray[mServoIndex] = aDegree;
+    mEndMicrosecondsOrUnits = DegreeToMicrosecondsOrUnits(aDegree);
+    int tCurrentMicrosecondsOrUnits = mCurrentMicrosecondsOrUnits;
+    mDeltaMicrosecondsOrUnits = mEndMicrosecondsOrUnits - tCurrentMicrosecondsOrUnits;
 
-#elif defined(ESP8266) || defined(ESP32)
-    if(sInterruptsAreActive) {
-        Timer20ms.detach(); // otherwise the ESP32 kernel at least will crash and reboot
+    mMillisForCompleteMove = aMillisForMove;
+    mStartMicrosecondsOrUnits = tCurrentMicrosecondsOrUnits;
+
+#ifndef PROVIDE_ONLY_LINEAR_MOVEMENT
+    if ((mEasingType & CALL_STYLE_MASK) == CALL_STYLE_BOUNCING_OUT_IN) {
+        // bouncing has same end position as start position
+        mEndMicrosecondsOrUnits = tCurrentMicrosecondsOrUnits;
     }
-    // It seems that the callback is called by a task not an ISR, which allow us to have the callback without the IRAM attribute
-    Timer20ms.attach_ms(REFRESH_INTERVAL_MILLIS, handleServoTimerInterrupt);
+#endif
 
-// BluePill in 2 flavors
-#elif defined(STM32F1xx)   // for "STM32:stm32" from STM32 Boards from STM32 cores of Arduino Board manager
-    Timer20ms.setMode(LL_TIM_CHANNEL_CH1, TIMER_OUTPUT_COMPARE, NC); // used for generating only interrupts, no pin specified
-    Timer20ms.setOverflow(REFRESH_INTERVAL_MICROS, MICROSEC_FORMAT);// microsecond period
-    Timer20ms.attachInterrupt(handleServoTimerInterrupt);// this sets update interrupt enable
-    Timer20ms.resume();// Start or resume HardwareTimer: all channels are resumed, interrupts are enabled if necessary
+    mMillisAtStartMove = SERVO_ENGINE(this)->getMillis();
 
-#elif defined(__STM32F1__) // for "stm32duino:STM32F1 Generic STM32F103C series" from STM32F1 Boards (Roger Clark STM32duino.com)
-    Timer20ms.setMode(TIMER_CH1, TIMER_OUTPUT_COMPARE);
-    Timer20ms.setPeriod(REFRESH_INTERVAL_MICROS); // 20000 microsecond period
-    Timer20ms.attachInterrupt(TIMER_CH1, handleServoTimerInterrupt);
-    Timer20ms.refresh();// Set the timer's count to 0 and update the prescaler and overflow values.
+#if defined(TRACE)
+    printDynamic(&Serial, true);
+#elif defined(DEBUG)
+    printDynamic(&Serial);
+#endif
 
-#elif defined(__SAM3X8E__)  // Arduino DUE
-    pmc_set_writeprotect(false);
-    pmc_enable_periph_clk(ID_TC_FOR_20_MS_TIMER);
-    NVIC_ClearPendingIRQ(IRQn_FOR_20_MS_TIMER);
-    NVIC_EnableIRQ(IRQn_FOR_20_MS_TIMER);
+    bool tReturnValue = !mServoMoves;
 
-    // TIMER_CLOCK3 is MCK/32. MCK is 84MHz Set up the Timer in waveform mode which creates a PWM in UP mode with automatic trigger on RC Compare
-    TC_Configure(TC_FOR_20_MS_TIMER, CHANNEL_FOR_20_MS_TIMER, TC_CMR_TCCLKS_TIMER_CLOCK3 | TC_CMR_WAVE | TC_CMR_WAVSEL_UP_RC);
-    TC_SetRC(TC_FOR_20_MS_TIMER, CHANNEL_FOR_20_MS_TIMER, (F_CPU / 32) / REFRESH_FREQUENCY); // =52500 -> 20ms
+// Check after printDynamic() to see the values
+    if (mDeltaMicrosecondsOrUnits != 0) {
+        mServoMoves = true;
+        SERVO_ENGINE(this)->setServoUpdateMaskBit(mServoIndex);
+        if (aStartUpdateByInterrupt) {
+            SERVO_ENGINE(this)->startUpdateByInterrupt();
+        }
+    }
+    return tReturnValue;
+}
 
-    TC_Start(TC_FOR_20_MS_TIMER, CHANNEL_FOR_20_MS_TIMER); // Enables the timer clock stopped by TC_Configure() and performs a software reset to start the counting
+void ServoEasing::stop() {
+    mServoMoves = false;
+#if defined(ENABLE_WRITE_TARGET_TRACKING)
+    mIsTrackingTarget = false; // continueWithInterrupts() must not resume an old target
+#endif
+#if defined(ENABLE_VELOCITY_MODE)
+    mIsVelocityMove = false; // continueWithInterrupts() must not resume an old velocity
+#endif
+    ServoEasingEngine * tEngine = SERVO_ENGINE(this);
+#if defined(ENABLE_IDLE_POWER_OFF)
+    // The timer is still required for a pending power off, e.g. of this servo, which is idle from now on
+    if (tEngine->mIdlePowerOffIsPending || (mIdlePowerOffMillis != 0 && !mIsPoweredOff)) {
+        return;
+    }
+#endif
+    // Only the default engine uses the ServoEasing timer, other engines must not stop it
+    if (tEngine->isDefaultEngine() && !tEngine->isOneServoMoving()) {
+        // disable interrupt only if all servos stopped. This enables independent movements of servos with one interrupt handler.
+        disableServoEasingInterrupt();
+    }
+}
 
-    // Enable the RC Compare Interrupt
-    TC_FOR_20_MS_TIMER->TC_CHANNEL[CHANNEL_FOR_20_MS_TIMER].TC_IER = TC_IER_CPCS;
-    // Disable all others
-    TC_FOR_20_MS_TIMER->TC_CHANNEL[CHANNEL_FOR_20_MS_TIMER].TC_IDR = ~TC_IER_CPCS;
+void ServoEasing::continueWithInterrupts() {
+    mServoMoves = true;
+    SERVO_ENGINE(this)->setServoUpdateMaskBit(mServoIndex);
+    SERVO_ENGINE(this)->startUpdateByInterrupt();
+}
 
-#elif defined(ARDUINO_ARCH_SAMD)
-    // Servo uses timer 4 and we use timer 5. therefore we cannot change clock source to 32 kHz.
-    // Enable GCLK for TCC2 and TC5 (timer counter input clock)
-    GCLK->CLKCTRL.reg = (uint16_t) (GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN_GCLK0 | GCLK_CLKCTRL_ID(GCM_TC4_TC5)); // GCLK1=32kHz,  GCLK0=48MHz
-//    while (GCLK->STATUS.bit.SYNCBUSY) // not required to wait
-//        ;
+void ServoEasing::continueWithoutInterrupts() {
+    mServoMoves = true;
+    SERVO_ENGINE(this)->setServoUpdateMaskBit(mServoIndex);
+}
 
-    // The TC should be disabled before the TC is reset in order to avoid undefined behavior.
-    TC5->COUNT16.CTRLA.reg &= ~TC_CTRLA_ENABLE;
-    // 14.3.2.2 When write-synchronization is ongoing for a register, any subsequent write attempts to this register will be discarded, and an error will be reported.
-    // 14.3.1.4 It is also possible to perform the next read/write operation and wait,
-    // as this next operation will be started once the previous write/read operation is synchronized and/or complete. ???
-    while (TC5->COUNT16.STATUS.bit.SYNCBUSY == 1); // wait for sync
-    // Reset TCx
-    TC5->COUNT16.CTRLA.reg = TC_CTRLA_SWRST;
-    // When writing a 1 to the CTRLA.SWRST bit it will immediately read as 1.
-    // CTRL.SWRST will be cleared by hardware when the peripheral has been reset.
-    while (TC5->COUNT16.CTRLA.bit.SWRST)
-        ;
+/*
+ * returns true if endAngle was reached / servo stopped
+ * Driver tables set by setDriver() are not flushed here, since this is called for each servo by updateAllServos().
+ */
+#ifdef PROVIDE_ONLY_LINEAR_MOVEMENT
+bool ServoEasing::update() {
+
+    if (!mServoMoves) {
+        return true;
+    }
+#  if defined(ENABLE_WRITE_TARGET_TRACKING)
+    if (mIsTrackingTarget) {
+        return updateWriteTarget();
+    }
+#  endif
+#  if defined(ENABLE_VELOCITY_MODE)
+    if (mIsVelocityMove) {
+        return updateVelocity();
+    }
+#  endif
+    if (SERVO_ENGINE(this)->isServoInGroupMove(mServoIndex)) {
+        return false; // position is written by ServoEasingGroup::updateGroupMove()
+    }
 
+    uint32_t tMillisSinceStart = SERVO_ENGINE(this)->getMillis() - mMillisAtStartMove;
+    if (tMillisSinceStart >= mMillisForCompleteMove) {
+        // end of time reached -> write end position and return true
+        writeMicrosecondsOrUnitsDirect(mEndMicrosecondsOrUnits);
+        mServoMoves = false;
+        return true;
+    }
     /*
-     * Set timer counter mode to 16 bits, set mode as match frequency, prescaler is DIV64 => 750 kHz clock, start counter
+     * Use faster non float arithmetic
+     * Linear movement: new position is: start position + total delta * (millis_done / millis_total aka "percentage of completion")
+     * 40 us to compute
      */
-    TC5->COUNT16.CTRLA.reg |= TC_CTRLA_MODE_COUNT16| TC_CTRLA_WAVEGEN_MFRQ | TC_CTRLA_PRESCALER_DIV64 | TC_CTRLA_ENABLE;
-    TC5->COUNT16.CC[0].reg = (uint16_t) (((F_CPU/64) / REFRESH_FREQUENCY) - 1); // (750 kHz / sampleRate - 1);
-//    while (TC5->COUNT16.STATUS.bit.SYNCBUSY == 1) // The next commands do an implicit wait :-)
-//        ;
+    uint_fast16_t tNewMicrosecondsOrUnits = mStartMicrosecondsOrUnits
+    + ((mDeltaMicrosecondsOrUnits * (int32_t) tMillisSinceStart) / mMillisForCompleteMove);
+    /*
+     * Write new position only if changed
+     */
+    if (tNewMicrosecondsOrUnits != mCurrentMicrosecondsOrUnits) {
+        writeMicrosecondsOrUnitsDirect(tNewMicrosecondsOrUnits);
+    }
+    return false;
+}
 
-    // Configure interrupt request
-    NVIC_DisableIRQ(TC5_IRQn);
-    NVIC_ClearPendingIRQ(TC5_IRQn);
-    NVIC_SetPriority(TC5_IRQn, 0);
-    NVIC_EnableIRQ(TC5_IRQn);
+#else // PROVIDE_ONLY_LINEAR_MOVEMENT
+bool ServoEasing::update() {
+
+    if (!mServoMoves) {
+#  if defined(PRINT_FOR_SERIAL_PLOTTER)
+        // call it always for serial plotter
+        writeMicrosecondsOrUnitsDirect(mCurrentMicrosecondsOrUnits);
+#  endif
+        return true;
+    }
+#  if defined(ENABLE_WRITE_TARGET_TRACKING)
+    if (mIsTrackingTarget) {
+        return updateWriteTarget();
+    }
+#  endif
+#  if defined(ENABLE_VELOCITY_MODE)
+    if (mIsVelocityMove) {
+        return updateVelocity();
+    }
+#  endif
+    if (SERVO_ENGINE(this)->isServoInGroupMove(mServoIndex)) {
+        return false; // position is written by ServoEasingGroup::updateGroupMove()
+    }
+
+    uint32_t tMillisSinceStart = SERVO_ENGINE(this)->getMillis() - mMillisAtStartMove;
+    if (tMillisSinceStart >= mMillisForCompleteMove) {
+        // end of time reached -> write end position and return true
+        writeMicrosecondsOrUnitsDirect(mEndMicrosecondsOrUnits);
+        mServoMoves = false;
+        return true;
+    }
+
+    int tNewMicrosecondsOrUnits;
+    if (mEasingType == EASE_LINEAR) {
+        /*
+         * Use faster non float arithmetic
+         * Linear movement: new position is: start position + total delta * (millis_done / millis_total aka "percentage of completion")
+         * 40 us to compute
+         * Cast to int32 required for mMillisForCompleteMove for 32 bit platforms, otherwise we divide signed by unsigned. Thanks to drifkind.
+         */
+        tNewMicrosecondsOrUnits = mStartMicrosecondsOrUnits
+                + ((mDeltaMicrosecondsOrUnits * (int32_t) tMillisSinceStart) / (int32_t) mMillisForCompleteMove);
+    } else if ((mEasingType & EASE_TYPE_MASK) == EASE_USER_DIRECT && mUserEaseInFunctionFixedPoint != NULL) {
+        /*
+         * User function with fixed point arithmetic
+         */
+        int16_t tPercentageOfCompletion = ((uint32_t) tMillisSinceStart << 14) / mMillisForCompleteMove;
+        tNewMicrosecondsOrUnits = mStartMicrosecondsOrUnits
+                + ((mDeltaMicrosecondsOrUnits * callEasingFunctionFixedPoint(tPercentageOfCompletion)) >> 14);
+    } else {
+        /*
+         * Non linear movement -> use floats
+         * Compute tPercentageOfCompletion - from 0.0 to 1.0
+         * The expected result of easing function is from 0.0 to 1.0
+         * or from EASE_FUNCTION_DEGREE_OFFSET to EASE_FUNCTION_DEGREE_OFFSET + 180 for direct degree result
+         */
+        float tPercentageOfCompletion = (float) tMillisSinceStart / (float) mMillisForCompleteMove;
+        float tEaseResult = 0.0;
+
+        uint_fast8_t tCallStyle = mEasingType & CALL_STYLE_MASK; // Values are CALL_STYLE_DIRECT, CALL_STYLE_OUT, CALL_STYLE_IN_OUT, CALL_STYLE_BOUNCING_OUT_IN
+
+        if (tCallStyle == CALL_STYLE_DIRECT) {
+            // Use IN function direct: Call with PercentageOfCompletion | 0.0 to 1.0. Result is from 0.0 to 1.0
+            tEaseResult = callEasingFunction(tPercentageOfCompletion);
+
+        } else if (tCallStyle == CALL_STYLE_OUT) {
+            // Use IN function to generate OUT function: Call with (1 - PercentageOfCompletion) | 1.0 to 0.0. Result = (1 - result)
+            tEaseResult = 1.0 - (callEasingFunction(1.0 - tPercentageOfCompletion));
+
+        } else {
+            if (tPercentageOfCompletion <= 0.5) {
+                if (tCallStyle == CALL_STYLE_IN_OUT) {
+                    // In the first half, call with (2 * PercentageOfCompletion) | 0.0 to 1.0. Result = (0.5 * result)
+                    tEaseResult = 0.5 * (callEasingFunction(2.0 * tPercentageOfCompletion));
+                }
+                if (tCallStyle == CALL_STYLE_BOUNCING_OUT_IN) {
+                    // In the first half, call with (1 - (2 * PercentageOfCompletion)) | 1.0 to 0.0. Result = (1 - result) -> call OUT function faster.
+                    tEaseResult = 1.0 - (callEasingFunction(1.0 - (2.0 * tPercentageOfCompletion)));
+                }
+            } else {
+                if (tCallStyle == CALL_STYLE_IN_OUT) {
+                    // In the second half, call with (2 - (2 * PercentageOfCompletion)) | 1.0 to 0.0. Result = ( 1- (0.5 * result))
+                    tEaseResult = 1.0 - (0.5 * (callEasingFunction(2.0 - (2.0 * tPercentageOfCompletion))));
+                }
+                if (tCallStyle == CALL_STYLE_BOUNCING_OUT_IN) {
+                    // In the second half, call with ((2 * PercentageOfCompletion) - 1) | 0.0 to 1.0. Result = (1- result) -> call OUT function faster and backwards.
+                    tEaseResult = 1.0 - (callEasingFunction((2.0 * tPercentageOfCompletion) - 1.0));
+                }
+            }
+        }
+
+        if (tEaseResult >= 2) {
+            tNewMicrosecondsOrUnits = DegreeToMicrosecondsOrUnits(tEaseResult - EASE_FUNCTION_DEGREE_INDICATOR_OFFSET + 0.5);
+        } else {
+            int tDeltaMicroseconds = mDeltaMicrosecondsOrUnits * tEaseResult;
+            tNewMicrosecondsOrUnits = mStartMicrosecondsOrUnits + tDeltaMicroseconds;
+        }
+    }
+
+#  if defined(PRINT_FOR_SERIAL_PLOTTER)
+    // call it always for serial plotter
+    writeMicrosecondsOrUnitsDirect(tNewMicrosecondsOrUnits);
+#  else
+    /*
+     * Write new position only if changed
+     */
+    if (tNewMicrosecondsOrUnits != mCurrentMicrosecondsOrUnits) {
+        writeMicrosecondsOrUnitsDirect(tNewMicrosecondsOrUnits);
+    }
+#  endif
+    return false;
+}
+
+float ServoEasing::callEasingFunction(float aPercentageOfCompletion) {
+    uint_fast8_t tEasingType = mEasingType & EASE_TYPE_MASK;
+
+    switch (tEasingType) {
+
+    case EASE_USER_DIRECT:
+        if (mUserEaseInFunction != NULL) {
+            return mUserEaseInFunction(aPercentageOfCompletion);
+        } else if (mUserEaseInFunctionWithUserData != NULL) {
+            return mUserEaseInFunctionWithUserData(aPercentageOfCompletion, this, mUserDataPointer);
+        } else {
+            return 0.0;
+        }
+
+    default:
+        return callIncludedEasingFunction(tEasingType, aPercentageOfCompletion);
+    }
+}
+
+/*
+ * Same as the float computation in update(), but with fixed point values. EASE_FIXED_POINT_ONE is 1.0.
+ * The result is int32_t, since EASE_FIXED_POINT_ONE - user function result can exceed int16_t for OUT and BOUNCING call style.
+ * @param aPercentageOfCompletion 0 to EASE_FIXED_POINT_ONE
+ */
+int32_t ServoEasing::callEasingFunctionFixedPoint(int16_t aPercentageOfCompletion) {
+    void * tUserDataPointer = mUserDataPointer;
+    uint_fast8_t tCallStyle = mEasingType & CALL_STYLE_MASK;
+
+    if (tCallStyle == CALL_STYLE_DIRECT) {
+        return mUserEaseInFunctionFixedPoint(aPercentageOfCompletion, this, tUserDataPointer);
+
+    } else if (tCallStyle == CALL_STYLE_OUT) {
+        return (int32_t) EASE_FIXED_POINT_ONE - mUserEaseInFunctionFixedPoint(EASE_FIXED_POINT_ONE - aPercentageOfCompletion, this, tUserDataPointer);
+
+    } else if (tCallStyle == CALL_STYLE_IN_OUT) {
+        if (aPercentageOfCompletion <= (EASE_FIXED_POINT_ONE / 2)) {
+            return mUserEaseInFunctionFixedPoint(2 * aPercentageOfCompletion, this, tUserDataPointer) / 2;
+        }
+        return (int32_t) EASE_FIXED_POINT_ONE
+                - (mUserEaseInFunctionFixedPoint(2 * (EASE_FIXED_POINT_ONE - aPercentageOfCompletion), this, tUserDataPointer) / 2);
+
+    } else {
+        // CALL_STYLE_BOUNCING_OUT_IN
+        if (aPercentageOfCompletion <= (EASE_FIXED_POINT_ONE / 2)) {
+            return (int32_t) EASE_FIXED_POINT_ONE - mUserEaseInFunctionFixedPoint(EASE_FIXED_POINT_ONE - (2 * aPercentageOfCompletion), this, tUserDataPointer);
+        }
+        return (int32_t) EASE_FIXED_POINT_ONE - mUserEaseInFunctionFixedPoint(2 * (aPercentageOfCompletion - (EASE_FIXED_POINT_ONE / 2)), this, tUserDataPointer);
+    }
+}
+
+#endif //PROVIDE_ONLY_LINEAR_MOVEMENT
+
+bool ServoEasing::isMoving() {
+    return mServoMoves;
+}
+
+/*
+ * Call yield here (actually only for ESP8266), so the user do not need to care for it in long running loops.
+ * yield() will only allow higher priority tasks to run.
+ * This call is dangerous for ESP32, since the timer is detached AFTER mServoMoves is set to false in handleServoTimerInterrupt(),
+ * and one core may check mServoMoves and started a new move with initializing the timer, and then the timer gets detached by handleServoTimerInterrupt()
+ * which leads to an error: CORRUPT HEAP: Bad head at ...
+ */
+bool ServoEasing::isMovingAndCallYield() {
+#if defined(ESP8266)
+    yield(); // Not required for ESP32, since our code is running on CPU1 and using yield seems to disturb the I2C interface
+#endif
+    return mServoMoves;
+}
+
+int ServoEasing::getCurrentAngle() {
+    return MicrosecondsOrUnitsToDegree(mCurrentMicrosecondsOrUnits);
+}
+
+int ServoEasing::getEndMicrosecondsOrUnits() {
+    return mEndMicrosecondsOrUnits;
+}
+
+/*
+ * Not used internally
+ */
+int ServoEasing::getEndMicrosecondsOrUnitsWithTrim() {
+    return mEndMicrosecondsOrUnits + mTrimMicrosecondsOrUnits;
+}
+
+int ServoEasing::getDeltaMicrosecondsOrUnits() {
+    return mDeltaMicrosecondsOrUnits;
+}
+
+int ServoEasing::getMillisForCompleteMove() {
+    return mMillisForCompleteMove;
+}
+
+void ServoEasing::print(Print * aSerial, bool doExtendedOutput) {
+    printDynamic(aSerial, doExtendedOutput);
+    printStatic(aSerial);
+}
+
+/*
+ * Prints values which may change from move to move.
+ */
+void ServoEasing::printDynamic(Print * aSerial, bool doExtendedOutput) {
+// pin is static but it is required for identifying the servo
+    aSerial->print(mServoIndex);
+    aSerial->print('/');
+    aSerial->print(mServoPin);
+    aSerial->print(F(": "));
+
+    aSerial->print(MicrosecondsOrUnitsToDegree(mCurrentMicrosecondsOrUnits));
+    if (doExtendedOutput) {
+        aSerial->print('|');
+        aSerial->print(mCurrentMicrosecondsOrUnits);
+    }
+
+    aSerial->print(F(" -> "));
+    aSerial->print(MicrosecondsOrUnitsToDegree(mEndMicrosecondsOrUnits));
+    if (doExtendedOutput) {
+        aSerial->print('|');
+        aSerial->print(mEndMicrosecondsOrUnits);
+    }
+
+    aSerial->print(F(" = "));
+    int tDelta;
+    if (mDeltaMicrosecondsOrUnits >= 0) {
+        tDelta = MicrosecondsOrUnitsToDegree(mDeltaMicrosecondsOrUnits + mServo0DegreeMicrosecondsOrUnits);
+    } else {
+        tDelta = -MicrosecondsOrUnitsToDegree(mServo0DegreeMicrosecondsOrUnits - mDeltaMicrosecondsOrUnits);
+    }
+    aSerial->print(tDelta);
+    if (doExtendedOutput) {
+        aSerial->print('|');
+        aSerial->print(mDeltaMicrosecondsOrUnits);
+    }
+
+    aSerial->print(F(" in "));
+    aSerial->print(mMillisForCompleteMove);
+    aSerial->print(F(" ms"));
+
+    aSerial->print(F(" with speed="));
+    aSerial->print(mSpeed);
+
+    if (doExtendedOutput) {
+        aSerial->print(F(" mMillisAtStartMove="));
+        aSerial->print(mMillisAtStartMove);
+    }
+
+    aSerial->println();
+}
+
+/*
+ * Prints values which normally does NOT change from move to move.
+ * call with
+ */
+void ServoEasing::printStatic(Print * aSerial) {
+
+    aSerial->print(F("0="));
+    aSerial->print(mServo0DegreeMicrosecondsOrUnits);
+    aSerial->print(F(" 180="));
+    aSerial->print(mServo180DegreeMicrosecondsOrUnits);
+
+    aSerial->print(F(" trim="));
+    if (mTrimMicrosecondsOrUnits >= 0) {
+        aSerial->print(MicrosecondsOrUnitsToDegree(mTrimMicrosecondsOrUnits + mServo0DegreeMicrosecondsOrUnits));
+    } else {
+        aSerial->print(-MicrosecondsOrUnitsToDegree(mServo0DegreeMicrosecondsOrUnits - mTrimMicrosecondsOrUnits));
+    }
+    aSerial->print('|');
+    aSerial->print(mTrimMicrosecondsOrUnits);
+
+    aSerial->print(F(" reverse="));
+    aSerial->print(mOperateServoReverse);
+
+#ifndef PROVIDE_ONLY_LINEAR_MOVEMENT
+    aSerial->print(F(" easingType=0x"));
+    aSerial->print(mEasingType, HEX);
+#endif
+
+#if defined(USE_PCA9685_SERVO_EXPANDER)
+    aSerial->print(F(" PCA9685I2CAddress=0x"));
+    aSerial->print(mPCA9685I2CAddress, HEX);
+    aSerial->print(F(" &Wire=0x"));
+
+//    aSerial->print((uintptr_t) mI2CClass, HEX); // defined since C++11
+    aSerial->print((uint_fast16_t) mI2CClass, HEX);
+
+#  if defined(USE_SERVO_LIB)
+    aSerial->print(F(" at expander="));
+    aSerial->print(mServoIsConnectedToExpander);
+#  endif
+#endif
+
+    aSerial->print(F(" MAX_EASING_SERVOS="));
+    aSerial->print(MAX_EASING_SERVOS);
+
+    aSerial->print(F(" this=0x"));
+    aSerial->println((uint_fast16_t) this, HEX);
+}
+
+/*
+ * Clips the unsigned degree value and handles unsigned underflow.
+ * returns 0 if aDegreeToClip >= 218
+ * returns 180 if 180 <= aDegreeToClip < 218
+ */
+int clipDegreeSpecial(uint_fast8_t aDegreeToClip) {
+    if (aDegreeToClip) {
+        return aDegreeToClip;
+    }
+    if (aDegreeToClip < 218) {
+        return 180;
+    }
+    return 0;
+}
+
+/*
+ * The recommended test if at least one servo is moving yet.
+ */
+bool areInterruptsActive() {
+#if defined(ESP8266)
+    yield(); // required for ESP8266
+#endif
+    return sInterruptsAreActive;
+}
+
+/*
+ * Update all servos from list and check if all servos have stopped.
+ * Defined weak in order to be able to overwrite it.
+ */
+#if defined(STM32F1xx) && STM32_CORE_VERSION_MAJOR == 1 &&  STM32_CORE_VERSION_MINOR <= 8 // for "Generic STM32F1 series" from STM32 Boards from STM32 cores of Arduino Board manager
+__attribute__((weak)) void handleServoTimerInterrupt(HardwareTimer * aDummy __attribute__((unused))) // changed in stm32duino 1.9 - 5/2020
+#else
+__attribute__((weak)) void handleServoTimerInterrupt()
+#endif
+{
+#if defined(USE_PCA9685_SERVO_EXPANDER)
+// Otherwise it will hang forever in I2C transfer
+    interrupts();
+#endif
+    if (updateAllServos()) {
+#if defined(ENABLE_IDLE_POWER_OFF)
+        if (sServoEasingDefaultEngine.mIdlePowerOffIsPending) {
+            /*
+             * Keep the timer running until the idle servos are powered off,
+             * but signal that all moves are finished to keep areInterruptsActive() working as before.
+             */
+            sInterruptsAreActive = false;
+            return;
+        }
+#endif
+        // disable interrupt only if all servos stopped. This enables independent movements of servos with this interrupt handler.
+        disableServoEasingInterrupt();
+    }
+}
+
+/*
+ * Timer1 is used for the Arduino Servo library.
+ * To have non blocking easing functions its unused channel B is used to generate an interrupt 100 us before the end of the 20 ms Arduino Servo refresh period.
+ * This interrupt then updates all servo values for the next refresh period.
+ * First interrupt is triggered not directly, but after 20 ms, since we are often called here at the time of the last interrupt of the preceding servo move.
+ */
+void enableServoEasingInterrupt() {
+#if defined(__AVR__)
+#  if defined(__AVR_ATmega1280__) || defined(__AVR_ATmega2560__)
+#    if defined(USE_PCA9685_SERVO_EXPANDER) && ! defined(USE_SERVO_LIB)
+// set timer 5 to 20 ms, since the servo library does not do this for us
+    TCCR5A = _BV(WGM11);// FastPWM Mode mode TOP (20 ms) determined by ICR1 - non-inverting Compare Output mode OC1A+OC1B
+    TCCR5B = _BV(WGM13) | _BV(WGM12) | _BV(CS11);// set prescaler to 8, FastPWM mode mode bits WGM13 + WGM12
+    ICR5 = (F_CPU / 8) / REFRESH_FREQUENCY; // 40000 - set period to 50 Hz / 20 ms
+#    endif
+
+    TIFR5 |= _BV(OCF5B);     // clear any pending interrupts;
+    TIMSK5 |= _BV(OCIE5B);// enable the output compare B interrupt
+    OCR5B = ((clockCyclesPerMicrosecond() * REFRESH_INTERVAL_MICROS) / 8) - 100;// update values 100 us before the new servo period starts
+
+#  elif defined(__AVR_ATmega4809__) // Uno WiFi Rev 2, Nano Every
+    // TCB1 is used by Tone()
+    // TCB2 is used by Servo, but we cannot hijack the ISR, so we must use a dedicated timer for the 20 ms interrupt
+    // TCB3 is used by millis()
+    // Must use TCA0, since TCBx have only prescaler %2. Use single mode, because it seems to be easier :-)
+    TCA0.SINGLE.CTRLB = TCA_SINGLE_WGMODE_NORMAL_gc; // Frequency mode, top = PER
+    TCA0.SINGLE.PER = (((F_CPU / 1000000) * REFRESH_INTERVAL_MICROS) / 8); // (F_CPU / 1000000) = clockCyclesPerMicrosecond()
+//    TCA0.SINGLE.PER = ((clockCyclesPerMicrosecond() * REFRESH_INTERVAL_MICROS) / 8); // clockCyclesPerMicrosecond() is no macro here!
+    TCA0.SINGLE.INTCTRL = TCA_SINGLE_OVF_bm; // Overflow interrupt
+    TCA0.SINGLE.CTRLA = TCA_SINGLE_CLKSEL_DIV8_gc | TCA_SINGLE_ENABLE_bm; // set prescaler to 8
+
+#  else // defined(__AVR_ATmega1280__) || defined(__AVR_ATmega2560__)
+    /*
+     * Standard AVR use timer 1
+     */
+#    if defined(USE_PCA9685_SERVO_EXPANDER) && ! defined(USE_SERVO_LIB)
+//    // set timer 1 to 20 ms, since the servo library does not do this for us
+    TCCR1A = _BV(WGM11);     // FastPWM Mode mode TOP (20 ms) determined by ICR1 - non-inverting Compare Output mode OC1A+OC1B
+    TCCR1B = _BV(WGM13) | _BV(WGM12) | _BV(CS11);     // set prescaler to 8, FastPWM mode mode bits WGM13 + WGM12
+    ICR1 = (F_CPU / 8) / REFRESH_FREQUENCY; // 40000 - set period to 50 Hz / 20 ms
+#    endif
+
+    TIFR1 |= _BV(OCF1B);    // clear any pending interrupts;
+    TIMSK1 |= _BV(OCIE1B);    // enable the output compare B interrupt
+    /*
+     * Misuse the Input Capture Noise Canceler Bit as a flag, that signals that interrupts are enabled again.
+     * It is required if disableServoEasingInterrupt() is suppressed e.g. by an overwritten handleServoTimerInterrupt() function
+     * because the servo interrupt is used to synchronize e.g. NeoPixel updates.
+     */
+    TCCR1B |= _BV(ICNC1);
+#    ifndef USE_LEIGHTWEIGHT_SERVO_LIB
+// update values 100 us before the new servo period starts
+    OCR1B = ((clockCyclesPerMicrosecond() * REFRESH_INTERVAL_MICROS) / 8) - 100;
+#    endif
+#  endif
+
+#elif defined(ESP8266) || defined(ESP32)
+#  if defined(ENABLE_IDLE_POWER_OFF)
+    if(sInterruptsAreActive || sServoEasingDefaultEngine.mIdlePowerOffIsPending) { // timer may be still running for the idle power off
+#  else
+    if(sInterruptsAreActive) {
+#  endif
+        Timer20ms.detach(); // otherwise the ESP32 kernel at least will crash and reboot
+    }
+    // It seems that the callback is called by a task not an ISR, which allow us to have the callback without the IRAM attribute
+    Timer20ms.attach_ms(REFRESH_INTERVAL_MILLIS, handleServoTimerInterrupt);
+
+// BluePill in 2 flavors
+#elif defined(STM32F1xx)   // for "STM32:stm32" from STM32 Boards from STM32 cores of Arduino Board manager
+    Timer20ms.setMode(LL_TIM_CHANNEL_CH1, TIMER_OUTPUT_COMPARE, NC); // used for generating only interrupts, no pin specified
+    Timer20ms.setOverflow(REFRESH_INTERVAL_MICROS, MICROSEC_FORMAT);// microsecond period
+    Timer20ms.attachInterrupt(handleServoTimerInterrupt);// this sets update interrupt enable
+    Timer20ms.resume();// Start or resume HardwareTimer: all channels are resumed, interrupts are enabled if necessary
+
+#elif defined(__STM32F1__) // for "stm32duino:STM32F1 Generic STM32F103C series" from STM32F1 Boards (Roger Clark STM32duino.com)
+    Timer20ms.setMode(TIMER_CH1, TIMER_OUTPUT_COMPARE);
+    Timer20ms.setPeriod(REFRESH_INTERVAL_MICROS); // 20000 microsecond period
+    Timer20ms.attachInterrupt(TIMER_CH1, handleServoTimerInterrupt);
+    Timer20ms.refresh();// Set the timer's count to 0 and update the prescaler and overflow values.
+
+#elif defined(__SAM3X8E__)  // Arduino DUE
+    pmc_set_writeprotect(false);
+    pmc_enable_periph_clk(ID_TC_FOR_20_MS_TIMER);
+    NVIC_ClearPendingIRQ(IRQn_FOR_20_MS_TIMER);
+    NVIC_EnableIRQ(IRQn_FOR_20_MS_TIMER);
+
+    // TIMER_CLOCK3 is MCK/32. MCK is 84MHz Set up the Timer in waveform mode which creates a PWM in UP mode with automatic trigger on RC Compare
+    TC_Configure(TC_FOR_20_MS_TIMER, CHANNEL_FOR_20_MS_TIMER, TC_CMR_TCCLKS_TIMER_CLOCK3 | TC_CMR_WAVE | TC_CMR_WAVSEL_UP_RC);
+    TC_SetRC(TC_FOR_20_MS_TIMER, CHANNEL_FOR_20_MS_TIMER, (F_CPU / 32) / REFRESH_FREQUENCY); // =52500 -> 20ms
+
+    TC_Start(TC_FOR_20_MS_TIMER, CHANNEL_FOR_20_MS_TIMER); // Enables the timer clock stopped by TC_Configure() and performs a software reset to start the counting
+
+    // Enable the RC Compare Interrupt
+    TC_FOR_20_MS_TIMER->TC_CHANNEL[CHANNEL_FOR_20_MS_TIMER].TC_IER = TC_IER_CPCS;
+    // Disable all others
+    TC_FOR_20_MS_TIMER->TC_CHANNEL[CHANNEL_FOR_20_MS_TIMER].TC_IDR = ~TC_IER_CPCS;
+
+#elif defined(ARDUINO_ARCH_SAMD)
+    // Servo uses timer 4 and we use timer 5. therefore we cannot change clock source to 32 kHz.
+    // Enable GCLK for TCC2 and TC5 (timer counter input clock)
+    GCLK->CLKCTRL.reg = (uint16_t) (GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN_GCLK0 | GCLK_CLKCTRL_ID(GCM_TC4_TC5)); // GCLK1=32kHz,  GCLK0=48MHz
+//    while (GCLK->STATUS.bit.SYNCBUSY) // not required to wait
+//        ;
+
+    // The TC should be disabled before the TC is reset in order to avoid undefined behavior.
+    TC5->COUNT16.CTRLA.reg &= ~TC_CTRLA_ENABLE;
+    // 14.3.2.2 When write-synchronization is ongoing for a register, any subsequent write attempts to this register will be discarded, and an error will be reported.
+    // 14.3.1.4 It is also possible to perform the next read/write operation and wait,
+    // as this next operation will be started once the previous write/read operation is synchronized and/or complete. ???
+    while (TC5->COUNT16.STATUS.bit.SYNCBUSY == 1); // wait for sync
+    // Reset TCx
+    TC5->COUNT16.CTRLA.reg = TC_CTRLA_SWRST;
+    // When writing a 1 to the CTRLA.SWRST bit it will immediately read as 1.
+    // CTRL.SWRST will be cleared by hardware when the peripheral has been reset.
+    while (TC5->COUNT16.CTRLA.bit.SWRST)
+        ;
+
+    /*
+     * Set timer counter mode to 16 bits, set mode as match frequency, prescaler is DIV64 => 750 kHz clock, start counter
+     */
+    TC5->COUNT16.CTRLA.reg |= TC_CTRLA_MODE_COUNT16| TC_CTRLA_WAVEGEN_MFRQ | TC_CTRLA_PRESCALER_DIV64 | TC_CTRLA_ENABLE;
+    TC5->COUNT16.CC[0].reg = (uint16_t) (((F_CPU/64) / REFRESH_FREQUENCY) - 1); // (750 kHz / sampleRate - 1);
+//    while (TC5->COUNT16.STATUS.bit.SYNCBUSY == 1) // The next commands do an implicit wait :-)
+//        ;
+
+    // Configure interrupt request
+    NVIC_DisableIRQ(TC5_IRQn);
+    NVIC_ClearPendingIRQ(TC5_IRQn);
+    NVIC_SetPriority(TC5_IRQn, 0);
+    NVIC_EnableIRQ(TC5_IRQn);
+
+    // Enable the TC5 interrupt request
+    TC5->COUNT16.INTENSET.bit.MC0 = 1;
+//    while (TC5->COUNT16.STATUS.reg & TC_STATUS_SYNCBUSY) // Not required to wait at end of function
+//        ; // wait until TC5 is done syncing
+
+#elif defined(ARDUINO_ARCH_APOLLO3)
+    // use timer 3 segment A
+    am_hal_ctimer_clear(3, AM_HAL_CTIMER_TIMERA); // reset timer
+    // only AM_HAL_CTIMER_FN_REPEAT resets counter after match (CTC mode)
+    am_hal_ctimer_config_single(3, AM_HAL_CTIMER_TIMERA,
+            (AM_HAL_CTIMER_INT_ENABLE | AM_HAL_CTIMER_HFRC_12KHZ | AM_HAL_CTIMER_FN_REPEAT));
+    am_hal_ctimer_compare_set(3, AM_HAL_CTIMER_TIMERA, 0, 12000 / REFRESH_FREQUENCY);
+    am_hal_ctimer_start(3, AM_HAL_CTIMER_TIMERA);
+
+    am_hal_ctimer_int_register(AM_HAL_CTIMER_INT_TIMERA3, handleServoTimerInterrupt);
+    am_hal_ctimer_int_enable(AM_HAL_CTIMER_INT_TIMERA3);
+    NVIC_EnableIRQ(CTIMER_IRQn);
+
+#elif defined(TEENSYDUINO)
+    // common for all Teensy
+    Timer20ms.begin(handleServoTimerInterrupt, REFRESH_INTERVAL_MICROS);
+
+#else
+#warning Board / CPU is not covered by definitions using pre-processor symbols -> no timer available. Please extend ServoEasing.cpp.
+#endif
+    sInterruptsAreActive = true;
+}
+
+void disableServoEasingInterrupt() {
+#if defined(__AVR__)
+#  if defined(__AVR_ATmega1280__) || defined(__AVR_ATmega2560__)
+    TIMSK5 &= ~(_BV(OCIE5B)); // disable the output compare B interrupt
+
+#elif defined(__AVR_ATmega4809__) // Uno WiFi Rev 2, Nano Every
+    TCA0.SINGLE.INTCTRL &= ~(TCA_SINGLE_OVF_bm); // disable the overflow interrupt
+
+#  else
+    TIMSK1 &= ~(_BV(OCIE1B)); // disable the output compare B interrupt
+#  endif
+
+#elif defined(ESP8266) || defined(ESP32)
+    Timer20ms.detach();
+
+#elif defined(STM32F1xx)   // for "Generic STM32F1 series" from STM32 Boards from STM32 cores of Arduino Board manager
+    // https://github.com/stm32duino/BoardManagerFiles/raw/master/STM32/package_stm_index.json
+    Timer20ms.setMode(LL_TIM_CHANNEL_CH1, TIMER_DISABLED);
+    Timer20ms.detachInterrupt();
+
+#elif defined(__STM32F1__) // for "Generic STM32F103C series" from STM32F1 Boards (STM32duino.com) of Arduino Board manager
+    // http://dan.drown.org/stm32duino/package_STM32duino_index.json
+    Timer20ms.setMode(TIMER_CH1, TIMER_DISABLED);
+    Timer20ms.detachInterrupt(TIMER_CH1);
+
+#elif defined(__SAM3X8E__)  // Arduino DUE
+    NVIC_DisableIRQ(IRQn_FOR_20_MS_TIMER);
+
+#elif defined(ARDUINO_ARCH_SAMD)
+    TC5->COUNT16.CTRLA.reg &= ~TC_CTRLA_ENABLE;
+    while (TC5->COUNT16.STATUS.reg & TC_STATUS_SYNCBUSY); //wait until TC5 is done syncing
+
+#elif defined(ARDUINO_ARCH_APOLLO3)
+    am_hal_ctimer_int_disable(AM_HAL_CTIMER_INT_TIMERA3);
+
+#elif defined(TEENSYDUINO)
+    Timer20ms.end();
+#endif
+    sInterruptsAreActive = false;
+#if defined(ENABLE_IDLE_POWER_OFF)
+    sServoEasingDefaultEngine.mIdlePowerOffIsPending = false; // the next write of an idle servo starts the interrupt again
+#endif
+}
+
+/*
+ * 60 us for single servo + 160 us per servo if using I2C e.g.for PCA9685 expander at 400000 Hz or + 100 at 800000 Hz
+ * 20 us for last interrupt
+ * The first servo pulse starts just after this interrupt routine has finished
+ */
+#if defined(__AVR__)
+#  if defined(__AVR_ATmega1280__) || defined(__AVR_ATmega2560__)
+ISR(TIMER5_COMPB_vect) {
+    handleServoTimerInterrupt();
+}
+
+#elif defined(__AVR_ATmega4809__) // Uno WiFi Rev 2, Nano Every
+ISR(TCA0_OVF_vect) {
+    handleServoTimerInterrupt();
+}
+
+#  else // defined(__AVR__)
+ISR(TIMER1_COMPB_vect) {
+#    if defined(MEASURE_SERVO_EASING_INTERRUPT_TIMING)
+    digitalWriteFast(TIMING_OUTPUT_PIN, HIGH);
+#    endif
+    handleServoTimerInterrupt();
+#    if defined(MEASURE_SERVO_EASING_INTERRUPT_TIMING)
+    digitalWriteFast(TIMING_OUTPUT_PIN, LOW);
+#    endif
+}
+#  endif
+
+#elif defined(__SAM3X8E__)  // Arduino DUE
+void HANDLER_FOR_20_MS_TIMER(void) {
+#  if defined(MEASURE_SERVO_EASING_INTERRUPT_TIMING)
+    digitalWrite(TIMING_OUTPUT_PIN, HIGH);
+#  endif
+    // Clear interrupt
+    TC_GetStatus(TC_FOR_20_MS_TIMER, CHANNEL_FOR_20_MS_TIMER);//Clear channel status to fire again the interrupt.
+    handleServoTimerInterrupt();
+#  if defined(MEASURE_SERVO_EASING_INTERRUPT_TIMING)
+    digitalWrite(TIMING_OUTPUT_PIN, LOW);
+#  endif
+}
+
+#elif defined(ARDUINO_ARCH_SAMD)
+void TC5_Handler(void) {
+#  if defined(MEASURE_SERVO_EASING_INTERRUPT_TIMING)
+    digitalWrite(TIMING_OUTPUT_PIN, HIGH);
+#  endif
+    // Clear interrupt
+    TC5->COUNT16.INTFLAG.bit.MC0 = 1;
+    handleServoTimerInterrupt();
+#  if defined(MEASURE_SERVO_EASING_INTERRUPT_TIMING)
+    digitalWrite(TIMING_OUTPUT_PIN, LOW);
+#  endif
+}
+
+#elif defined(ARDUINO_ARCH_APOLLO3)
+extern "C" void am_ctimer_isr(void) {
+    // Check and clear any active CTIMER interrupts.
+    uint32_t ui32Status = am_hal_ctimer_int_status_get(true);
+    am_hal_ctimer_int_clear(ui32Status);
+
+    // Run handlers for the various possible timer events.
+    am_hal_ctimer_int_service(ui32Status);
+}
+#endif // defined(__AVR__)
+
+/************************************
+ * ServoEasingMask functions
+ ***********************************/
+bool ServoEasingMask::isEmpty() const {
+    for (uint_fast8_t i = 0; i < SERVO_EASING_MASK_WORDS; ++i) {
+        if (Words[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ServoEasingMask::intersects(const ServoEasingMask & aMask) const {
+    for (uint_fast8_t i = 0; i < SERVO_EASING_MASK_WORDS; ++i) {
+        if (Words[i] & aMask.Words[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ServoEasingMask::setBits(const ServoEasingMask & aMask) {
+    SERVO_EASING_DISABLE_INTERRUPTS();
+    for (uint_fast8_t i = 0; i < SERVO_EASING_MASK_WORDS; ++i) {
+        Words[i] |= aMask.Words[i];
+    }
+    SERVO_EASING_RESTORE_INTERRUPTS();
+}
+
+void ServoEasingMask::clearBits(const ServoEasingMask & aMask) {
+    SERVO_EASING_DISABLE_INTERRUPTS();
+    for (uint_fast8_t i = 0; i < SERVO_EASING_MASK_WORDS; ++i) {
+        Words[i] &= ~aMask.Words[i];
+    }
+    SERVO_EASING_RESTORE_INTERRUPTS();
+}
+
+/*
+ * Skips all cleared bits of a word at once by count trailing zeros, so the loops over a mask only visit the servos with a set bit.
+ * The mask is read word by word, so a bit cleared by the interrupt during the loop is skipped, if its word was not yet read.
+ */
+uint_fast8_t ServoEasingMask::getNextIndex(uint_fast8_t aStartIndex, const ServoEasingMask * aAndMask) const {
+    uint_fast8_t tWordIndex = aStartIndex / SERVO_EASING_MASK_WORD_BITS;
+    if (tWordIndex >= SERVO_EASING_MASK_WORDS) {
+        return MAX_EASING_SERVOS;
+    }
+    // clear the bits below aStartIndex in the first word
+    ServoEasingMaskWord_t tWord = Words[tWordIndex] & (~((ServoEasingMaskWord_t) 0) << (aStartIndex % SERVO_EASING_MASK_WORD_BITS));
+    while (true) {
+        if (aAndMask != NULL) {
+            tWord &= aAndMask->Words[tWordIndex];
+        }
+        if (tWord != 0) {
+            uint_fast8_t tIndex = (tWordIndex * SERVO_EASING_MASK_WORD_BITS) + __builtin_ctz(tWord);
+            return (tIndex < MAX_EASING_SERVOS) ? tIndex : MAX_EASING_SERVOS;
+        }
+        if (++tWordIndex >= SERVO_EASING_MASK_WORDS) {
+            return MAX_EASING_SERVOS;
+        }
+        tWord = Words[tWordIndex];
+    }
+}
+
+/************************************
+ * ServoEasingEngine functions
+ ***********************************/
+#if defined(ENABLE_SERVO_EASING_ENGINES)
+ServoEasingEngine::ServoEasingEngine(unsigned long (*aMillisFunction)(), void (*aStartUpdateFunction)()) {
+    mMillisFunction = aMillisFunction;
+    mStartUpdateFunction = aStartUpdateFunction;
+#else
+ServoEasingEngine::ServoEasingEngine() {
+#endif
+    mServoArrayMaxIndex = 0;
+    mServoUpdateMask.clearAll();
+    mGroupMoveMask.clearAll();
+#if defined(ENABLE_IDLE_POWER_OFF)
+    mIdlePowerOffIsPending = false;
+#endif
+    // Initially all indexes are free in ascending order, so servos get their index in the order they are attached
+    mServoArrayFreeIndex = 0;
+    for (uint_fast8_t tServoIndex = 0; tServoIndex < MAX_EASING_SERVOS; ++tServoIndex) {
+        mServoArray[tServoIndex] = NULL;
+        mServoNextPositionArray[tServoIndex] = 0;
+        mServoArrayNextFreeIndex[tServoIndex] = tServoIndex + 1;
+    }
+}
+
+/*
+ * Put servo in the first free index of the list
+ * @return the index or INVALID_SERVO if list is full
+ */
+uint_fast8_t ServoEasingEngine::registerServo(ServoEasing * aServoEasingObjectPtr) {
+    uint_fast8_t tServoIndex = mServoArrayFreeIndex;
+    if (tServoIndex >= MAX_EASING_SERVOS) {
+        return INVALID_SERVO;
+    }
+    mServoArrayFreeIndex = mServoArrayNextFreeIndex[tServoIndex];
+    mServoArray[tServoIndex] = aServoEasingObjectPtr;
+    if (tServoIndex > mServoArrayMaxIndex) {
+        mServoArrayMaxIndex = tServoIndex;
+    }
+    return tServoIndex;
+}
+
+void ServoEasingEngine::unregisterServo(uint_fast8_t aServoIndex) {
+    mServoArray[aServoIndex] = NULL;
+    ServoEasingGroup::removeServoIndexFromAllGroups(this, aServoIndex);
+    // Put index in front of the list of free indexes, so it is used by the next attach()
+    mServoArrayNextFreeIndex[aServoIndex] = mServoArrayFreeIndex;
+    mServoArrayFreeIndex = aServoIndex;
+    // If servo with highest index in array was detached, we want to find new mServoArrayMaxIndex
+    while (mServoArray[mServoArrayMaxIndex] == NULL && mServoArrayMaxIndex > 0) {
+        mServoArrayMaxIndex--;
+    }
+}
+
+/*
+ * The default engine uses the ServoEasing timer interrupt, other engines call their start update function.
+ * @param aSkipIfActive - do not restart the ServoEasing timer if it is already running
+ */
+void ServoEasingEngine::startUpdateByInterrupt(bool aSkipIfActive) {
+#if defined(ENABLE_SERVO_EASING_ENGINES)
+    if (!isDefaultEngine()) {
+        if (mStartUpdateFunction != NULL) {
+            mStartUpdateFunction();
+        }
+        return;
+    }
+#endif
+    if (!aSkipIfActive || !sInterruptsAreActive) {
+        enableServoEasingInterrupt();
+    }
+}
+
+
+#ifndef PROVIDE_ONLY_LINEAR_MOVEMENT
+void ServoEasingEngine::setEasingTypeForAllServos(uint_fast8_t aEasingType) {
+    for (uint_fast8_t tServoIndex = 0; tServoIndex <= mServoArrayMaxIndex; ++tServoIndex) {
+        if (mServoArray[tServoIndex] != NULL) {
+            mServoArray[tServoIndex]->mEasingType = aEasingType;
+        }
+    }
+}
+#endif
+
+void ServoEasingEngine::setEaseToForAllServosSynchronizeAndStartInterrupt() {
+    setEaseToForAllServos();
+    synchronizeAllServosAndStartInterrupt();
+}
+
+void ServoEasingEngine::setEaseToForAllServosSynchronizeAndStartInterrupt(uint_fast16_t aDegreesPerSecond) {
+    setEaseToForAllServos(aDegreesPerSecond);
+    synchronizeAllServosAndStartInterrupt();
+}
+
+void ServoEasingEngine::synchronizeAndEaseToArrayPositions() {
+    setEaseToForAllServos();
+    synchronizeAllServosStartAndWaitForAllServosToStop();
+}
+
+void ServoEasingEngine::synchronizeAndEaseToArrayPositions(uint_fast16_t aDegreesPerSecond) {
+    setEaseToForAllServos(aDegreesPerSecond);
+    synchronizeAllServosStartAndWaitForAllServosToStop();
+}
+
+void ServoEasingEngine::printArrayPositions(Print * aSerial) {
+//    uint_fast8_t tServoIndex = 0;
+    aSerial->print(F("ServoNextPositionArray="));
+// AJ 22.05.2019 This does not work with GCC 7.3.0 atmel6.3.1 and -Os
+// It drops the tServoIndex < MAX_EASING_SERVOS condition, since  MAX_EASING_SERVOS is equal to the size of mServoArray
+// This has only an effect if the whole mServoArray is filled up, i.e we have declared MAX_EASING_SERVOS ServoEasing objects.
+//    while (mServoArray[tServoIndex] != NULL && tServoIndex < MAX_EASING_SERVOS) {
+//        aSerial->print(mServoNextPositionArray[tServoIndex]);
+//        aSerial->print(F(" | "));
+//        tServoIndex++;
+//    }
+
+// switching conditions cures the bug
+//    while (tServoIndex < MAX_EASING_SERVOS && mServoArray[tServoIndex] != NULL) {
+
+// this also does not work
+//    for (uint_fast8_t tServoIndex = 0; mServoArray[tServoIndex] != NULL && tServoIndex < MAX_EASING_SERVOS  ; ++tServoIndex) {
+//        aSerial->print(mServoNextPositionArray[tServoIndex]);
+//        aSerial->print(F(" | "));
+//    }
+    for (uint_fast8_t tServoIndex = 0; tServoIndex <= mServoArrayMaxIndex; ++tServoIndex) {
+        aSerial->print(mServoNextPositionArray[tServoIndex]);
+        aSerial->print(F(" | "));
+    }
+    aSerial->println();
+}
+
+void ServoEasingEngine::writeAllServos(int aValue) {
+#if defined(USE_PCA9685_SERVO_EXPANDER) && defined(ENABLE_PCA9685_ALL_LED_WRITE)
+    bool tFlushIsRequired = startPCA9685AllLEDWrite(); // identical values for all 16 channels of an expander are sent with one transfer
+#endif
+    for (uint_fast8_t tServoIndex = 0; tServoIndex <= mServoArrayMaxIndex; ++tServoIndex) {
+        if (mServoArray[tServoIndex] != NULL) {
+            mServoArray[tServoIndex]->write(aValue);
+        }
+    }
+#if defined(USE_PCA9685_SERVO_EXPANDER) && defined(ENABLE_PCA9685_ALL_LED_WRITE)
+    if (tFlushIsRequired) {
+        flushPCA9685Bursts();
+    }
+#endif
+}
+
+void ServoEasingEngine::setSpeedForAllServos(uint_fast16_t aDegreesPerSecond) {
+    for (uint_fast8_t tServoIndex = 0; tServoIndex <= mServoArrayMaxIndex; ++tServoIndex) {
+        if (mServoArray[tServoIndex] != NULL) {
+            mServoArray[tServoIndex]->mSpeed = aDegreesPerSecond;
+        }
+    }
+}
+
+#if defined(ENABLE_IDLE_POWER_OFF)
+void ServoEasingEngine::setIdlePowerOffMillisForAllServos(uint16_t aMillisUntilPowerOff) {
+    for (uint_fast8_t tServoIndex = 0; tServoIndex <= mServoArrayMaxIndex; ++tServoIndex) {
+        if (mServoArray[tServoIndex] != NULL) {
+            mServoArray[tServoIndex]->setIdlePowerOffMillis(aMillisUntilPowerOff);
+        }
+    }
+}
+#endif
+
+#if defined(va_arg)
+/*
+ * Sets the mServoNextPositionArray[] of the first aNumberOfServos to the specified values
+ */
+void ServoEasingEngine::setDegreeForAllServos(uint_fast8_t aNumberOfServos, va_list * aDegreeValues) {
+    for (uint_fast8_t tServoIndex = 0; tServoIndex < aNumberOfServos; ++tServoIndex) {
+        mServoNextPositionArray[tServoIndex] = va_arg(*aDegreeValues, int);
+    }
+}
+#endif
+
+#if defined(va_start)
+/*
+ * Sets the mServoNextPositionArray[] of the first aNumberOfServos to the specified values
+ */
+void ServoEasingEngine::setDegreeForAllServos(uint_fast8_t aNumberOfServos, ...) {
+    va_list aDegreeValues;
+    va_start(aDegreeValues, aNumberOfServos);
+    setDegreeForAllServos(aNumberOfServos, &aDegreeValues);
+    va_end(aDegreeValues);
+}
+#endif
+
+/*
+ * Sets target position using content of mServoNextPositionArray
+ * returns false if one servo was still moving
+ */
+bool ServoEasingEngine::setEaseToForAllServos() {
+    bool tOneServoIsMoving = false;
+    for (uint_fast8_t tServoIndex = 0; tServoIndex <= mServoArrayMaxIndex; ++tServoIndex) {
+        if (mServoArray[tServoIndex] != NULL) {
+            tOneServoIsMoving = mServoArray[tServoIndex]->setEaseTo(mServoNextPositionArray[tServoIndex],
+                    mServoArray[tServoIndex]->mSpeed) || tOneServoIsMoving;
+        }
+    }
+    return tOneServoIsMoving;
+}
+
+bool ServoEasingEngine::setEaseToForAllServos(uint_fast16_t aDegreesPerSecond) {
+    bool tOneServoIsMoving = false;
+    for (uint_fast8_t tServoIndex = 0; tServoIndex <= mServoArrayMaxIndex; ++tServoIndex) {
+        if (mServoArray[tServoIndex] != NULL) {
+            tOneServoIsMoving = mServoArray[tServoIndex]->setEaseTo(mServoNextPositionArray[tServoIndex], aDegreesPerSecond)
+                    || tOneServoIsMoving;
+        }
+    }
+    return tOneServoIsMoving;
+}
+
+bool ServoEasingEngine::setEaseToDForAllServos(uint_fast16_t aMillisForMove) {
+    bool tOneServoIsMoving = false;
+    for (uint_fast8_t tServoIndex = 0; tServoIndex <= mServoArrayMaxIndex; ++tServoIndex) {
+        if (mServoArray[tServoIndex] != NULL) {
+            tOneServoIsMoving = mServoArray[tServoIndex]->setEaseToD(mServoNextPositionArray[tServoIndex], aMillisForMove)
+                    || tOneServoIsMoving;
+        }
+    }
+    return tOneServoIsMoving;
+}
+
+/*
+ * Sets or clears bit for aServoIndex in mServoUpdateMask.
+ * The read modify write is done with interrupts disabled, since bits are set by the main program and cleared by the interrupt.
+ * The interrupt state is restored afterwards, since it is also called by the ISR, e.g. by writeMicrosecondsOrUnitsDirect().
+ */
+void ServoEasingEngine::setServoUpdateMaskBit(uint_fast8_t aServoIndex) {
+    if (aServoIndex < MAX_EASING_SERVOS) {
+        SERVO_EASING_DISABLE_INTERRUPTS();
+        mServoUpdateMask.setBit(aServoIndex);
+        SERVO_EASING_RESTORE_INTERRUPTS();
+    }
+}
+
+void ServoEasingEngine::clearServoUpdateMaskBit(uint_fast8_t aServoIndex) {
+    SERVO_EASING_DISABLE_INTERRUPTS();
+    mServoUpdateMask.clearBit(aServoIndex);
+    SERVO_EASING_RESTORE_INTERRUPTS();
+}
+
+/*
+ * Checks only servos with bit set in mServoUpdateMask
+ */
+bool ServoEasingEngine::isOneServoMoving() {
+    for (uint_fast8_t tServoIndex = mServoUpdateMask.getNextIndex(0); tServoIndex < MAX_EASING_SERVOS;
+            tServoIndex = mServoUpdateMask.getNextIndex(tServoIndex + 1)) {
+        if (mServoArray[tServoIndex] != NULL && mServoArray[tServoIndex]->mServoMoves) {
+            return true;
+        }
+    }
+#if defined(USE_PCA9685_SERVO_EXPANDER)
+    if (isDefaultEngine()) {
+        return isOnePackedServoMoving();
+    }
+#endif
+    return false;
+}
+
+void ServoEasingEngine::stopAllServos() {
+    void disableServoEasingInterrupt();
+    stopGroupMoves();
+    for (uint_fast8_t tServoIndex = mServoUpdateMask.getNextIndex(0); tServoIndex < MAX_EASING_SERVOS;
+            tServoIndex = mServoUpdateMask.getNextIndex(tServoIndex + 1)) {
+        if (mServoArray[tServoIndex] != NULL) {
+            mServoArray[tServoIndex]->mServoMoves = false;
+        }
+    }
+#if defined(USE_PCA9685_SERVO_EXPANDER)
+    if (isDefaultEngine()) {
+        stopAllPackedServos();
+    }
+#endif
+}
+
+/*
+ * Stops and detaches all servos of this engine
+ */
+void ServoEasingEngine::detachAllServos() {
+    stopAllServos();
+#if defined(USE_PCA9685_SERVO_EXPANDER) && defined(ENABLE_PCA9685_ALL_LED_WRITE)
+    bool tFlushIsRequired = startPCA9685AllLEDWrite(); // expanders with all 16 channels detached are switched off with one transfer
+#endif
+    for (uint_fast8_t tServoIndex = 0; tServoIndex <= mServoArrayMaxIndex; ++tServoIndex) {
+        if (mServoArray[tServoIndex] != NULL) {
+            mServoArray[tServoIndex]->detach();
+        }
+    }
+#if defined(USE_PCA9685_SERVO_EXPANDER) && defined(ENABLE_PCA9685_ALL_LED_WRITE)
+    if (tFlushIsRequired) {
+        flushPCA9685Bursts();
+    }
+#endif
+}
+
+/*
+ * returns true if all Servos reached endAngle / stopped
+ */
+bool ServoEasingEngine::updateAllServos() {
+    bool tAllServosStopped = true;
+#if defined(USE_PCA9685_SERVO_EXPANDER) && defined(ENABLE_PCA9685_BURST_WRITE)
+    if (isDefaultEngine()) {
+        sPCA9685BurstIsActive = true; // collect PCA9685 values until flushPCA9685Bursts() below
+    }
+#endif
+    tAllServosStopped = updateGroupMoves();
+#if defined(ENABLE_IDLE_POWER_OFF)
+    bool tIdlePowerOffIsPending = false;
+#endif
+#if defined(PRINT_FOR_SERIAL_PLOTTER)
+    // Serial plotter requires output of all servos
+    for (uint_fast8_t tServoIndex = 0; tServoIndex <= mServoArrayMaxIndex; ++tServoIndex) {
+        if (mServoArray[tServoIndex] != NULL) {
+            tAllServosStopped = mServoArray[tServoIndex]->update() && tAllServosStopped;
+#  if defined(ENABLE_IDLE_POWER_OFF)
+            if (mServoArray[tServoIndex]->checkIdlePowerOff()) {
+                tIdlePowerOffIsPending = true;
+            }
+#  endif
+        }
+    }
+#else
+    /*
+     * Process only servos which were started. Their bit is cleared, if they are found stopped.
+     */
+    for (uint_fast8_t tServoIndex = mServoUpdateMask.getNextIndex(0); tServoIndex < MAX_EASING_SERVOS;
+            tServoIndex = mServoUpdateMask.getNextIndex(tServoIndex + 1)) {
+        ServoEasing * tServoEasingObjectPtr = mServoArray[tServoIndex];
+        if (tServoEasingObjectPtr == NULL) {
+            clearServoUpdateMaskBit(tServoIndex); // was detached
+            continue;
+        }
+        bool tServoStopped = tServoEasingObjectPtr->update();
+        tAllServosStopped = tServoStopped && tAllServosStopped;
+#  if defined(ENABLE_IDLE_POWER_OFF)
+        if (tServoEasingObjectPtr->checkIdlePowerOff()) {
+            tIdlePowerOffIsPending = true;
+            tServoStopped = false; // keep bit set for the next check
+        }
+#  endif
+        if (tServoStopped) {
+            clearServoUpdateMaskBit(tServoIndex);
+        }
+    }
+#endif
+#if defined(ENABLE_IDLE_POWER_OFF)
+    mIdlePowerOffIsPending = tIdlePowerOffIsPending;
+#endif
+#if defined(USE_PCA9685_SERVO_EXPANDER)
+    if (isDefaultEngine()) {
+        tAllServosStopped = updateAllPackedServos() && tAllServosStopped;
+#  if defined(ENABLE_PCA9685_BURST_WRITE)
+        flushPCA9685Bursts();
+#  endif
+    }
+#endif
+#if defined(ENABLE_SERVO_DRIVER_INTERFACE)
+    flushAllServoDrivers();
+#endif
+#if defined(PRINT_FOR_SERIAL_PLOTTER)
+// End of one data set
+    Serial.println();
+#endif
+    return tAllServosStopped;
+}
+
+void ServoEasingEngine::updateAndWaitForAllServosToStop() {
+    do {
+        // First do the delay, then check for update, since we are likely called directly after start and there is nothing to move yet
+        delay(REFRESH_INTERVAL_MILLIS); // 20 ms
+    } while (!updateAllServos());
+}
+
+/*
+ * returns true if all Servos reached endAngle / stopped
+ */
+bool ServoEasingEngine::delayAndUpdateAndWaitForAllServosToStop(unsigned long aMillisDelay, bool aTerminateDelayIfAllServosStopped) {
+    while (true) {
+        // First do the delay, then check for update, since we are likely called directly after start and there is nothing to move yet
+        if (aMillisDelay > REFRESH_INTERVAL_MILLIS) {
+            aMillisDelay -= REFRESH_INTERVAL_MILLIS;
+            delay(REFRESH_INTERVAL_MILLIS); // 20 ms
+            if (updateAllServos() && aTerminateDelayIfAllServosStopped) {
+                // terminate delay here and return
+                return true;
+            }
+        } else {
+            delay(aMillisDelay);
+            return updateAllServos();
+        }
+    }
+}
+
+void ServoEasingEngine::synchronizeAllServosStartAndWaitForAllServosToStop() {
+    synchronizeAllServosAndStartInterrupt(false);
+    updateAndWaitForAllServosToStop();
+}
+
+/*
+ * Take the longer duration in order to move all servos synchronously
+ */
+void ServoEasingEngine::synchronizeAllServosAndStartInterrupt(bool aStartUpdateByInterrupt) {
+    /*
+     * Find maximum duration and one start time
+     */
+    uint_fast16_t tMaxMillisForCompleteMove = 0;
+    uint32_t tMillisAtStartMove = 0;
+
+    for (uint_fast8_t tServoIndex = mServoUpdateMask.getNextIndex(0); tServoIndex < MAX_EASING_SERVOS;
+            tServoIndex = mServoUpdateMask.getNextIndex(tServoIndex + 1)) {
+        if (mServoArray[tServoIndex] != NULL && mServoArray[tServoIndex]->mServoMoves) {
+            //process servos which really moves
+            tMillisAtStartMove = mServoArray[tServoIndex]->mMillisAtStartMove;
+            if (mServoArray[tServoIndex]->mMillisForCompleteMove > tMaxMillisForCompleteMove) {
+                tMaxMillisForCompleteMove = mServoArray[tServoIndex]->mMillisForCompleteMove;
+            }
+        }
+    }
+#if defined(USE_PCA9685_SERVO_EXPANDER)
+    /*
+     * Packed servos of the default engine store only the lower 16 bit of the start time.
+     * Their start time is used, if no other servo moves.
+     */
+    bool tSynchronizePackedServos = isDefaultEngine();
+    if (tSynchronizePackedServos) {
+        for (uint_fast8_t tServoIndex = 0; tServoIndex < sNumberOfPackedServos; ++tServoIndex) {
+            ServoEasingPacked * tPackedServo = &sPackedServoArray[tServoIndex];
+            if (tPackedServo->mServoMoves) {
+                if (tMaxMillisForCompleteMove == 0) {
+                    tMillisAtStartMove = tPackedServo->mMillisAtStartMove;
+                }
+                if (tPackedServo->mMillisForCompleteMove > tMaxMillisForCompleteMove) {
+                    tMaxMillisForCompleteMove = tPackedServo->mMillisForCompleteMove;
+                }
+            }
+        }
+    }
+#endif
+
+#if defined(TRACE)
+    Serial.print(F("Number of servos="));
+    Serial.print(mServoArrayMaxIndex);
+    Serial.print(F(" MillisAtStartMove="));
+    Serial.print(tMillisAtStartMove);
+    Serial.print(F(" MaxMillisForCompleteMove="));
+    Serial.println(tMaxMillisForCompleteMove);
+#endif
+
+    /*
+     * Set maximum duration and start time to all servos
+     * Synchronize start time to avoid race conditions at the end of movement
+     */
+    for (uint_fast8_t tServoIndex = mServoUpdateMask.getNextIndex(0); tServoIndex < MAX_EASING_SERVOS;
+            tServoIndex = mServoUpdateMask.getNextIndex(tServoIndex + 1)) {
+        if (mServoArray[tServoIndex] != NULL && mServoArray[tServoIndex]->mServoMoves) {
+            mServoArray[tServoIndex]->mMillisAtStartMove = tMillisAtStartMove;
+            mServoArray[tServoIndex]->mMillisForCompleteMove = tMaxMillisForCompleteMove;
+        }
+    }
+#if defined(USE_PCA9685_SERVO_EXPANDER)
+    if (tSynchronizePackedServos) {
+        for (uint_fast8_t tServoIndex = 0; tServoIndex < sNumberOfPackedServos; ++tServoIndex) {
+            ServoEasingPacked * tPackedServo = &sPackedServoArray[tServoIndex];
+            if (tPackedServo->mServoMoves) {
+                tPackedServo->mMillisAtStartMove = tMillisAtStartMove;
+                tPackedServo->mMillisForCompleteMove = tMaxMillisForCompleteMove;
+            }
+        }
+    }
+#endif
+
+    if (aStartUpdateByInterrupt) {
+        startUpdateByInterrupt();
+    }
+}
+
+/*
+ * Common part of startEaseToArrayPositions() and startEaseToArrayPositions_P()
+ * The first loop does all the conversions and computes the maximum duration,
+ * the second one only sets the common start time and duration and starts the servos.
+ * This ensures that the interrupt never sees a servo with a not yet synchronized duration.
+ * @return false if one servo was still moving
+ */
+bool ServoEasingEngine::startEaseToArrayPositions(const int * aDegreeArray, bool aDegreeArrayIsInProgmem, uint_fast8_t aNumberOfServos,
+        const uint16_t * aDegreesPerSecondArray, const uint8_t * aEasingTypeArray, bool aStartUpdateByInterrupt) {
+    bool tNoServoWasMoving = true;
+    uint_fast16_t tMaxMillisForCompleteMove = 0;
+
+    if (aNumberOfServos > mServoArrayMaxIndex + 1) {
+        aNumberOfServos = mServoArrayMaxIndex + 1;
+    }
+
+    for (uint_fast8_t tServoIndex = 0; tServoIndex < aNumberOfServos; ++tServoIndex) {
+        int tDegree;
+#if defined(__AVR__)
+        if (aDegreeArrayIsInProgmem) {
+            tDegree = (int) pgm_read_word(&aDegreeArray[tServoIndex]);
+        } else {
+            tDegree = aDegreeArray[tServoIndex];
+        }
+#else
+        (void) aDegreeArrayIsInProgmem; // PROGMEM data can be accessed directly
+        tDegree = aDegreeArray[tServoIndex];
+#endif
+        mServoNextPositionArray[tServoIndex] = tDegree;
+
+        ServoEasing * tServoEasingObjectPtr = mServoArray[tServoIndex];
+        if (tServoEasingObjectPtr == NULL) {
+            continue;
+        }
+        if (tServoEasingObjectPtr->mServoMoves) {
+            tNoServoWasMoving = false;
+            // stop it, to avoid that the interrupt uses a partially modified move
+            tServoEasingObjectPtr->mServoMoves = false;
+        }
+#if defined(ENABLE_WRITE_TARGET_TRACKING)
+        tServoEasingObjectPtr->mIsTrackingTarget = false;
+#endif
+#if defined(ENABLE_VELOCITY_MODE)
+        tServoEasingObjectPtr->mIsVelocityMove = false;
+#endif
+#ifndef PROVIDE_ONLY_LINEAR_MOVEMENT
+        if (aEasingTypeArray != NULL) {
+            tServoEasingObjectPtr->mEasingType = aEasingTypeArray[tServoIndex];
+        }
+#else
+        (void) aEasingTypeArray;
+#endif
+        uint_fast16_t tDegreesPerSecond = tServoEasingObjectPtr->mSpeed;
+        if (aDegreesPerSecondArray != NULL) {
+            tDegreesPerSecond = aDegreesPerSecondArray[tServoIndex];
+        }
+        if (tDegreesPerSecond == 0) {
+            tDegreesPerSecond = 1;
+        }
+
+        int tCurrentMicrosecondsOrUnits = tServoEasingObjectPtr->mCurrentMicrosecondsOrUnits;
+        int tEndMicrosecondsOrUnits = tServoEasingObjectPtr->DegreeToMicrosecondsOrUnits(tDegree);
+        tServoEasingObjectPtr->mStartMicrosecondsOrUnits = tCurrentMicrosecondsOrUnits;
+        tServoEasingObjectPtr->mEndMicrosecondsOrUnits = tEndMicrosecondsOrUnits;
+        tServoEasingObjectPtr->mDeltaMicrosecondsOrUnits = tEndMicrosecondsOrUnits - tCurrentMicrosecondsOrUnits;
+        if (tServoEasingObjectPtr->mDeltaMicrosecondsOrUnits == 0) {
+            // no effective movement
+            continue;
+        }
+
+        uint_fast16_t tMillisForCompleteMove = abs(tDegree - tServoEasingObjectPtr->MicrosecondsOrUnitsToDegree(tCurrentMicrosecondsOrUnits))
+                * 1000L / tDegreesPerSecond;
+#ifndef PROVIDE_ONLY_LINEAR_MOVEMENT
+        if ((tServoEasingObjectPtr->mEasingType & CALL_STYLE_MASK) == CALL_STYLE_BOUNCING_OUT_IN) {
+            // bouncing has double movement, so take double time and has same end position as start position
+            tMillisForCompleteMove *= 2;
+            tServoEasingObjectPtr->mEndMicrosecondsOrUnits = tCurrentMicrosecondsOrUnits;
+        }
+#endif
+        if (tMillisForCompleteMove > tMaxMillisForCompleteMove) {
+            tMaxMillisForCompleteMove = tMillisForCompleteMove;
+        }
+    }
+
+    /*
+     * Set common start time and maximum duration and start all servos with an effective movement
+     */
+    uint32_t tMillisAtStartMove = getMillis();
+    bool tOneServoMoves = false;
+    for (uint_fast8_t tServoIndex = 0; tServoIndex < aNumberOfServos; ++tServoIndex) {
+        ServoEasing * tServoEasingObjectPtr = mServoArray[tServoIndex];
+        if (tServoEasingObjectPtr != NULL && tServoEasingObjectPtr->mDeltaMicrosecondsOrUnits != 0) {
+            tServoEasingObjectPtr->mMillisAtStartMove = tMillisAtStartMove;
+            tServoEasingObjectPtr->mMillisForCompleteMove = tMaxMillisForCompleteMove;
+            tServoEasingObjectPtr->mServoMoves = true;
+            setServoUpdateMaskBit(tServoIndex);
+            tOneServoMoves = true;
+        }
+    }
+
+#if defined(TRACE)
+    Serial.print(F("Number of servos="));
+    Serial.print(aNumberOfServos);
+    Serial.print(F(" MaxMillisForCompleteMove="));
+    Serial.println(tMaxMillisForCompleteMove);
+#endif
+
+    if (tOneServoMoves && aStartUpdateByInterrupt) {
+        startUpdateByInterrupt();
+    }
+    return tNoServoWasMoving;
+}
+
+/**
+ * Sets target positions, speeds and easing types for the first aNumberOfServos servos,
+ * synchronizes them and starts the interrupt, without the need of filling mServoNextPositionArray[] with setDegreeForAllServos().
+ * mServoNextPositionArray[] is updated with the new values.
+ * @param aDegreesPerSecondArray if NULL, the speed of each servo set by setSpeed() is taken
+ * @param aEasingTypeArray if NULL, the easing type of each servo set by setEasingType() is taken
+ * @return false if one servo was still moving
+ */
+bool ServoEasingEngine::startEaseToArrayPositions(const int * aDegreeArray, uint_fast8_t aNumberOfServos, const uint16_t * aDegreesPerSecondArray,
+        const uint8_t * aEasingTypeArray, bool aStartUpdateByInterrupt) {
+    return startEaseToArrayPositions(aDegreeArray, false, aNumberOfServos, aDegreesPerSecondArray, aEasingTypeArray,
+            aStartUpdateByInterrupt);
+}
+
+/**
+ * Like startEaseToArrayPositions(), but the degree values are read from program memory e.g.
+ * static const int sMyPosition[] PROGMEM = { 90, 45, 180 };
+ * The speed and easing type arrays are still read from RAM.
+ */
+bool ServoEasingEngine::startEaseToArrayPositions_P(const int * aDegreeArrayPGM, uint_fast8_t aNumberOfServos, const uint16_t * aDegreesPerSecondArray,
+        const uint8_t * aEasingTypeArray, bool aStartUpdateByInterrupt) {
+    return startEaseToArrayPositions(aDegreeArrayPGM, true, aNumberOfServos, aDegreesPerSecondArray, aEasingTypeArray,
+            aStartUpdateByInterrupt);
+}
+
+/************************************
+ * ServoEasing list functions for the default engine
+ ***********************************/
+#ifndef PROVIDE_ONLY_LINEAR_MOVEMENT
+void setEasingTypeForAllServos(uint_fast8_t aEasingType) {
+    sServoEasingDefaultEngine.setEasingTypeForAllServos(aEasingType);
+}
+#endif
+
+void setEaseToForAllServosSynchronizeAndStartInterrupt() {
+    sServoEasingDefaultEngine.setEaseToForAllServosSynchronizeAndStartInterrupt();
+}
+
+void setEaseToForAllServosSynchronizeAndStartInterrupt(uint_fast16_t aDegreesPerSecond) {
+    sServoEasingDefaultEngine.setEaseToForAllServosSynchronizeAndStartInterrupt(aDegreesPerSecond);
+}
+
+void synchronizeAndEaseToArrayPositions() {
+    sServoEasingDefaultEngine.synchronizeAndEaseToArrayPositions();
+}
+
+void synchronizeAndEaseToArrayPositions(uint_fast16_t aDegreesPerSecond) {
+    sServoEasingDefaultEngine.synchronizeAndEaseToArrayPositions(aDegreesPerSecond);
+}
+
+void printArrayPositions(Print * aSerial) {
+    sServoEasingDefaultEngine.printArrayPositions(aSerial);
+}
+
+void writeAllServos(int aValue) {
+    sServoEasingDefaultEngine.writeAllServos(aValue);
+}
+
+void setSpeedForAllServos(uint_fast16_t aDegreesPerSecond) {
+    sServoEasingDefaultEngine.setSpeedForAllServos(aDegreesPerSecond);
+}
+
+#if defined(ENABLE_IDLE_POWER_OFF)
+void setIdlePowerOffMillisForAllServos(uint16_t aMillisUntilPowerOff) {
+    sServoEasingDefaultEngine.setIdlePowerOffMillisForAllServos(aMillisUntilPowerOff);
+}
+#endif
+
+#if defined(va_arg)
+void setDegreeForAllServos(uint_fast8_t aNumberOfServos, va_list * aDegreeValues) {
+    sServoEasingDefaultEngine.setDegreeForAllServos(aNumberOfServos, aDegreeValues);
+}
+#endif
+
+#if defined(va_start)
+void setDegreeForAllServos(uint_fast8_t aNumberOfServos, ...) {
+    va_list aDegreeValues;
+    va_start(aDegreeValues, aNumberOfServos);
+    sServoEasingDefaultEngine.setDegreeForAllServos(aNumberOfServos, &aDegreeValues);
+    va_end(aDegreeValues);
+}
+#endif
+
+bool setEaseToForAllServos() {
+    return sServoEasingDefaultEngine.setEaseToForAllServos();
+}
+
+bool setEaseToForAllServos(uint_fast16_t aDegreesPerSecond) {
+    return sServoEasingDefaultEngine.setEaseToForAllServos(aDegreesPerSecond);
+}
+
+bool setEaseToDForAllServos(uint_fast16_t aMillisForMove) {
+    return sServoEasingDefaultEngine.setEaseToDForAllServos(aMillisForMove);
+}
+
+bool isOneServoMoving() {
+    return sServoEasingDefaultEngine.isOneServoMoving();
+}
+
+void stopAllServos() {
+    sServoEasingDefaultEngine.stopAllServos();
+}
+
+void detachAllServos() {
+    sServoEasingDefaultEngine.detachAllServos();
+}
+
+bool updateAllServos() {
+    return sServoEasingDefaultEngine.updateAllServos();
+}
+
+void updateAndWaitForAllServosToStop() {
+    sServoEasingDefaultEngine.updateAndWaitForAllServosToStop();
+}
+
+bool delayAndUpdateAndWaitForAllServosToStop(unsigned long aMillisDelay, bool aTerminateDelayIfAllServosStopped) {
+    return sServoEasingDefaultEngine.delayAndUpdateAndWaitForAllServosToStop(aMillisDelay, aTerminateDelayIfAllServosStopped);
+}
+
+void synchronizeAllServosStartAndWaitForAllServosToStop() {
+    sServoEasingDefaultEngine.synchronizeAllServosStartAndWaitForAllServosToStop();
+}
+
+void synchronizeAllServosAndStartInterrupt(bool aStartUpdateByInterrupt) {
+    sServoEasingDefaultEngine.synchronizeAllServosAndStartInterrupt(aStartUpdateByInterrupt);
+}
+
+bool startEaseToArrayPositions(const int * aDegreeArray, uint_fast8_t aNumberOfServos, const uint16_t * aDegreesPerSecondArray,
+        const uint8_t * aEasingTypeArray, bool aStartUpdateByInterrupt) {
+    return sServoEasingDefaultEngine.startEaseToArrayPositions(aDegreeArray, false, aNumberOfServos, aDegreesPerSecondArray,
+            aEasingTypeArray, aStartUpdateByInterrupt);
+}
+
+bool startEaseToArrayPositions_P(const int * aDegreeArrayPGM, uint_fast8_t aNumberOfServos, const uint16_t * aDegreesPerSecondArray,
+        const uint8_t * aEasingTypeArray, bool aStartUpdateByInterrupt) {
+    return sServoEasingDefaultEngine.startEaseToArrayPositions(aDegreeArrayPGM, true, aNumberOfServos, aDegreesPerSecondArray,
+            aEasingTypeArray, aStartUpdateByInterrupt);
+}
+
+/************************************
+ * ServoEasingGroup functions
+ * Only servos with a bit set in mServoMask are processed
+ ***********************************/
+ServoEasingGroup * sServoEasingGroupList = NULL; // last constructed group
+
+ServoEasingGroup::ServoEasingGroup() {
+    mServoMask.clearAll();
+#if defined(ENABLE_SERVO_EASING_ENGINES)
+    mEngine = &sServoEasingDefaultEngine;
+#endif
+    mGroupMoveFunction = NULL;
+    mNextGroup = sServoEasingGroupList;
+    sServoEasingGroupList = this;
+}
+
+ServoEasingGroup::~ServoEasingGroup() {
+    stopGroupMove();
+    ServoEasingGroup ** tGroupPointer = &sServoEasingGroupList;
+    while (*tGroupPointer != NULL) {
+        if (*tGroupPointer == this) {
+            *tGroupPointer = mNextGroup;
+            break;
+        }
+        tGroupPointer = &(*tGroupPointer)->mNextGroup;
+    }
+}
+
+/*
+ * The index of a detached servo is reused by the next attach(), so the new servo must not become a member of the old groups
+ */
+void ServoEasingGroup::removeServoIndexFromAllGroups(ServoEasingEngine * aEngine, uint_fast8_t aServoIndex) {
+    for (ServoEasingGroup * tGroup = sServoEasingGroupList; tGroup != NULL; tGroup = tGroup->mNextGroup) {
+        if (SERVO_ENGINE(tGroup) == aEngine) {
+            tGroup->mServoMask.clearBit(aServoIndex);
+        }
+    }
+    aEngine->mGroupMoveMask.clearBit(aServoIndex);
+}
+
+/*
+ * @return false if servo is not attached or belongs to another engine than the servos already in the group
+ */
+bool ServoEasingGroup::addServo(ServoEasing * aServoEasingObjectPtr) {
+    if (aServoEasingObjectPtr->mServoIndex == INVALID_SERVO) {
+        return false;
+    }
+#if defined(ENABLE_SERVO_EASING_ENGINES)
+    if (mServoMask.isEmpty()) {
+        mEngine = aServoEasingObjectPtr->mEngine;
+    } else if (mEngine != aServoEasingObjectPtr->mEngine) {
+        return false;
+    }
+#endif
+    mServoMask.setBit(aServoEasingObjectPtr->mServoIndex);
+    return true;
+}
+
+void ServoEasingGroup::removeServo(ServoEasing * aServoEasingObjectPtr) {
+    if (isMember(aServoEasingObjectPtr)) {
+        mServoMask.clearBit(aServoEasingObjectPtr->mServoIndex);
+    }
+}
+
+bool ServoEasingGroup::isMember(ServoEasing * aServoEasingObjectPtr) {
+    uint_fast8_t tServoIndex = aServoEasingObjectPtr->mServoIndex;
+    return tServoIndex != INVALID_SERVO && SERVO_ENGINE(this) == SERVO_ENGINE(aServoEasingObjectPtr)
+            && mServoMask.isBitSet(tServoIndex);
+}
+
+#ifndef PROVIDE_ONLY_LINEAR_MOVEMENT
+void ServoEasingGroup::setEasingTypeForAllServos(uint_fast8_t aEasingType) {
+    ServoEasing ** tServoArray = SERVO_ENGINE(this)->mServoArray;
+    for (uint_fast8_t tServoIndex = mServoMask.getNextIndex(0); tServoIndex < MAX_EASING_SERVOS;
+            tServoIndex = mServoMask.getNextIndex(tServoIndex + 1)) {
+        if (tServoArray[tServoIndex] != NULL) {
+            tServoArray[tServoIndex]->mEasingType = aEasingType;
+        }
+    }
+}
+#endif
+
+void ServoEasingGroup::setEaseToForAllServosSynchronizeAndStartInterrupt() {
+    setEaseToForAllServos();
+    synchronizeAllServosAndStartInterrupt();
+}
+
+void ServoEasingGroup::setEaseToForAllServosSynchronizeAndStartInterrupt(uint_fast16_t aDegreesPerSecond) {
+    setEaseToForAllServos(aDegreesPerSecond);
+    synchronizeAllServosAndStartInterrupt();
+}
+
+void ServoEasingGroup::synchronizeAndEaseToArrayPositions() {
+    setEaseToForAllServos();
+    synchronizeAllServosStartAndWaitForAllServosToStop();
+}
+
+void ServoEasingGroup::synchronizeAndEaseToArrayPositions(uint_fast16_t aDegreesPerSecond) {
+    setEaseToForAllServos(aDegreesPerSecond);
+    synchronizeAllServosStartAndWaitForAllServosToStop();
+}
+
+void ServoEasingGroup::printArrayPositions(Print * aSerial) {
+    int * tServoNextPositionArray = SERVO_ENGINE(this)->mServoNextPositionArray;
+    aSerial->print(F("ServoNextPositionArray="));
+    for (uint_fast8_t tServoIndex = mServoMask.getNextIndex(0); tServoIndex < MAX_EASING_SERVOS;
+            tServoIndex = mServoMask.getNextIndex(tServoIndex + 1)) {
+        aSerial->print(tServoNextPositionArray[tServoIndex]);
+        aSerial->print(F(" | "));
+    }
+    aSerial->println();
+}
+
+void ServoEasingGroup::writeAllServos(int aValue) {
+#if defined(USE_PCA9685_SERVO_EXPANDER) && defined(ENABLE_PCA9685_ALL_LED_WRITE)
+    bool tFlushIsRequired = startPCA9685AllLEDWrite();
+#endif
+    ServoEasing ** tServoArray = SERVO_ENGINE(this)->mServoArray;
+    for (uint_fast8_t tServoIndex = mServoMask.getNextIndex(0); tServoIndex < MAX_EASING_SERVOS;
+            tServoIndex = mServoMask.getNextIndex(tServoIndex + 1)) {
+        if (tServoArray[tServoIndex] != NULL) {
+            tServoArray[tServoIndex]->write(aValue);
+        }
+    }
+#if defined(USE_PCA9685_SERVO_EXPANDER) && defined(ENABLE_PCA9685_ALL_LED_WRITE)
+    if (tFlushIsRequired) {
+        flushPCA9685Bursts();
+    }
+#endif
+}
+
+void ServoEasingGroup::setSpeedForAllServos(uint_fast16_t aDegreesPerSecond) {
+    ServoEasing ** tServoArray = SERVO_ENGINE(this)->mServoArray;
+    for (uint_fast8_t tServoIndex = mServoMask.getNextIndex(0); tServoIndex < MAX_EASING_SERVOS;
+            tServoIndex = mServoMask.getNextIndex(tServoIndex + 1)) {
+        if (tServoArray[tServoIndex] != NULL) {
+            tServoArray[tServoIndex]->mSpeed = aDegreesPerSecond;
+        }
+    }
+}
+
+#if defined(ENABLE_IDLE_POWER_OFF)
+void ServoEasingGroup::setIdlePowerOffMillisForAllServos(uint16_t aMillisUntilPowerOff) {
+    ServoEasing ** tServoArray = SERVO_ENGINE(this)->mServoArray;
+    for (uint_fast8_t tServoIndex = mServoMask.getNextIndex(0); tServoIndex < MAX_EASING_SERVOS;
+            tServoIndex = mServoMask.getNextIndex(tServoIndex + 1)) {
+        if (tServoArray[tServoIndex] != NULL) {
+            tServoArray[tServoIndex]->setIdlePowerOffMillis(aMillisUntilPowerOff);
+        }
+    }
+}
+#endif
+
+#if defined(va_arg)
+/*
+ * Sets the next positions of the first aNumberOfServos servos of the group to the specified values
+ */
+void ServoEasingGroup::setDegreeForAllServos(uint_fast8_t aNumberOfServos, va_list * aDegreeValues) {
+    int * tServoNextPositionArray = SERVO_ENGINE(this)->mServoNextPositionArray;
+    for (uint_fast8_t tServoIndex = mServoMask.getNextIndex(0); tServoIndex < MAX_EASING_SERVOS && aNumberOfServos > 0;
+            tServoIndex = mServoMask.getNextIndex(tServoIndex + 1)) {
+        tServoNextPositionArray[tServoIndex] = va_arg(*aDegreeValues, int);
+        aNumberOfServos--;
+    }
+}
+#endif
+
+#if defined(va_start)
+void ServoEasingGroup::setDegreeForAllServos(uint_fast8_t aNumberOfServos, ...) {
+    va_list aDegreeValues;
+    va_start(aDegreeValues, aNumberOfServos);
+    setDegreeForAllServos(aNumberOfServos, &aDegreeValues);
+    va_end(aDegreeValues);
+}
+#endif
+
+/*
+ * Sets target position using the next positions of the engine
+ * returns false if one servo was still moving
+ */
+bool ServoEasingGroup::setEaseToForAllServos() {
+    ServoEasingEngine * tEngine = SERVO_ENGINE(this);
+    bool tOneServoIsMoving = false;
+    for (uint_fast8_t tServoIndex = mServoMask.getNextIndex(0); tServoIndex < MAX_EASING_SERVOS;
+            tServoIndex = mServoMask.getNextIndex(tServoIndex + 1)) {
+        ServoEasing * tServoEasingObjectPtr = tEngine->mServoArray[tServoIndex];
+        if (tServoEasingObjectPtr != NULL) {
+            tOneServoIsMoving = tServoEasingObjectPtr->setEaseTo(tEngine->mServoNextPositionArray[tServoIndex],
+                    tServoEasingObjectPtr->mSpeed) || tOneServoIsMoving;
+        }
+    }
+    return tOneServoIsMoving;
+}
+
+bool ServoEasingGroup::setEaseToForAllServos(uint_fast16_t aDegreesPerSecond) {
+    ServoEasingEngine * tEngine = SERVO_ENGINE(this);
+    bool tOneServoIsMoving = false;
+    for (uint_fast8_t tServoIndex = mServoMask.getNextIndex(0); tServoIndex < MAX_EASING_SERVOS;
+            tServoIndex = mServoMask.getNextIndex(tServoIndex + 1)) {
+        ServoEasing * tServoEasingObjectPtr = tEngine->mServoArray[tServoIndex];
+        if (tServoEasingObjectPtr != NULL) {
+            tOneServoIsMoving = tServoEasingObjectPtr->setEaseTo(tEngine->mServoNextPositionArray[tServoIndex], aDegreesPerSecond)
+                    || tOneServoIsMoving;
+        }
+    }
+    return tOneServoIsMoving;
+}
+
+bool ServoEasingGroup::setEaseToDForAllServos(uint_fast16_t aMillisForMove) {
+    ServoEasingEngine * tEngine = SERVO_ENGINE(this);
+    bool tOneServoIsMoving = false;
+    for (uint_fast8_t tServoIndex = mServoMask.getNextIndex(0); tServoIndex < MAX_EASING_SERVOS;
+            tServoIndex = mServoMask.getNextIndex(tServoIndex + 1)) {
+        ServoEasing * tServoEasingObjectPtr = tEngine->mServoArray[tServoIndex];
+        if (tServoEasingObjectPtr != NULL) {
+            tOneServoIsMoving = tServoEasingObjectPtr->setEaseToD(tEngine->mServoNextPositionArray[tServoIndex], aMillisForMove)
+                    || tOneServoIsMoving;
+        }
+    }
+    return tOneServoIsMoving;
+}
+
+/*
+ * Checks only servos of the group, which were started
+ */
+bool ServoEasingGroup::isOneServoMoving() {
+    ServoEasingEngine * tEngine = SERVO_ENGINE(this);
+    for (uint_fast8_t tServoIndex = mServoMask.getNextIndex(0, &tEngine->mServoUpdateMask); tServoIndex < MAX_EASING_SERVOS;
+            tServoIndex = mServoMask.getNextIndex(tServoIndex + 1, &tEngine->mServoUpdateMask)) {
+        ServoEasing * tServoEasingObjectPtr = tEngine->mServoArray[tServoIndex];
+        if (tServoEasingObjectPtr != NULL && tServoEasingObjectPtr->mServoMoves) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ServoEasingGroup::stopAllServos() {
+    ServoEasingEngine * tEngine = SERVO_ENGINE(this);
+    for (uint_fast8_t tServoIndex = mServoMask.getNextIndex(0, &tEngine->mServoUpdateMask); tServoIndex < MAX_EASING_SERVOS;
+            tServoIndex = mServoMask.getNextIndex(tServoIndex + 1, &tEngine->mServoUpdateMask)) {
+        if (tEngine->mServoArray[tServoIndex] != NULL) {
+            tEngine->mServoArray[tServoIndex]->mServoMoves = false;
+        }
+    }
+}
+
+/*
+ * Stops and detaches all servos of the group. The group is empty afterwards, since the indexes of the servos are freed.
+ */
+void ServoEasingGroup::detachAllServos() {
+    stopAllServos();
+#if defined(USE_PCA9685_SERVO_EXPANDER) && defined(ENABLE_PCA9685_ALL_LED_WRITE)
+    bool tFlushIsRequired = startPCA9685AllLEDWrite();
+#endif
+    ServoEasing ** tServoArray = SERVO_ENGINE(this)->mServoArray;
+    for (uint_fast8_t tServoIndex = mServoMask.getNextIndex(0); tServoIndex < MAX_EASING_SERVOS;
+            tServoIndex = mServoMask.getNextIndex(tServoIndex + 1)) {
+        if (tServoArray[tServoIndex] != NULL) {
+            tServoArray[tServoIndex]->detach();
+        }
+    }
+    mServoMask.clearAll();
+#if defined(USE_PCA9685_SERVO_EXPANDER) && defined(ENABLE_PCA9685_ALL_LED_WRITE)
+    if (tFlushIsRequired) {
+        flushPCA9685Bursts();
+    }
+#endif
+}
+
+/*
+ * Updates only the started servos of the group. Not required if the servos are updated by interrupt.
+ * returns true if all servos of the group reached endAngle / stopped
+ */
+bool ServoEasingGroup::updateAllServos() {
+    ServoEasingEngine * tEngine = SERVO_ENGINE(this);
+    bool tAllServosStopped = true;
+    for (uint_fast8_t tServoIndex = mServoMask.getNextIndex(0, &tEngine->mServoUpdateMask); tServoIndex < MAX_EASING_SERVOS;
+            tServoIndex = mServoMask.getNextIndex(tServoIndex + 1, &tEngine->mServoUpdateMask)) {
+        ServoEasing * tServoEasingObjectPtr = tEngine->mServoArray[tServoIndex];
+        if (tServoEasingObjectPtr == NULL) {
+            tEngine->clearServoUpdateMaskBit(tServoIndex); // was detached
+            continue;
+        }
+        bool tServoStopped = tServoEasingObjectPtr->update();
+        tAllServosStopped = tServoStopped && tAllServosStopped;
+#if defined(ENABLE_IDLE_POWER_OFF)
+        if (tServoEasingObjectPtr->checkIdlePowerOff()) {
+            tServoStopped = false; // keep bit set for the next check
+        }
+#endif
+        if (tServoStopped) {
+            tEngine->clearServoUpdateMaskBit(tServoIndex);
+        }
+    }
+#if defined(ENABLE_SERVO_DRIVER_INTERFACE)
+    flushAllServoDrivers();
+#endif
+    return tAllServosStopped;
+}
+
+void ServoEasingGroup::updateAndWaitForAllServosToStop() {
+    do {
+        // First do the delay, then check for update, since we are likely called directly after start and there is nothing to move yet
+        delay(REFRESH_INTERVAL_MILLIS); // 20 ms
+    } while (!updateAllServos());
+}
+
+/*
+ * returns true if all servos of the group reached endAngle / stopped
+ */
+bool ServoEasingGroup::delayAndUpdateAndWaitForAllServosToStop(unsigned long aMillisDelay, bool aTerminateDelayIfAllServosStopped) {
+    while (true) {
+        if (aMillisDelay > REFRESH_INTERVAL_MILLIS) {
+            aMillisDelay -= REFRESH_INTERVAL_MILLIS;
+            delay(REFRESH_INTERVAL_MILLIS); // 20 ms
+            if (updateAllServos() && aTerminateDelayIfAllServosStopped) {
+                return true;
+            }
+        } else {
+            delay(aMillisDelay);
+            return updateAllServos();
+        }
+    }
+}
+
+void ServoEasingGroup::synchronizeAllServosStartAndWaitForAllServosToStop() {
+    synchronizeAllServosAndStartInterrupt(false);
+    updateAndWaitForAllServosToStop();
+}
+
+/*
+ * Take the longest duration of the group in order to move all servos of the group synchronously
+ */
+void ServoEasingGroup::synchronizeAllServosAndStartInterrupt(bool aStartUpdateByInterrupt) {
+    ServoEasingEngine * tEngine = SERVO_ENGINE(this);
+    uint_fast16_t tMaxMillisForCompleteMove = 0;
+    uint32_t tMillisAtStartMove = 0;
+
+    for (uint_fast8_t tServoIndex = mServoMask.getNextIndex(0, &tEngine->mServoUpdateMask); tServoIndex < MAX_EASING_SERVOS;
+            tServoIndex = mServoMask.getNextIndex(tServoIndex + 1, &tEngine->mServoUpdateMask)) {
+        ServoEasing * tServoEasingObjectPtr = tEngine->mServoArray[tServoIndex];
+        if (tServoEasingObjectPtr != NULL && tServoEasingObjectPtr->mServoMoves) {
+            tMillisAtStartMove = tServoEasingObjectPtr->mMillisAtStartMove;
+            if (tServoEasingObjectPtr->mMillisForCompleteMove > tMaxMillisForCompleteMove) {
+                tMaxMillisForCompleteMove = tServoEasingObjectPtr->mMillisForCompleteMove;
+            }
+        }
+    }
+
+    for (uint_fast8_t tServoIndex = mServoMask.getNextIndex(0, &tEngine->mServoUpdateMask); tServoIndex < MAX_EASING_SERVOS;
+            tServoIndex = mServoMask.getNextIndex(tServoIndex + 1, &tEngine->mServoUpdateMask)) {
+        ServoEasing * tServoEasingObjectPtr = tEngine->mServoArray[tServoIndex];
+        if (tServoEasingObjectPtr != NULL && tServoEasingObjectPtr->mServoMoves) {
+            tServoEasingObjectPtr->mMillisAtStartMove = tMillisAtStartMove;
+            tServoEasingObjectPtr->mMillisForCompleteMove = tMaxMillisForCompleteMove;
+        }
+    }
+
+    if (aStartUpdateByInterrupt) {
+        tEngine->startUpdateByInterrupt();
+    }
+}
+
+/**
+ * Starts a coupled move of all servos of the group.
+ * aGroupMoveFunction is called exactly once per update and computes the angles of all servos of the group,
+ * e.g. by one inverse kinematics computation. aDegreeArray[0] is the servo with the lowest index.
+ * A running move of a servo of the group and a group move of another group with common servos are stopped.
+ * @param aUserDataPointer passed to each call of aGroupMoveFunction
+ * @return false if parameters are invalid
+ */
+bool ServoEasingGroup::startGroupMoveD(ServoEasingGroupMoveFunction aGroupMoveFunction, uint_fast16_t aMillisForMove,
+        void * aUserDataPointer, bool aStartUpdateByInterrupt) {
+    if (aGroupMoveFunction == NULL || mServoMask.isEmpty()) {
+#if defined(DEBUG)
+        Serial.println(F("Error: invalid group"));
+#endif
+        return false;
+    }
+    ServoEasingEngine * tEngine = SERVO_ENGINE(this);
+    stopGroupMove(); // stop a running group move before changing its parameters
+    for (ServoEasingGroup * tGroup = sServoEasingGroupList; tGroup != NULL; tGroup = tGroup->mNextGroup) {
+        if (tGroup->mGroupMoveFunction != NULL && SERVO_ENGINE(tGroup) == tEngine && tGroup->mServoMask.intersects(mServoMask)) {
+            tGroup->stopGroupMove(); // a servo can only be moved by one group
+        }
+    }
+
+    uint_fast8_t tNumberOfServos = 0;
+    for (uint_fast8_t tServoIndex = mServoMask.getNextIndex(0); tServoIndex < MAX_EASING_SERVOS;
+            tServoIndex = mServoMask.getNextIndex(tServoIndex + 1)) {
+        ServoEasing * tServoEasingObjectPtr = tEngine->mServoArray[tServoIndex];
+        if (tServoEasingObjectPtr != NULL) {
+#if defined(ENABLE_WRITE_TARGET_TRACKING)
+            tServoEasingObjectPtr->mIsTrackingTarget = false;
+#endif
+#if defined(ENABLE_VELOCITY_MODE)
+            tServoEasingObjectPtr->mIsVelocityMove = false;
+#endif
+            // set mServoMoves, so that isMoving() and isOneServoMoving() work as usual
+            tServoEasingObjectPtr->mServoMoves = true;
+            tEngine->setServoUpdateMaskBit(tServoIndex);
+            tNumberOfServos++;
+        }
+    }
+    mGroupMoveUserDataPointer = aUserDataPointer;
+    mGroupMoveNumberOfServos = tNumberOfServos;
+    mGroupMoveMillisForCompleteMove = aMillisForMove;
+    mGroupMoveMillisAtStart = tEngine->getMillis();
+    tEngine->mGroupMoveMask.setBits(mServoMask);
+    mGroupMoveFunction = aGroupMoveFunction; // set last, since it activates the group move for the interrupt
+
+    if (aStartUpdateByInterrupt) {
+        tEngine->startUpdateByInterrupt(true);
+    }
+    return true;
+}
+
+/*
+ * Called by updateAllServos() of the engine. Calls the group function once and writes the positions of all servos of the group.
+ * @return true if no group move is active or group move has ended
+ */
+bool ServoEasingGroup::updateGroupMove() {
+    ServoEasingGroupMoveFunction tGroupMoveFunction = mGroupMoveFunction;
+    if (tGroupMoveFunction == NULL) {
+        return true;
+    }
+    ServoEasingEngine * tEngine = SERVO_ENGINE(this);
+
+    uint32_t tMillisSinceStart = tEngine->getMillis() - mGroupMoveMillisAtStart;
+    bool tGroupMoveEnded = (tMillisSinceStart >= mGroupMoveMillisForCompleteMove);
+    float tPercentageOfCompletion = 1.0;
+    if (!tGroupMoveEnded) {
+        tPercentageOfCompletion = (float) tMillisSinceStart / (float) mGroupMoveMillisForCompleteMove;
+    }
+
+    /*
+     * Sized by the number of servos of the group, since this may run in the ISR.
+     * Variable length arrays are a GCC extension, which is supported by all Arduino cores.
+     */
+    uint_fast8_t tNumberOfServos = mGroupMoveNumberOfServos;
+    int tDegreeArray[tNumberOfServos];
+    uint_fast8_t i = 0;
+    for (uint_fast8_t tServoIndex = mServoMask.getNextIndex(0); tServoIndex < MAX_EASING_SERVOS && i < tNumberOfServos;
+            tServoIndex = mServoMask.getNextIndex(tServoIndex + 1)) {
+        if (tEngine->mServoArray[tServoIndex] != NULL) {
+            tDegreeArray[i++] = tEngine->mServoArray[tServoIndex]->getCurrentAngle();
+        }
+    }
+
+    tGroupMoveFunction(tPercentageOfCompletion, tDegreeArray, mGroupMoveUserDataPointer);
+
+    i = 0;
+    for (uint_fast8_t tServoIndex = mServoMask.getNextIndex(0); tServoIndex < MAX_EASING_SERVOS && i < tNumberOfServos;
+            tServoIndex = mServoMask.getNextIndex(tServoIndex + 1)) {
+        ServoEasing * tServoEasingObjectPtr = tEngine->mServoArray[tServoIndex];
+        if (tServoEasingObjectPtr != NULL) {
+            if (tServoEasingObjectPtr->mServoMoves) {
+                int tNewMicrosecondsOrUnits = tServoEasingObjectPtr->DegreeToMicrosecondsOrUnits(tDegreeArray[i]);
+                if (tNewMicrosecondsOrUnits != tServoEasingObjectPtr->mCurrentMicrosecondsOrUnits) {
+                    tServoEasingObjectPtr->writeMicrosecondsOrUnitsDirect(tNewMicrosecondsOrUnits);
+                }
+                if (tGroupMoveEnded) {
+                    tEngine->mServoNextPositionArray[tServoIndex] = tDegreeArray[i];
+                    tServoEasingObjectPtr->mServoMoves = false;
+                }
+            }
+            i++;
+        }
+    }
+    if (tGroupMoveEnded) {
+        mGroupMoveFunction = NULL;
+        tEngine->mGroupMoveMask.clearBits(mServoMask);
+    }
+    return tGroupMoveEnded;
+}
+
+/*
+ * Stops the group move. The servos of the group stay at their current position.
+ */
+void ServoEasingGroup::stopGroupMove() {
+    if (mGroupMoveFunction != NULL) {
+        mGroupMoveFunction = NULL;
+        ServoEasingEngine * tEngine = SERVO_ENGINE(this);
+        tEngine->mGroupMoveMask.clearBits(mServoMask);
+        for (uint_fast8_t tServoIndex = mServoMask.getNextIndex(0); tServoIndex < MAX_EASING_SERVOS;
+                tServoIndex = mServoMask.getNextIndex(tServoIndex + 1)) {
+            if (tEngine->mServoArray[tServoIndex] != NULL) {
+                tEngine->mServoArray[tServoIndex]->mServoMoves = false;
+            }
+        }
+    }
+}
+
+bool ServoEasingGroup::isGroupMoveActive() {
+    return mGroupMoveFunction != NULL;
+}
+
+/*
+ * @return true if all group moves of this engine have ended
+ */
+bool ServoEasingEngine::updateGroupMoves() {
+    bool tAllGroupMovesEnded = true;
+    if (!mGroupMoveMask.isEmpty()) {
+        for (ServoEasingGroup * tGroup = sServoEasingGroupList; tGroup != NULL; tGroup = tGroup->mNextGroup) {
+            if (SERVO_ENGINE(tGroup) == this && !tGroup->updateGroupMove()) {
+                tAllGroupMovesEnded = false;
+            }
+        }
+    }
+    return tAllGroupMovesEnded;
+}
+
+void ServoEasingEngine::stopGroupMoves() {
+    for (ServoEasingGroup * tGroup = sServoEasingGroupList; tGroup != NULL; tGroup = tGroup->mNextGroup) {
+        if (SERVO_ENGINE(tGroup) == this) {
+            tGroup->stopGroupMove();
+        }
+    }
+}
+
+/*
+ * The former global group move, which is restricted to an index range of the default engine
+ */
+ServoEasingGroup sIndexRangeGroup;
+
+/**
+ * Starts a coupled move of the servos sServoArray[aFirstServoIndex] to sServoArray[aFirstServoIndex + aNumberOfServos - 1].
+ * @see ServoEasingGroup::startGroupMoveD()
+ * @return false if parameters are invalid
+ */
+bool startGroupMoveD(ServoEasingGroupMoveFunction aGroupMoveFunction, uint_fast8_t aFirstServoIndex, uint_fast8_t aNumberOfServos,
+        uint_fast16_t aMillisForMove, void * aUserDataPointer, bool aStartUpdateByInterrupt) {
+    if (aNumberOfServos == 0 || aFirstServoIndex + aNumberOfServos > sServoArrayMaxIndex + 1) {
+#if defined(DEBUG)
+        Serial.println(F("Error: invalid group"));
+#endif
+        return false;
+    }
+    sIndexRangeGroup.stopGroupMove();
+    sIndexRangeGroup.mServoMask.clearAll();
+    for (uint_fast8_t tServoIndex = aFirstServoIndex; tServoIndex < aFirstServoIndex + aNumberOfServos; ++tServoIndex) {
+        if (sServoArray[tServoIndex] != NULL) {
+            sIndexRangeGroup.addServo(sServoArray[tServoIndex]);
+        }
+    }
+    return sIndexRangeGroup.startGroupMoveD(aGroupMoveFunction, aMillisForMove, aUserDataPointer, aStartUpdateByInterrupt);
+}
 
-    // Enable the TC5 interrupt request
-    TC5->COUNT16.INTENSET.bit.MC0 = 1;
-//    while (TC5->COUNT16.STATUS.reg & TC_STATUS_SYNCBUSY) // Not required to wait at end of function
-//        ; // wait until TC5 is done syncing
+void stopGroupMove() {
+    sServoEasingDefaultEngine.stopGroupMoves();
+}
 
-#elif defined(ARDUINO_ARCH_APOLLO3)
-    // use timer 3 segment A
-    am_hal_ctimer_clear(3, AM_HAL_CTIMER_TIMERA); // reset timer
-    // only AM_HAL_CTIMER_FN_REPEAT resets counter after match (CTC mode)
-    am_hal_ctimer_config_single(3, AM_HAL_CTIMER_TIMERA,
-            (AM_HAL_CTIMER_INT_ENABLE | AM_HAL_CTIMER_HFRC_12KHZ | AM_HAL_CTIMER_FN_REPEAT));
-    am_hal_ctimer_compare_set(3, AM_HAL_CTIMER_TIMERA, 0, 12000 / REFRESH_FREQUENCY);
-    am_hal_ctimer_start(3, AM_HAL_CTIMER_TIMERA);
+bool isGroupMoveActive() {
+    return !sServoEasingDefaultEngine.mGroupMoveMask.isEmpty();
+}
 
-    am_hal_ctimer_int_register(AM_HAL_CTIMER_INT_TIMERA3, handleServoTimerInterrupt);
-    am_hal_ctimer_int_enable(AM_HAL_CTIMER_INT_TIMERA3);
-    NVIC_EnableIRQ(CTIMER_IRQn);
+bool isServoIndexInActiveGroupMove(uint_fast8_t aServoIndex) {
+    return sServoEasingDefaultEngine.isServoInGroupMove(aServoIndex);
+}
 
-#elif defined(TEENSYDUINO)
-    // common for all Teensy
-    Timer20ms.begin(handleServoTimerInterrupt, REFRESH_INTERVAL_MICROS);
+#if defined(ENABLE_POSITION_SNAPSHOT) || defined(ENABLE_CALIBRATION_STORE)
+/*
+ * EEPROM helpers for position snapshot and calibration store. All records are checked by a CRC-16-CCITT with initial value 0xFFFF.
+ */
+// CRC-16-CCITT
+static uint16_t updateEEPROMCRC(uint16_t aCRC, uint8_t aByte) {
+    aCRC ^= (uint16_t) aByte << 8;
+    for (uint_fast8_t i = 0; i < 8; ++i) {
+        if (aCRC & 0x8000) {
+            aCRC = (aCRC << 1) ^ 0x1021;
+        } else {
+            aCRC <<= 1;
+        }
+    }
+    return aCRC;
+}
+
+static uint8_t readEEPROMByteWithCRC(int aAddress, uint16_t * aCRC) {
+    uint8_t tByte = EEPROM.read(aAddress);
+    *aCRC = updateEEPROMCRC(*aCRC, tByte);
+    return tByte;
+}
 
+static void writeEEPROMByteWithCRC(int aAddress, uint8_t aByte, uint16_t * aCRC) {
+#if defined(__AVR__)
+    EEPROM.update(aAddress, aByte); // saves EEPROM cycles and time for unchanged bytes
 #else
-#warning Board / CPU is not covered by definitions using pre-processor symbols -> no timer available. Please extend ServoEasing.cpp.
+    EEPROM.write(aAddress, aByte);
 #endif
-    sInterruptsAreActive = true;
+    *aCRC = updateEEPROMCRC(*aCRC, aByte);
 }
+#endif
 
-void disableServoEasingInterrupt() {
-#if defined(__AVR__)
-#  if defined(__AVR_ATmega1280__) || defined(__AVR_ATmega2560__)
-    TIMSK5 &= ~(_BV(OCIE5B)); // disable the output compare B interrupt
+#if defined(ENABLE_POSITION_SNAPSHOT)
+/************************************
+ * Position snapshot in EEPROM
+ * Each slot contains: 16 bit sequence number, number of servos, 5 bytes for each servo, 16 bit CRC of all preceding bytes.
+ * A new snapshot is written to the slot after the one with the highest sequence number.
+ * A snapshot which was interrupted by a power loss has a wrong CRC, so the preceding one is taken.
+ ***********************************/
+#define SNAPSHOT_NO_SERVO_FLAG  0xFF // value of reverse flag for an unused servo index
 
-#elif defined(__AVR_ATmega4809__) // Uno WiFi Rev 2, Nano Every
-    TCA0.SINGLE.INTCTRL &= ~(TCA_SINGLE_OVF_bm); // disable the overflow interrupt
+uint8_t sSnapshotSlot = SNAPSHOT_NUMBER_OF_SLOTS; // slot of newest snapshot, SNAPSHOT_NUMBER_OF_SLOTS -> not yet searched
+uint16_t sSnapshotSequenceNumber;
 
-#  else
-    TIMSK1 &= ~(_BV(OCIE1B)); // disable the output compare B interrupt
-#  endif
+/*
+ * Reads the slot and checks its CRC
+ * @return the number of servos or 0 if slot is not valid
+ */
+static uint_fast8_t checkSnapshotSlot(uint_fast8_t aSlot, uint16_t * aSequenceNumber) {
+    int tAddress = SNAPSHOT_EEPROM_START_ADDRESS + (aSlot * SNAPSHOT_SLOT_SIZE);
+    uint16_t tCRC = 0xFFFF;
+    uint16_t tSequenceNumber = readEEPROMByteWithCRC(tAddress, &tCRC);
+    tSequenceNumber |= readEEPROMByteWithCRC(tAddress + 1, &tCRC) << 8;
+    uint_fast8_t tNumberOfServos = readEEPROMByteWithCRC(tAddress + 2, &tCRC);
+    if (tNumberOfServos == 0 || tNumberOfServos > MAX_EASING_SERVOS) {
+        return 0; // e.g. erased EEPROM
+    }
+    tAddress += 3;
+    for (uint_fast16_t i = 0; i < (uint_fast16_t) tNumberOfServos * SNAPSHOT_ENTRY_SIZE; ++i) { // 8 bit index overflows for 52 servos
+        readEEPROMByteWithCRC(tAddress++, &tCRC);
+    }
+    uint16_t tStoredCRC = EEPROM.read(tAddress) | (EEPROM.read(tAddress + 1) << 8);
+    if (tStoredCRC != tCRC) {
+        return 0;
+    }
+    *aSequenceNumber = tSequenceNumber;
+    return tNumberOfServos;
+}
 
-#elif defined(ESP8266) || defined(ESP32)
-    Timer20ms.detach();
+/*
+ * Sets sSnapshotSlot to the valid slot with the highest sequence number
+ * @return false if no valid snapshot exists
+ */
+static bool findNewestSnapshot() {
+    bool tSnapshotFound = false;
+    for (uint_fast8_t tSlot = 0; tSlot < SNAPSHOT_NUMBER_OF_SLOTS; ++tSlot) {
+        uint16_t tSequenceNumber;
+        if (checkSnapshotSlot(tSlot, &tSequenceNumber) != 0
+                && (!tSnapshotFound || (int16_t) (tSequenceNumber - sSnapshotSequenceNumber) > 0)) {
+            // handles the overflow of the sequence number
+            tSnapshotFound = true;
+            sSnapshotSlot = tSlot;
+            sSnapshotSequenceNumber = tSequenceNumber;
+        }
+    }
+    return tSnapshotFound;
+}
 
-#elif defined(STM32F1xx)   // for "Generic STM32F1 series" from STM32 Boards from STM32 cores of Arduino Board manager
-    // https://github.com/stm32duino/BoardManagerFiles/raw/master/STM32/package_stm_index.json
-    Timer20ms.setMode(LL_TIM_CHANNEL_CH1, TIMER_DISABLED);
-    Timer20ms.detachInterrupt();
+/*
+ * Fills the 5 bytes of the snapshot entry of the servo
+ */
+static void getSnapshotEntry(ServoEasing * aServoEasingObjectPtr, uint8_t * aEntry) {
+    int tMicrosecondsOrUnits = 0;
+    int tTrimMicrosecondsOrUnits = 0;
+    uint8_t tReverseFlag = SNAPSHOT_NO_SERVO_FLAG;
+    if (aServoEasingObjectPtr != NULL) {
+        tMicrosecondsOrUnits = aServoEasingObjectPtr->mCurrentMicrosecondsOrUnits;
+        tTrimMicrosecondsOrUnits = aServoEasingObjectPtr->mTrimMicrosecondsOrUnits;
+        tReverseFlag = aServoEasingObjectPtr->mOperateServoReverse;
+    }
+    aEntry[0] = tMicrosecondsOrUnits;
+    aEntry[1] = tMicrosecondsOrUnits >> 8;
+    aEntry[2] = tTrimMicrosecondsOrUnits;
+    aEntry[3] = tTrimMicrosecondsOrUnits >> 8;
+    aEntry[4] = tReverseFlag;
+}
 
-#elif defined(__STM32F1__) // for "Generic STM32F103C series" from STM32F1 Boards (STM32duino.com) of Arduino Board manager
-    // http://dan.drown.org/stm32duino/package_STM32duino_index.json
-    Timer20ms.setMode(TIMER_CH1, TIMER_DISABLED);
-    Timer20ms.detachInterrupt(TIMER_CH1);
+/*
+ * @return true if the newest snapshot contains the same entries as the current servos
+ */
+static bool isSnapshotUnchanged(ServoEasingEngine * aEngine, uint_fast8_t aNumberOfServos) {
+    uint16_t tSequenceNumber;
+    if (checkSnapshotSlot(sSnapshotSlot, &tSequenceNumber) != aNumberOfServos) {
+        return false;
+    }
+    int tAddress = SNAPSHOT_EEPROM_START_ADDRESS + (sSnapshotSlot * SNAPSHOT_SLOT_SIZE) + 3;
+    for (uint_fast8_t tServoIndex = 0; tServoIndex < aNumberOfServos; ++tServoIndex) {
+        uint8_t tEntry[SNAPSHOT_ENTRY_SIZE];
+        getSnapshotEntry(aEngine->mServoArray[tServoIndex], tEntry);
+        for (uint_fast8_t i = 0; i < SNAPSHOT_ENTRY_SIZE; ++i) {
+            if (EEPROM.read(tAddress++) != tEntry[i]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
 
-#elif defined(__SAM3X8E__)  // Arduino DUE
-    NVIC_DisableIRQ(IRQn_FOR_20_MS_TIMER);
+/**
+ * Saves position, trim and reverse of all servos of the default engine, if they differ from the newest snapshot.
+ * Each save goes to the next slot, i.e. costs one EEPROM write cycle of the slot.
+ * EEPROM write requires 3.3 ms per changed byte on AVR, i.e. up to 215 ms for the 65 bytes of 12 servos.
+ * This is much too long for calling it from a power fail interrupt or an emergency stop,
+ * so call it e.g. after the servos stopped and before the power is switched off.
+ */
+bool saveServoPositionSnapshot() {
+#if defined(ESP8266) || defined(ESP32)
+    EEPROM.begin(SERVO_EASING_EEPROM_SIZE);
+#endif
+    ServoEasingEngine * tEngine = &sServoEasingDefaultEngine;
+    uint_fast8_t tNumberOfServos = tEngine->mServoArrayMaxIndex + 1;
+    if (sSnapshotSlot >= SNAPSHOT_NUMBER_OF_SLOTS && !findNewestSnapshot()) {
+        // first snapshot goes to slot 0
+        sSnapshotSlot = SNAPSHOT_NUMBER_OF_SLOTS - 1;
+        sSnapshotSequenceNumber = 0xFFFF;
+    } else if (isSnapshotUnchanged(tEngine, tNumberOfServos)) {
+        return true; // no EEPROM write cycle required
+    }
+    uint_fast8_t tSlot = sSnapshotSlot + 1;
+    if (tSlot >= SNAPSHOT_NUMBER_OF_SLOTS) {
+        tSlot = 0;
+    }
+    uint16_t tSequenceNumber = sSnapshotSequenceNumber + 1;
+
+    int tAddress = SNAPSHOT_EEPROM_START_ADDRESS + (tSlot * SNAPSHOT_SLOT_SIZE);
+    uint16_t tCRC = 0xFFFF;
+    writeEEPROMByteWithCRC(tAddress++, tSequenceNumber, &tCRC);
+    writeEEPROMByteWithCRC(tAddress++, tSequenceNumber >> 8, &tCRC);
+    writeEEPROMByteWithCRC(tAddress++, tNumberOfServos, &tCRC);
+    for (uint_fast8_t tServoIndex = 0; tServoIndex < tNumberOfServos; ++tServoIndex) {
+        uint8_t tEntry[SNAPSHOT_ENTRY_SIZE];
+        getSnapshotEntry(tEngine->mServoArray[tServoIndex], tEntry);
+        for (uint_fast8_t i = 0; i < SNAPSHOT_ENTRY_SIZE; ++i) {
+            writeEEPROMByteWithCRC(tAddress++, tEntry[i], &tCRC);
+        }
+    }
+    uint16_t tDummyCRC;
+    writeEEPROMByteWithCRC(tAddress++, tCRC, &tDummyCRC);
+    writeEEPROMByteWithCRC(tAddress, tCRC >> 8, &tDummyCRC);
+#if defined(ESP8266) || defined(ESP32)
+    if (!EEPROM.commit()) {
+        return false;
+    }
+#endif
+    sSnapshotSlot = tSlot;
+    sSnapshotSequenceNumber = tSequenceNumber;
+#if defined(DEBUG)
+    Serial.print(F("Snapshot saved in slot "));
+    Serial.println(tSlot);
+#endif
+    return true;
+}
 
-#elif defined(ARDUINO_ARCH_SAMD)
-    TC5->COUNT16.CTRLA.reg &= ~TC_CTRLA_ENABLE;
-    while (TC5->COUNT16.STATUS.reg & TC_STATUS_SYNCBUSY); //wait until TC5 is done syncing
+/**
+ * Sets trim and reverse of all attached servos of the default engine to the values of the last snapshot
+ * and writes the last position to the servos, so the next move starts without a jump and no delay is required.
+ * @return false if no valid snapshot was found
+ */
+bool restoreServoPositionSnapshot() {
+#if defined(ESP8266) || defined(ESP32)
+    EEPROM.begin(SERVO_EASING_EEPROM_SIZE);
+#endif
+    if (!findNewestSnapshot()) {
+        return false;
+    }
+    uint16_t tSequenceNumber;
+    uint_fast8_t tNumberOfServos = checkSnapshotSlot(sSnapshotSlot, &tSequenceNumber);
+    ServoEasingEngine * tEngine = &sServoEasingDefaultEngine;
+
+    int tAddress = SNAPSHOT_EEPROM_START_ADDRESS + (sSnapshotSlot * SNAPSHOT_SLOT_SIZE) + 3;
+    for (uint_fast8_t tServoIndex = 0; tServoIndex < tNumberOfServos; ++tServoIndex, tAddress += SNAPSHOT_ENTRY_SIZE) {
+        ServoEasing * tServoEasingObjectPtr = tEngine->mServoArray[tServoIndex];
+        uint8_t tReverseFlag = EEPROM.read(tAddress + 4);
+        if (tServoEasingObjectPtr == NULL || tReverseFlag == SNAPSHOT_NO_SERVO_FLAG) {
+            continue;
+        }
+        int16_t tMicrosecondsOrUnits = EEPROM.read(tAddress) | (EEPROM.read(tAddress + 1) << 8);
+        int16_t tTrimMicrosecondsOrUnits = EEPROM.read(tAddress + 2) | (EEPROM.read(tAddress + 3) << 8);
+        tServoEasingObjectPtr->mOperateServoReverse = tReverseFlag;
+        tServoEasingObjectPtr->setTrimMicrosecondsOrUnits(tTrimMicrosecondsOrUnits); // computes offsets for trim and reverse
+        tEngine->mServoNextPositionArray[tServoIndex] = tServoEasingObjectPtr->MicrosecondsOrUnitsToDegree(tMicrosecondsOrUnits);
+        tServoEasingObjectPtr->writeMicrosecondsOrUnitsDirect(tMicrosecondsOrUnits);
+    }
+#if defined(DEBUG)
+    Serial.print(F("Snapshot restored from slot "));
+    Serial.println(sSnapshotSlot);
+#endif
+    return true;
+}
+#endif // defined(ENABLE_POSITION_SNAPSHOT)
 
-#elif defined(ARDUINO_ARCH_APOLLO3)
-    am_hal_ctimer_int_disable(AM_HAL_CTIMER_INT_TIMERA3);
+#if defined(ENABLE_CALIBRATION_STORE)
+/************************************
+ * Calibration store in EEPROM
+ * The record contains: 8 bit version, number of servos, 17 bytes for each servo, 16 bit CRC of all preceding bytes.
+ * All 16 bit values are little endian. Values of disabled features are stored as 0.
+ * The values are stored in the unit of the servo, i.e. in microseconds or in PCA9685 units, which is recorded by CALIBRATION_FLAG_PCA9685_UNITS.
+ ***********************************/
+int8_t sCalibrationStoreNumberOfServos = -1; // -1 -> not yet checked, 0 -> no valid record
 
-#elif defined(TEENSYDUINO)
-    Timer20ms.end();
+/*
+ * Reads the record and checks version and CRC
+ * @return the number of servos or 0 if record is not valid
+ */
+static uint_fast8_t checkCalibrationStore() {
+#if defined(ESP8266) || defined(ESP32)
+    EEPROM.begin(SERVO_EASING_EEPROM_SIZE);
 #endif
-    sInterruptsAreActive = false;
+    int tAddress = CALIBRATION_STORE_EEPROM_START_ADDRESS;
+    uint16_t tCRC = 0xFFFF;
+    uint8_t tVersion = readEEPROMByteWithCRC(tAddress, &tCRC);
+    uint_fast8_t tNumberOfServos = readEEPROMByteWithCRC(tAddress + 1, &tCRC);
+    if (tVersion != CALIBRATION_STORE_VERSION || tNumberOfServos == 0 || tNumberOfServos > MAX_EASING_SERVOS) {
+        return 0; // e.g. erased EEPROM
+    }
+    tAddress += 2;
+    for (uint_fast16_t i = 0; i < tNumberOfServos * CALIBRATION_ENTRY_SIZE; ++i) {
+        readEEPROMByteWithCRC(tAddress++, &tCRC);
+    }
+    uint16_t tStoredCRC = EEPROM.read(tAddress) | (EEPROM.read(tAddress + 1) << 8);
+    if (tStoredCRC != tCRC) {
+        return 0;
+    }
+    return tNumberOfServos;
+}
+
+static int16_t readEEPROMInt16(int aAddress) {
+    return EEPROM.read(aAddress) | (EEPROM.read(aAddress + 1) << 8);
+}
+
+static void writeEEPROMInt16WithCRC(int aAddress, int16_t aValue, uint16_t * aCRC) {
+    writeEEPROMByteWithCRC(aAddress, aValue, aCRC);
+    writeEEPROMByteWithCRC(aAddress + 1, aValue >> 8, aCRC);
 }
 
 /*
- * 60 us for single servo + 160 us per servo if using I2C e.g.for PCA9685 expander at 400000 Hz or + 100 at 800000 Hz
- * 20 us for last interrupt
- * The first servo pulse starts just after this interrupt routine has finished
+ * @return CALIBRATION_FLAG_PCA9685_UNITS if the values of the servo are PCA9685 units and not microseconds
  */
-#if defined(__AVR__)
-#  if defined(__AVR_ATmega1280__) || defined(__AVR_ATmega2560__)
-ISR(TIMER5_COMPB_vect) {
-    handleServoTimerInterrupt();
+static uint8_t getCalibrationUnitFlag(ServoEasing * aServoEasingObjectPtr) {
+#if defined(USE_PCA9685_SERVO_EXPANDER)
+    if (aServoEasingObjectPtr->isConnectedToPCA9685Expander()) {
+        return CALIBRATION_FLAG_PCA9685_UNITS;
+    }
+#else
+    (void) aServoEasingObjectPtr;
+#endif
+    return 0;
 }
 
-#elif defined(__AVR_ATmega4809__) // Uno WiFi Rev 2, Nano Every
-ISR(TCA0_OVF_vect) {
-    handleServoTimerInterrupt();
+/**
+ * Applies the stored calibration entry of this servo index. The CRC of the record is checked only once.
+ * Only servos of the default engine are supported.
+ * @return false if there is no valid entry for this servo
+ */
+bool ServoEasing::loadCalibration() {
+    if (!SERVO_ENGINE(this)->isDefaultEngine() || mServoIndex == INVALID_SERVO) {
+        return false;
+    }
+    if (sCalibrationStoreNumberOfServos < 0) {
+        sCalibrationStoreNumberOfServos = checkCalibrationStore();
+    }
+    if (mServoIndex >= sCalibrationStoreNumberOfServos) {
+        return false;
+    }
+    int tAddress = CALIBRATION_STORE_EEPROM_START_ADDRESS + 2 + (mServoIndex * CALIBRATION_ENTRY_SIZE);
+    uint8_t tFlags = EEPROM.read(tAddress + 16);
+    if ((tFlags & CALIBRATION_FLAG_NO_SERVO) || (tFlags & CALIBRATION_FLAG_PCA9685_UNITS) != getCalibrationUnitFlag(this)) {
+        return false; // unused index or values of another unit, e.g. after changing from Servo library to PCA9685 expander
+    }
+    mServo0DegreeMicrosecondsOrUnits = readEEPROMInt16(tAddress);
+    mServo180DegreeMicrosecondsOrUnits = readEEPROMInt16(tAddress + 2);
+    mTrimMicrosecondsOrUnits = readEEPROMInt16(tAddress + 4);
+#if defined(ENABLE_MIN_AND_MAX_CONSTRAINTS)
+    mMinMicrosecondsOrUnits = readEEPROMInt16(tAddress + 6);
+    mMaxMicrosecondsOrUnits = readEEPROMInt16(tAddress + 8);
+#endif
+    mSpeed = (uint16_t) readEEPROMInt16(tAddress + 10);
+#if defined(ENABLE_SLEW_RATE_LIMITED_WRITE)
+    mSlewRateMaxVelocity = readEEPROMInt16(tAddress + 12);
+    mSlewRateMaxAcceleration = readEEPROMInt16(tAddress + 14);
+#endif
+    mOperateServoReverse = tFlags & CALIBRATION_FLAG_REVERSE;
+    computeConversionFactorsAndOffsets();
+#if defined(ENABLE_MIN_AND_MAX_CONSTRAINTS)
+    computeMinMaxConstraintWithTrimAndReverse();
+#endif
+#if defined(DEBUG)
+    Serial.print(F("Calibration loaded for servo "));
+    Serial.println(mServoIndex);
+#endif
+    return true;
 }
 
-#  else // defined(__AVR__)
-ISR(TIMER1_COMPB_vect) {
-#    if defined(MEASURE_SERVO_EASING_INTERRUPT_TIMING)
-    digitalWriteFast(TIMING_OUTPUT_PIN, HIGH);
-#    endif
-    handleServoTimerInterrupt();
-#    if defined(MEASURE_SERVO_EASING_INTERRUPT_TIMING)
-    digitalWriteFast(TIMING_OUTPUT_PIN, LOW);
-#    endif
+/**
+ * Saves the calibration of all servos of the default engine, e.g. after trimming them with a serial or IR command.
+ * Indexes of detached servos are marked as unused.
+ * EEPROM write requires 3.3 ms per changed byte on AVR.
+ */
+bool saveCalibrationStore() {
+#if defined(ESP8266) || defined(ESP32)
+    EEPROM.begin(SERVO_EASING_EEPROM_SIZE);
+#endif
+    ServoEasingEngine * tEngine = &sServoEasingDefaultEngine;
+    uint_fast8_t tNumberOfServos = tEngine->mServoArrayMaxIndex + 1;
+
+    int tAddress = CALIBRATION_STORE_EEPROM_START_ADDRESS;
+    uint16_t tCRC = 0xFFFF;
+    writeEEPROMByteWithCRC(tAddress++, CALIBRATION_STORE_VERSION, &tCRC);
+    writeEEPROMByteWithCRC(tAddress++, tNumberOfServos, &tCRC);
+    for (uint_fast8_t tServoIndex = 0; tServoIndex < tNumberOfServos; ++tServoIndex, tAddress += CALIBRATION_ENTRY_SIZE) {
+        ServoEasing * tServoEasingObjectPtr = tEngine->mServoArray[tServoIndex];
+        if (tServoEasingObjectPtr == NULL) {
+            for (uint_fast8_t i = 0; i < CALIBRATION_ENTRY_SIZE - 1; ++i) {
+                writeEEPROMByteWithCRC(tAddress + i, 0, &tCRC);
+            }
+            writeEEPROMByteWithCRC(tAddress + 16, CALIBRATION_FLAG_NO_SERVO, &tCRC);
+            continue;
+        }
+        int16_t tMin = 0;
+        int16_t tMax = 0;
+#if defined(ENABLE_MIN_AND_MAX_CONSTRAINTS)
+        tMin = tServoEasingObjectPtr->mMinMicrosecondsOrUnits;
+        tMax = tServoEasingObjectPtr->mMaxMicrosecondsOrUnits;
+#endif
+        uint16_t tSlewRateMaxVelocity = 0;
+        uint16_t tSlewRateMaxAcceleration = 0;
+#if defined(ENABLE_SLEW_RATE_LIMITED_WRITE)
+        tSlewRateMaxVelocity = tServoEasingObjectPtr->mSlewRateMaxVelocity;
+        tSlewRateMaxAcceleration = tServoEasingObjectPtr->mSlewRateMaxAcceleration;
+#endif
+        writeEEPROMInt16WithCRC(tAddress, tServoEasingObjectPtr->mServo0DegreeMicrosecondsOrUnits, &tCRC);
+        writeEEPROMInt16WithCRC(tAddress + 2, tServoEasingObjectPtr->mServo180DegreeMicrosecondsOrUnits, &tCRC);
+        writeEEPROMInt16WithCRC(tAddress + 4, tServoEasingObjectPtr->mTrimMicrosecondsOrUnits, &tCRC);
+        writeEEPROMInt16WithCRC(tAddress + 6, tMin, &tCRC);
+        writeEEPROMInt16WithCRC(tAddress + 8, tMax, &tCRC);
+        writeEEPROMInt16WithCRC(tAddress + 10, tServoEasingObjectPtr->mSpeed, &tCRC);
+        writeEEPROMInt16WithCRC(tAddress + 12, tSlewRateMaxVelocity, &tCRC);
+        writeEEPROMInt16WithCRC(tAddress + 14, tSlewRateMaxAcceleration, &tCRC);
+        writeEEPROMByteWithCRC(tAddress + 16,
+                (tServoEasingObjectPtr->mOperateServoReverse ? CALIBRATION_FLAG_REVERSE : 0) | getCalibrationUnitFlag(tServoEasingObjectPtr), &tCRC);
+    }
+    uint16_t tDummyCRC;
+    writeEEPROMInt16WithCRC(tAddress, tCRC, &tDummyCRC);
+#if defined(ESP8266) || defined(ESP32)
+    if (!EEPROM.commit()) {
+        return false;
+    }
+#endif
+    sCalibrationStoreNumberOfServos = tNumberOfServos;
+    return true;
 }
-#  endif
 
-#elif defined(__SAM3X8E__)  // Arduino DUE
-void HANDLER_FOR_20_MS_TIMER(void) {
-#  if defined(MEASURE_SERVO_EASING_INTERRUPT_TIMING)
-    digitalWrite(TIMING_OUTPUT_PIN, HIGH);
-#  endif
-    // Clear interrupt
-    TC_GetStatus(TC_FOR_20_MS_TIMER, CHANNEL_FOR_20_MS_TIMER);//Clear channel status to fire again the interrupt.
-    handleServoTimerInterrupt();
-#  if defined(MEASURE_SERVO_EASING_INTERRUPT_TIMING)
-    digitalWrite(TIMING_OUTPUT_PIN, LOW);
-#  endif
+/**
+ * Invalidates the record, so the next attach() uses only its parameters
+ */
+void clearCalibrationStore() {
+#if defined(ESP8266) || defined(ESP32)
+    EEPROM.begin(SERVO_EASING_EEPROM_SIZE);
+#endif
+    uint16_t tDummyCRC;
+    writeEEPROMByteWithCRC(CALIBRATION_STORE_EEPROM_START_ADDRESS, 0, &tDummyCRC);
+#if defined(ESP8266) || defined(ESP32)
+    EEPROM.commit();
+#endif
+    sCalibrationStoreNumberOfServos = 0;
 }
 
-#elif defined(ARDUINO_ARCH_SAMD)
-void TC5_Handler(void) {
-#  if defined(MEASURE_SERVO_EASING_INTERRUPT_TIMING)
-    digitalWrite(TIMING_OUTPUT_PIN, HIGH);
-#  endif
-    // Clear interrupt
-    TC5->COUNT16.INTFLAG.bit.MC0 = 1;
-    handleServoTimerInterrupt();
-#  if defined(MEASURE_SERVO_EASING_INTERRUPT_TIMING)
-    digitalWrite(TIMING_OUTPUT_PIN, LOW);
-#  endif
+static void printCalibrationDumpBytes(Print * aSerial, uint8_t * aBuffer, uint_fast8_t aNumberOfBytes) {
+    for (uint_fast8_t i = 0; i < aNumberOfBytes; ++i) {
+        if (aBuffer[i] < 0x10) {
+            aSerial->print('0');
+        }
+        aSerial->print(aBuffer[i], HEX);
+    }
+    aSerial->println();
 }
 
-#elif defined(ARDUINO_ARCH_APOLLO3)
-extern "C" void am_ctimer_isr(void) {
-    // Check and clear any active CTIMER interrupts.
-    uint32_t ui32Status = am_hal_ctimer_int_status_get(true);
-    am_hal_ctimer_int_clear(ui32Status);
+/*
+ * @return the CRC of servo index and entry of a dump line
+ */
+static uint16_t getCalibrationDumpLineCRC(uint8_t * aLine) {
+    uint16_t tCRC = 0xFFFF;
+    for (uint_fast8_t i = 0; i < 1 + CALIBRATION_ENTRY_SIZE; ++i) {
+        tCRC = updateEEPROMCRC(tCRC, aLine[i]);
+    }
+    return tCRC;
+}
 
-    // Run handlers for the various possible timer events.
-    am_hal_ctimer_int_service(ui32Status);
+/**
+ * Prints the record as lines of 2 hex digits for each byte, also if the record is not valid.
+ * The first line is "CAL:" followed by version and number of servos. Then there is one line for each servo
+ * with servo index, the 17 bytes of its entry and the 16 bit CRC of index and entry. Each line fits into the 64 byte serial buffer of AVR.
+ */
+void printCalibrationStoreDump(Print * aSerial) {
+#if defined(ESP8266) || defined(ESP32)
+    EEPROM.begin(SERVO_EASING_EEPROM_SIZE);
+#endif
+    uint8_t tLine[CALIBRATION_DUMP_LINE_SIZE];
+    tLine[0] = EEPROM.read(CALIBRATION_STORE_EEPROM_START_ADDRESS);
+    tLine[1] = EEPROM.read(CALIBRATION_STORE_EEPROM_START_ADDRESS + 1);
+    if (tLine[1] > MAX_EASING_SERVOS) {
+        tLine[1] = MAX_EASING_SERVOS;
+    }
+    uint_fast8_t tNumberOfServos = tLine[1];
+    aSerial->print(F("CAL:"));
+    printCalibrationDumpBytes(aSerial, tLine, 2);
+
+    int tAddress = CALIBRATION_STORE_EEPROM_START_ADDRESS + 2;
+    for (uint_fast8_t tServoIndex = 0; tServoIndex < tNumberOfServos; ++tServoIndex) {
+        tLine[0] = tServoIndex;
+        for (uint_fast8_t i = 1; i <= CALIBRATION_ENTRY_SIZE; ++i) {
+            tLine[i] = EEPROM.read(tAddress++);
+        }
+        uint16_t tCRC = getCalibrationDumpLineCRC(tLine);
+        tLine[CALIBRATION_DUMP_LINE_SIZE - 2] = tCRC;
+        tLine[CALIBRATION_DUMP_LINE_SIZE - 1] = tCRC >> 8;
+        printCalibrationDumpBytes(aSerial, tLine, CALIBRATION_DUMP_LINE_SIZE);
+    }
+}
+
+static int8_t hexDigitToValue(char aChar) {
+    if (aChar >= '0' && aChar <= '9') {
+        return aChar - '0';
+    }
+    aChar |= 0x20; // to lower case
+    if (aChar >= 'a' && aChar <= 'f') {
+        return aChar - 'a' + 10;
+    }
+    return -1;
+}
+
+/*
+ * Reads 2 hex digits for each byte. Line ends before the first digit are skipped.
+ * @return false at the timeout of aSerial or at a character which is not a hex digit
+ */
+static bool readCalibrationDumpLine(Stream * aSerial, uint8_t * aBuffer, uint_fast8_t aNumberOfBytes) {
+    char tHexDigits[2];
+    do {
+        if (aSerial->readBytes(tHexDigits, 1) != 1) {
+            return false;
+        }
+    } while (tHexDigits[0] == '\r' || tHexDigits[0] == '\n');
+    for (uint_fast8_t i = 0; i < aNumberOfBytes; ++i) {
+        if (i > 0 && aSerial->readBytes(tHexDigits, 1) != 1) {
+            return false;
+        }
+        if (aSerial->readBytes(&tHexDigits[1], 1) != 1) {
+            return false;
+        }
+        int8_t tHigh = hexDigitToValue(tHexDigits[0]);
+        int8_t tLow = hexDigitToValue(tHexDigits[1]);
+        if (tHigh < 0 || tLow < 0) {
+            return false;
+        }
+        aBuffer[i] = (tHigh << 4) | tLow;
+    }
+    return true;
+}
+
+/**
+ * Reads the lines printed by printCalibrationStoreDump() and writes them to the EEPROM. Call it after "CAL:" was received.
+ * Each line is checked by its CRC before its entry is written, and is then acknowledged by printing "OK".
+ * The sender must wait for this "OK" before sending the next line, like extras/ServoEasingCalibration.py does,
+ * since writing an entry takes up to 56 ms on AVR, while the serial buffer holds only 64 characters.
+ * A wrong line or a timeout of aSerial is answered by "ERROR" and ends the transfer.
+ * The version byte is written at last, so an incomplete transfer leaves an invalid record.
+ * @return false if the transfer failed. Then no calibration is applied at the next attach().
+ */
+bool readCalibrationStoreDump(Stream * aSerial) {
+#if defined(ESP8266) || defined(ESP32)
+    EEPROM.begin(SERVO_EASING_EEPROM_SIZE);
+#endif
+    uint8_t tLine[CALIBRATION_DUMP_LINE_SIZE];
+    bool tSuccess = false;
+    if (readCalibrationDumpLine(aSerial, tLine, 2) && tLine[0] == CALIBRATION_STORE_VERSION && tLine[1] != 0
+            && tLine[1] <= MAX_EASING_SERVOS) {
+        uint_fast8_t tNumberOfServos = tLine[1];
+        uint16_t tDummyCRC;
+        uint16_t tCRC = updateEEPROMCRC(0xFFFF, CALIBRATION_STORE_VERSION);
+        writeEEPROMByteWithCRC(CALIBRATION_STORE_EEPROM_START_ADDRESS, 0, &tDummyCRC); // invalidate the record until the last entry is written
+        writeEEPROMByteWithCRC(CALIBRATION_STORE_EEPROM_START_ADDRESS + 1, tNumberOfServos, &tCRC);
+        aSerial->println(F("OK"));
+
+        int tAddress = CALIBRATION_STORE_EEPROM_START_ADDRESS + 2;
+        uint_fast8_t tServoIndex = 0;
+        for (; tServoIndex < tNumberOfServos; ++tServoIndex) {
+            if (!readCalibrationDumpLine(aSerial, tLine, CALIBRATION_DUMP_LINE_SIZE) || tLine[0] != tServoIndex
+                    || getCalibrationDumpLineCRC(tLine)
+                            != (tLine[CALIBRATION_DUMP_LINE_SIZE - 2] | (tLine[CALIBRATION_DUMP_LINE_SIZE - 1] << 8))) {
+                break;
+            }
+            for (uint_fast8_t i = 1; i <= CALIBRATION_ENTRY_SIZE; ++i) {
+                writeEEPROMByteWithCRC(tAddress++, tLine[i], &tCRC);
+            }
+            if (tServoIndex < tNumberOfServos - 1) {
+                aSerial->println(F("OK"));
+            }
+        }
+        if (tServoIndex == tNumberOfServos) {
+            writeEEPROMInt16WithCRC(tAddress, tCRC, &tDummyCRC);
+            writeEEPROMByteWithCRC(CALIBRATION_STORE_EEPROM_START_ADDRESS, CALIBRATION_STORE_VERSION, &tDummyCRC); // now the record is valid
+            tSuccess = true;
+        }
+    }
+#if defined(ESP8266) || defined(ESP32)
+    EEPROM.commit();
+#endif
+    sCalibrationStoreNumberOfServos = checkCalibrationStore();
+    if (tSuccess && sCalibrationStoreNumberOfServos != 0) {
+        aSerial->println(F("OK"));
+        return true;
+    }
+    aSerial->println(F("ERROR"));
+    return false;
 }
-#endif // defined(__AVR__)
+#endif // defined(ENABLE_CALIBRATION_STORE)
 
+#if defined(ENABLE_SERVO_DRIVER_INTERFACE)
 /************************************
- * ServoEasing list functions
+ * Simulation driver
+ * Records every pulse with time and servo index, e.g. to check moves on a host or to plot them without servos.
  ***********************************/
+ServoEasingSimulationRecord sSimulationRecordArray[SIMULATION_DRIVER_NUMBER_OF_RECORDS];
+uint16_t sSimulationNumberOfRecords;
+uint16_t sSimulationNumberOfFlushes;
+uint16_t sSimulationWriteIndex;
+bool sSimulationRecordArrayIsFull;
 
-#ifndef PROVIDE_ONLY_LINEAR_MOVEMENT
-void setEasingTypeForAllServos(uint_fast8_t aEasingType) {
-    for (uint_fast8_t tServoIndex = 0; tServoIndex <= sServoArrayMaxIndex; ++tServoIndex) {
-        if (sServoArray[tServoIndex] != NULL) {
-            sServoArray[tServoIndex]->mEasingType = aEasingType;
-        }
+/*
+ * The write index wraps at SIMULATION_DRIVER_NUMBER_OF_RECORDS and not at 0xFFFF like sSimulationNumberOfRecords,
+ * so no slot is skipped or overwritten twice when the total number wraps.
+ */
+static void addSimulationRecord(ServoEasing * aServo, int aMicroseconds) {
+    ServoEasingSimulationRecord * tRecord = &sSimulationRecordArray[sSimulationWriteIndex];
+    tRecord->Millis = SERVO_ENGINE(aServo)->getMillis();
+    tRecord->ServoIndex = aServo->mServoIndex;
+    tRecord->Microseconds = aMicroseconds;
+    sSimulationNumberOfRecords++;
+    if (++sSimulationWriteIndex >= SIMULATION_DRIVER_NUMBER_OF_RECORDS) {
+        sSimulationWriteIndex = 0;
+        sSimulationRecordArrayIsFull = true;
     }
 }
-#endif
-
-void setEaseToForAllServosSynchronizeAndStartInterrupt() {
-    setEaseToForAllServos();
-    synchronizeAllServosAndStartInterrupt();
-}
 
-void setEaseToForAllServosSynchronizeAndStartInterrupt(uint_fast16_t aDegreesPerSecond) {
-    setEaseToForAllServos(aDegreesPerSecond);
-    synchronizeAllServosAndStartInterrupt();
+static bool beginSimulation(ServoEasing * aServo) {
+    (void) aServo;
+    return true;
 }
 
-void synchronizeAndEaseToArrayPositions() {
-    setEaseToForAllServos();
-    synchronizeAllServosStartAndWaitForAllServosToStop();
+static void flushSimulation() {
+    sSimulationNumberOfFlushes++;
 }
 
-void synchronizeAndEaseToArrayPositions(uint_fast16_t aDegreesPerSecond) {
-    setEaseToForAllServos(aDegreesPerSecond);
-    synchronizeAllServosStartAndWaitForAllServosToStop();
+static void detachSimulation(ServoEasing * aServo) {
+    addSimulationRecord(aServo, 0);
 }
 
-void printArrayPositions(Print * aSerial) {
-//    uint_fast8_t tServoIndex = 0;
-    aSerial->print(F("ServoNextPositionArray="));
-// AJ 22.05.2019 This does not work with GCC 7.3.0 atmel6.3.1 and -Os
-// It drops the tServoIndex < MAX_EASING_SERVOS condition, since  MAX_EASING_SERVOS is equal to the size of sServoArray
-// This has only an effect if the whole sServoArray is filled up, i.e we have declared MAX_EASING_SERVOS ServoEasing objects.
-//    while (sServoArray[tServoIndex] != NULL && tServoIndex < MAX_EASING_SERVOS) {
-//        aSerial->print(sServoNextPositionArray[tServoIndex]);
-//        aSerial->print(F(" | "));
-//        tServoIndex++;
-//    }
-
-// switching conditions cures the bug
-//    while (tServoIndex < MAX_EASING_SERVOS && sServoArray[tServoIndex] != NULL) {
+const ServoEasingDriverInterface ServoEasingSimulationDriver = { &beginSimulation, &addSimulationRecord, &flushSimulation, &detachSimulation };
 
-// this also does not work
-//    for (uint_fast8_t tServoIndex = 0; sServoArray[tServoIndex] != NULL && tServoIndex < MAX_EASING_SERVOS  ; ++tServoIndex) {
-//        aSerial->print(sServoNextPositionArray[tServoIndex]);
-//        aSerial->print(F(" | "));
-//    }
-    for (uint_fast8_t tServoIndex = 0; tServoIndex <= sServoArrayMaxIndex; ++tServoIndex) {
-        aSerial->print(sServoNextPositionArray[tServoIndex]);
-        aSerial->print(F(" | "));
+/**
+ * Prints the recorded pulses, oldest first, as "millis index microseconds"
+ */
+void printSimulationRecords(Print * aSerial) {
+    uint16_t tIndex = 0;
+    uint16_t tNumberOfRecords = sSimulationWriteIndex;
+    if (sSimulationRecordArrayIsFull) {
+        tIndex = sSimulationWriteIndex; // oldest record
+        tNumberOfRecords = SIMULATION_DRIVER_NUMBER_OF_RECORDS;
     }
-    aSerial->println();
-}
-
-void writeAllServos(int aValue) {
-    for (uint_fast8_t tServoIndex = 0; tServoIndex <= sServoArrayMaxIndex; ++tServoIndex) {
-        if (sServoArray[tServoIndex] != NULL) {
-            sServoArray[tServoIndex]->write(aValue);
+    for (uint16_t i = 0; i < tNumberOfRecords; ++i) {
+        ServoEasingSimulationRecord * tRecord = &sSimulationRecordArray[tIndex];
+        if (++tIndex >= SIMULATION_DRIVER_NUMBER_OF_RECORDS) {
+            tIndex = 0;
         }
+        aSerial->print(tRecord->Millis);
+        aSerial->print(' ');
+        aSerial->print(tRecord->ServoIndex);
+        aSerial->print(' ');
+        aSerial->println(tRecord->Microseconds);
     }
 }
+#endif // defined(ENABLE_SERVO_DRIVER_INTERFACE)
 
-void setSpeedForAllServos(uint_fast16_t aDegreesPerSecond) {
-    for (uint_fast8_t tServoIndex = 0; tServoIndex <= sServoArrayMaxIndex; ++tServoIndex) {
-        if (sServoArray[tServoIndex] != NULL) {
-            sServoArray[tServoIndex]->mSpeed = aDegreesPerSecond;
-        }
-    }
+#if defined(USE_PCA9685_SERVO_EXPANDER)
+/************************************
+ * Compact servos for PCA9685 expanders
+ ***********************************/
+ServoEasingPackedProfile * sPackedServoProfileArray[PACKED_SERVO_MAX_PROFILES];
+ServoEasingPacked * sPackedServoArray = NULL; // array of packed servos updated by updateAllServos()
+uint8_t sNumberOfPackedServos = 0;
+
+static void PCA9685WriteByte(TwoWire * aI2CClass, uint8_t aPCA9685I2CAddress, uint8_t aAddress, uint8_t aData) {
+    aI2CClass->beginTransmission(aPCA9685I2CAddress);
+    aI2CClass->write(aAddress);
+    aI2CClass->write(aData);
+    aI2CClass->endTransmission();
 }
 
-#if defined(va_arg)
-/*
- * Sets the sServoNextPositionArray[] of the first aNumberOfServos to the specified values
+/**
+ * Sets the profile for all packed servos attached with aProfileIndex and initializes its expander.
+ * The profile must be global, since only the pointer is stored.
  */
-void setDegreeForAllServos(uint_fast8_t aNumberOfServos, va_list * aDegreeValues) {
-    for (uint_fast8_t tServoIndex = 0; tServoIndex < aNumberOfServos; ++tServoIndex) {
-        sServoNextPositionArray[tServoIndex] = va_arg(*aDegreeValues, int);
+void setPackedServoProfile(uint_fast8_t aProfileIndex, ServoEasingPackedProfile * aProfile, uint8_t aPCA9685I2CAddress,
+        int aMicrosecondsForServo0Degree, int aMicrosecondsForServo180Degree, TwoWire * aI2CClass) {
+    if (aProfileIndex >= PACKED_SERVO_MAX_PROFILES) {
+        return;
     }
+    aProfile->I2CClass = aI2CClass;
+    aProfile->PCA9685I2CAddress = aPCA9685I2CAddress;
+    aProfile->Servo0DegreeUnits = (4096L * aMicrosecondsForServo0Degree) / REFRESH_INTERVAL_MICROS;
+    aProfile->Servo180DegreeUnits = (4096L * aMicrosecondsForServo180Degree) / REFRESH_INTERVAL_MICROS;
+    sPackedServoProfileArray[aProfileIndex] = aProfile;
+
+    initializePCA9685Bus(aI2CClass);
+    // Same as ServoEasing::PCA9685Init()
+    PCA9685WriteByte(aI2CClass, aPCA9685I2CAddress, PCA9685_MODE1_REGISTER, _BV(PCA9685_MODE_1_SLEEP)); // go to sleep
+    PCA9685WriteByte(aI2CClass, aPCA9685I2CAddress, PCA9685_PRESCALE_REGISTER, PCA9685_PRESCALER_FOR_20_MS); // set the prescaler
+    PCA9685WriteByte(aI2CClass, aPCA9685I2CAddress, PCA9685_MODE1_REGISTER, _BV(PCA9685_MODE_1_AUTOINCREMENT)); // reset sleep and enable auto increment
+    delay(2); // > 500 us according to datasheet
 }
-#endif
 
-#if defined(va_start)
-/*
- * Sets the sServoNextPositionArray[] of the first aNumberOfServos to the specified values
+/**
+ * The packed servos of this array are updated by updateAllServos() and therefore by the interrupt.
  */
-void setDegreeForAllServos(uint_fast8_t aNumberOfServos, ...) {
-    va_list aDegreeValues;
-    va_start(aDegreeValues, aNumberOfServos);
-    setDegreeForAllServos(aNumberOfServos, &aDegreeValues);
-    va_end(aDegreeValues);
+void setPackedServoArray(ServoEasingPacked * aPackedServoArray, uint8_t aNumberOfPackedServos) {
+    sPackedServoArray = aPackedServoArray;
+    sNumberOfPackedServos = aNumberOfPackedServos;
 }
-#endif
 
 /*
- * Sets target position using content of sServoNextPositionArray
- * returns false if one servo was still moving
+ * Called by updateAllServos()
+ * @return true if all packed servos stopped
  */
-bool setEaseToForAllServos() {
-    bool tOneServoIsMoving = false;
-    for (uint_fast8_t tServoIndex = 0; tServoIndex <= sServoArrayMaxIndex; ++tServoIndex) {
-        if (sServoArray[tServoIndex] != NULL) {
-            tOneServoIsMoving = sServoArray[tServoIndex]->setEaseTo(sServoNextPositionArray[tServoIndex],
-                    sServoArray[tServoIndex]->mSpeed) || tOneServoIsMoving;
-        }
+bool updateAllPackedServos() {
+    bool tAllServosStopped = true;
+    for (uint_fast8_t tServoIndex = 0; tServoIndex < sNumberOfPackedServos; ++tServoIndex) {
+        tAllServosStopped = sPackedServoArray[tServoIndex].update() && tAllServosStopped;
     }
-    return tOneServoIsMoving;
+    return tAllServosStopped;
 }
 
-bool setEaseToForAllServos(uint_fast16_t aDegreesPerSecond) {
-    bool tOneServoIsMoving = false;
-    for (uint_fast8_t tServoIndex = 0; tServoIndex <= sServoArrayMaxIndex; ++tServoIndex) {
-        if (sServoArray[tServoIndex] != NULL) {
-            tOneServoIsMoving = sServoArray[tServoIndex]->setEaseTo(sServoNextPositionArray[tServoIndex], aDegreesPerSecond)
-                    || tOneServoIsMoving;
+/*
+ * Called by isOneServoMoving() and stopAllServos() of the default engine
+ */
+bool isOnePackedServoMoving() {
+    for (uint_fast8_t tServoIndex = 0; tServoIndex < sNumberOfPackedServos; ++tServoIndex) {
+        if (sPackedServoArray[tServoIndex].mServoMoves) {
+            return true;
         }
     }
-    return tOneServoIsMoving;
+    return false;
 }
 
-bool setEaseToDForAllServos(uint_fast16_t aMillisForMove) {
-    bool tOneServoIsMoving = false;
-    for (uint_fast8_t tServoIndex = 0; tServoIndex <= sServoArrayMaxIndex; ++tServoIndex) {
-        if (sServoArray[tServoIndex] != NULL) {
-            tOneServoIsMoving = sServoArray[tServoIndex]->setEaseToD(sServoNextPositionArray[tServoIndex], aMillisForMove)
-                    || tOneServoIsMoving;
-        }
+void stopAllPackedServos() {
+    for (uint_fast8_t tServoIndex = 0; tServoIndex < sNumberOfPackedServos; ++tServoIndex) {
+        sPackedServoArray[tServoIndex].mServoMoves = false;
     }
-    return tOneServoIsMoving;
 }
 
-bool isOneServoMoving() {
-    for (uint_fast8_t tServoIndex = 0; tServoIndex <= sServoArrayMaxIndex; ++tServoIndex) {
-        if (sServoArray[tServoIndex] != NULL && sServoArray[tServoIndex]->mServoMoves) {
-            return true;
-        }
+/**
+ * The profile must be set before by setPackedServoProfile().
+ * Does not write to the servo, so call write() afterwards to set the start position.
+ * @return false if the profile is not set. Then the servo must not be used.
+ */
+bool ServoEasingPacked::attach(uint_fast8_t aPCA9685Channel, uint_fast8_t aProfileIndex) {
+    if (aProfileIndex >= PACKED_SERVO_MAX_PROFILES || sPackedServoProfileArray[aProfileIndex] == NULL) {
+#if defined(DEBUG)
+        Serial.println(F("Error: profile not set by setPackedServoProfile()"));
+#endif
+        mServoMoves = false;
+        return false;
     }
-    return false;
+    mPCA9685Channel = aPCA9685Channel;
+    mProfileIndex = aProfileIndex;
+    mOperateServoReverse = false;
+    mServoMoves = false;
+    mEasingType = EASE_LINEAR;
+    mCurrentUnits = DegreeToUnits(90);
+    return true;
 }
 
-void stopAllServos() {
-    void disableServoEasingInterrupt();
-    for (uint_fast8_t tServoIndex = 0; tServoIndex <= sServoArrayMaxIndex; ++tServoIndex) {
-        if (sServoArray[tServoIndex] != NULL) {
-            sServoArray[tServoIndex]->mServoMoves = false;
-        }
-    }
+void ServoEasingPacked::setReverseOperation(bool aOperateServoReverse) {
+    mOperateServoReverse = aOperateServoReverse;
 }
 
+#ifndef PROVIDE_ONLY_LINEAR_MOVEMENT
 /*
- * returns true if all Servos reached endAngle / stopped
+ * User easing types are not supported
  */
-bool updateAllServos() {
-    bool tAllServosStopped = true;
-    for (uint_fast8_t tServoIndex = 0; tServoIndex <= sServoArrayMaxIndex; ++tServoIndex) {
-        if (sServoArray[tServoIndex] != NULL) {
-            tAllServosStopped = sServoArray[tServoIndex]->update() && tAllServosStopped;
-        }
-    }
-#if defined(PRINT_FOR_SERIAL_PLOTTER)
-// End of one data set
-    Serial.println();
+void ServoEasingPacked::setEasingType(uint_fast8_t aEasingType) {
+    mEasingType = aEasingType;
+}
 #endif
-    return tAllServosStopped;
+
+int ServoEasingPacked::DegreeToUnits(int aDegree) {
+    ServoEasingPackedProfile * tProfile = sPackedServoProfileArray[mProfileIndex];
+    return tProfile->Servo0DegreeUnits
+            + (((int32_t) aDegree * (tProfile->Servo180DegreeUnits - tProfile->Servo0DegreeUnits)) / 180);
 }
 
-void updateAndWaitForAllServosToStop() {
-    do {
-        // First do the delay, then check for update, since we are likely called directly after start and there is nothing to move yet
-        delay(REFRESH_INTERVAL_MILLIS); // 20 ms
-    } while (!updateAllServos());
+int ServoEasingPacked::UnitsToDegree(int aUnits) {
+    ServoEasingPackedProfile * tProfile = sPackedServoProfileArray[mProfileIndex];
+    return ((int32_t) (aUnits - tProfile->Servo0DegreeUnits) * 180) / (tProfile->Servo180DegreeUnits - tProfile->Servo0DegreeUnits);
+}
+
+int ServoEasingPacked::getCurrentAngle() {
+    return UnitsToDegree(mCurrentUnits);
+}
+
+void ServoEasingPacked::write(int aDegree) {
+    writeUnits(DegreeToUnits(aDegree));
 }
 
 /*
- * returns true if all Servos reached endAngle / stopped
+ * Applies reverse and writes to the expander. Pulses are distributed over the 20 ms period like for ServoEasing.
  */
-bool delayAndUpdateAndWaitForAllServosToStop(unsigned long aMillisDelay, bool aTerminateDelayIfAllServosStopped) {
-    while (true) {
-        // First do the delay, then check for update, since we are likely called directly after start and there is nothing to move yet
-        if (aMillisDelay > REFRESH_INTERVAL_MILLIS) {
-            aMillisDelay -= REFRESH_INTERVAL_MILLIS;
-            delay(REFRESH_INTERVAL_MILLIS); // 20 ms
-            if (updateAllServos() && aTerminateDelayIfAllServosStopped) {
-                // terminate delay here and return
-                return true;
-            }
-        } else {
-            delay(aMillisDelay);
-            return updateAllServos();
+void ServoEasingPacked::writeUnits(int aUnits) {
+    // Overshooting easings may give values out of range of the 12 bit field
+    if (aUnits < 0) {
+        aUnits = 0;
+    } else if (aUnits > 4095) {
+        aUnits = 4095;
+    }
+    mCurrentUnits = aUnits;
+
+    ServoEasingPackedProfile * tProfile = sPackedServoProfileArray[mProfileIndex];
+    if (mOperateServoReverse) {
+        aUnits = (tProfile->Servo0DegreeUnits + tProfile->Servo180DegreeUnits) - aUnits;
+    }
+#if defined(ENABLE_PCA9685_BURST_WRITE)
+    if (bufferPCA9685PWM(tProfile->I2CClass, tProfile->PCA9685I2CAddress, mPCA9685Channel, aUnits)) {
+        return;
+    }
+#endif
+#if defined(ENABLE_PCA9685_SHADOW_REGISTERS)
+    clearBufferedPCA9685PWM(tProfile->I2CClass, tProfile->PCA9685I2CAddress, mPCA9685Channel);
+#endif
+    uint16_t tOnValue = mPCA9685Channel * ((4096 - (DEFAULT_PCA9685_UNITS_FOR_180_DEGREE + 100)) / 15);
+    TwoWire * tI2CClass = tProfile->I2CClass;
+    tI2CClass->beginTransmission(tProfile->PCA9685I2CAddress);
+    tI2CClass->write((PCA9685_FIRST_PWM_REGISTER) + 4 * mPCA9685Channel);
+    tI2CClass->write(tOnValue);
+    tI2CClass->write(tOnValue >> 8);
+    tI2CClass->write(tOnValue + aUnits);
+    tI2CClass->write((tOnValue + aUnits) >> 8);
+    tI2CClass->endTransmission();
+}
+
+bool ServoEasingPacked::startEaseTo(int aDegree, uint_fast16_t aDegreesPerSecond, bool aStartUpdateByInterrupt) {
+    int tDegreeDelta = aDegree - getCurrentAngle();
+    if (tDegreeDelta < 0) {
+        tDegreeDelta = -tDegreeDelta;
+    }
+    if (aDegreesPerSecond == 0) {
+        aDegreesPerSecond = 1;
+    }
+    uint32_t tMillisForMove = ((uint32_t) tDegreeDelta * 1000) / aDegreesPerSecond;
+    if (tMillisForMove > 0xFFFF) {
+        tMillisForMove = 0xFFFF; // only 16 bit are stored, so 65 seconds is the slowest move
+    }
+    return startEaseToD(aDegree, tMillisForMove, aStartUpdateByInterrupt);
+}
+
+/**
+ * @return false if servo was still moving
+ */
+bool ServoEasingPacked::startEaseToD(int aDegree, uint16_t aMillisForMove, bool aStartUpdateByInterrupt) {
+    bool tReturnValue = !mServoMoves;
+    mServoMoves = false; // move parameters are changed now
+    mStartUnits = mCurrentUnits;
+    mDeltaUnits = DegreeToUnits(aDegree) - mCurrentUnits;
+    mMillisForCompleteMove = aMillisForMove;
+    mMillisAtStartMove = sServoEasingDefaultEngine.getMillis(); // packed servos are updated by the default engine
+    if (mDeltaUnits != 0) {
+        mServoMoves = true;
+        if (aStartUpdateByInterrupt && !sInterruptsAreActive) {
+            enableServoEasingInterrupt();
         }
     }
+    return tReturnValue;
 }
 
-void synchronizeAllServosStartAndWaitForAllServosToStop() {
-    synchronizeAllServosAndStartInterrupt(false);
-    updateAndWaitForAllServosToStop();
+void ServoEasingPacked::stop() {
+    mServoMoves = false;
+}
+
+bool ServoEasingPacked::isMoving() {
+    return mServoMoves;
 }
 
 /*
- * Take the longer duration in order to move all servos synchronously
+ * @return true if servo stopped
  */
-void synchronizeAllServosAndStartInterrupt(bool aStartUpdateByInterrupt) {
-    /*
-     * Find maximum duration and one start time
-     */
-    uint_fast16_t tMaxMillisForCompleteMove = 0;
-    uint32_t tMillisAtStartMove = 0;
-
-    for (uint_fast8_t tServoIndex = 0; tServoIndex <= sServoArrayMaxIndex; ++tServoIndex) {
-        if (sServoArray[tServoIndex] != NULL && sServoArray[tServoIndex]->mServoMoves) {
-            //process servos which really moves
-            tMillisAtStartMove = sServoArray[tServoIndex]->mMillisAtStartMove;
-            if (sServoArray[tServoIndex]->mMillisForCompleteMove > tMaxMillisForCompleteMove) {
-                tMaxMillisForCompleteMove = sServoArray[tServoIndex]->mMillisForCompleteMove;
-            }
+bool ServoEasingPacked::update() {
+    if (!mServoMoves) {
+        return true;
+    }
+    uint16_t tMillisSinceStart = (uint16_t) sServoEasingDefaultEngine.getMillis() - mMillisAtStartMove;
+    if (tMillisSinceStart >= mMillisForCompleteMove) {
+        int tEndUnits = mStartUnits + mDeltaUnits;
+#ifndef PROVIDE_ONLY_LINEAR_MOVEMENT
+        if ((mEasingType & CALL_STYLE_MASK) == CALL_STYLE_BOUNCING_OUT_IN) {
+            tEndUnits = mStartUnits; // bouncing moves end at start position
         }
+#endif
+        writeUnits(tEndUnits);
+        mServoMoves = false;
+        return true;
     }
 
-#if defined(TRACE)
-    Serial.print(F("Number of servos="));
-    Serial.print(sServoArrayMaxIndex);
-    Serial.print(F(" MillisAtStartMove="));
-    Serial.print(tMillisAtStartMove);
-    Serial.print(F(" MaxMillisForCompleteMove="));
-    Serial.println(tMaxMillisForCompleteMove);
+    int tNewUnits;
+#ifndef PROVIDE_ONLY_LINEAR_MOVEMENT
+    if (mEasingType != EASE_LINEAR) {
+        float tEaseResult = callIncludedEasingFunctionWithCallStyle(mEasingType,
+                (float) tMillisSinceStart / (float) mMillisForCompleteMove);
+        tNewUnits = mStartUnits + (int) (mDeltaUnits * tEaseResult);
+    } else
 #endif
+    {
+        tNewUnits = mStartUnits + (((int32_t) mDeltaUnits * tMillisSinceStart) / mMillisForCompleteMove);
+    }
+    if (tNewUnits != (int) mCurrentUnits) {
+        writeUnits(tNewUnits);
+    }
+    return false;
+}
+#endif // defined(USE_PCA9685_SERVO_EXPANDER)
 
-    /*
-     * Set maximum duration and start time to all servos
-     * Synchronize start time to avoid race conditions at the end of movement
-     */
-    for (uint_fast8_t tServoIndex = 0; tServoIndex <= sServoArrayMaxIndex; ++tServoIndex) {
-        if (sServoArray[tServoIndex] != NULL && sServoArray[tServoIndex]->mServoMoves) {
-            sServoArray[tServoIndex]->mMillisAtStartMove = tMillisAtStartMove;
-            sServoArray[tServoIndex]->mMillisForCompleteMove = tMaxMillisForCompleteMove;
-        }
+/*
+ * Included easing functions without user functions
+ */
+float callIncludedEasingFunction(uint_fast8_t aEasingType, float aPercentageOfCompletion) {
+    switch (aEasingType & EASE_TYPE_MASK) {
+    case EASE_QUADRATIC_IN:
+        return QuadraticEaseIn(aPercentageOfCompletion);
+    case EASE_CUBIC_IN:
+        return CubicEaseIn(aPercentageOfCompletion);
+    case EASE_QUARTIC_IN:
+        return QuarticEaseIn(aPercentageOfCompletion);
+#ifndef KEEP_SERVO_EASING_LIBRARY_SMALL
+    case EASE_SINE_IN:
+        return SineEaseIn(aPercentageOfCompletion);
+    case EASE_CIRCULAR_IN:
+        return CircularEaseIn(aPercentageOfCompletion);
+    case EASE_BACK_IN:
+        return BackEaseIn(aPercentageOfCompletion);
+    case EASE_ELASTIC_IN:
+        return ElasticEaseIn(aPercentageOfCompletion);
+    case EASE_BOUNCE_OUT:
+        return EaseOutBounce(aPercentageOfCompletion);
+#endif
+    default:
+        return 0.0;
     }
+}
 
-    if (aStartUpdateByInterrupt) {
-        enableServoEasingInterrupt();
+/*
+ * Same as the float computation in ServoEasing::update() for included easing functions
+ */
+float callIncludedEasingFunctionWithCallStyle(uint_fast8_t aEasingType, float aPercentageOfCompletion) {
+    uint_fast8_t tCallStyle = aEasingType & CALL_STYLE_MASK;
+    if (tCallStyle == CALL_STYLE_DIRECT) {
+        return callIncludedEasingFunction(aEasingType, aPercentageOfCompletion);
+    } else if (tCallStyle == CALL_STYLE_OUT) {
+        return 1.0 - callIncludedEasingFunction(aEasingType, 1.0 - aPercentageOfCompletion);
+    } else if (tCallStyle == CALL_STYLE_IN_OUT) {
+        if (aPercentageOfCompletion <= 0.5) {
+            return 0.5 * callIncludedEasingFunction(aEasingType, 2.0 * aPercentageOfCompletion);
+        }
+        return 1.0 - (0.5 * callIncludedEasingFunction(aEasingType, 2.0 - (2.0 * aPercentageOfCompletion)));
+    } else {
+        // CALL_STYLE_BOUNCING_OUT_IN
+        if (aPercentageOfCompletion <= 0.5) {
+            return 1.0 - callIncludedEasingFunction(aEasingType, 1.0 - (2.0 * aPercentageOfCompletion));
+        }
+        return 1.0 - callIncludedEasingFunction(aEasingType, (2.0 * aPercentageOfCompletion) - 1.0);
     }
 }
 
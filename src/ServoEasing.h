@@ -127,6 +127,14 @@
 #  endif
 #endif // ! defined(MAX_EASING_SERVOS)
 
+/*
+ * The library and all files including ServoEasing.h must be compiled with the same MAX_EASING_SERVOS.
+ * Otherwise the linker reports an undefined reference to ServoEasing::ServoEasing(MaxEasingServosMustBeEqualForAllFiles<n>*).
+ * Then define MAX_EASING_SERVOS globally e.g. with -DMAX_EASING_SERVOS=<n> or change it here.
+ */
+template<int aMaxEasingServos> struct MaxEasingServosMustBeEqualForAllFiles {
+};
+
 #if ! defined(REFRESH_INTERVAL)
 #define REFRESH_INTERVAL 20000   // // minimum time to refresh servos in microseconds (from Servo.h)
 #endif
@@ -151,6 +159,127 @@
  */
 //#define PROVIDE_ONLY_LINEAR_MOVEMENT
 
+/*
+ * Define `ENABLE_SLEW_RATE_LIMITED_WRITE` to enable setSlewRateLimit().
+ * Then write() and writeMicrosecondsOrUnits() only set a target, which is approached in update() / the interrupt
+ * with limited speed and acceleration. Useful if servos are driven directly from a potentiometer or sensor.
+ * This costs 13 bytes RAM per servo.
+ */
+//#define ENABLE_SLEW_RATE_LIMITED_WRITE
+
+/*
+ * Define `ENABLE_INPUT_FILTER` to enable setInputFilter().
+ * Then the values of write() and writeMicrosecondsOrUnits() are smoothed by an integer filter in update() / the interrupt,
+ * to suppress jitter of noisy inputs like potentiometers or sensors. Can be combined with `ENABLE_SLEW_RATE_LIMITED_WRITE`.
+ * This costs 14 bytes RAM per servo.
+ */
+//#define ENABLE_INPUT_FILTER
+
+/*
+ * Define `ENABLE_MIN_AND_MAX_CONSTRAINTS` to enable setMinMaxConstraint().
+ * Then all values written to the servo, including overshoots of Back and Elastic easings and values changed by trim, are clamped to these limits.
+ * This costs 10 bytes RAM per servo.
+ */
+//#define ENABLE_MIN_AND_MAX_CONSTRAINTS
+
+/*
+ * Define `ENABLE_CALIBRATION_TABLE` to enable setCalibrationTable() for a piecewise linear degree to microseconds mapping
+ * for servos with a nonlinear characteristic. This costs 2 bytes RAM per servo plus the RAM for each table used.
+ */
+//#define ENABLE_CALIBRATION_TABLE
+
+/*
+ * Define `ENABLE_VELOCITY_MODE` to enable setVelocityModeParameters() and setVelocity() for continuous rotating servos.
+ * The velocity is then ramped with limited acceleration by update() / the interrupt, and the deadband around the stop pulse is skipped.
+ * This costs 12 bytes RAM per servo.
+ */
+//#define ENABLE_VELOCITY_MODE
+
+/*
+ * Define `ENABLE_DEAD_RECKONING` to enable an estimate of the angle of a continuous rotating servo in velocity mode
+ * and rotateBy() based on this estimate. Requires a speed calibration by setVelocityCalibration().
+ * This costs additional 21 bytes RAM per servo.
+ */
+//#define ENABLE_DEAD_RECKONING
+#if defined(ENABLE_DEAD_RECKONING) && !defined(ENABLE_VELOCITY_MODE)
+#define ENABLE_VELOCITY_MODE
+#endif
+
+/*
+ * Define `ENABLE_IDLE_POWER_OFF` to enable setIdlePowerOffMillis().
+ * Then the servo pulse is switched off, if the servo was not written for the specified time, to save power and avoid buzzing of servos.
+ * The next write re-engages the servo without the cost of attach().
+ * A write starts the interrupt, which keeps running every 20 ms until the servo is powered off.
+ * This costs 13 bytes RAM per servo.
+ */
+//#define ENABLE_IDLE_POWER_OFF
+
+/*
+ * Define `ENABLE_SERVO_EASING_ENGINES` to enable servos to use their own ServoEasingEngine set by setEngine() instead of the default engine.
+ * Each engine has its own list of servos, clock and update function, so independent sets of servos can be updated
+ * e.g. by another timer or by a task running on the other core of an ESP32.
+ * This costs 2 bytes RAM per servo on AVR and an indirect call of millis() and of the servo list functions.
+ */
+//#define ENABLE_SERVO_EASING_ENGINES
+
+/*
+ * Define `ENABLE_POSITION_SNAPSHOT` to enable saveServoPositionSnapshot() and restoreServoPositionSnapshot().
+ * The snapshot contains the last position, trim and reverse of all servos and is stored with a CRC in a ring of EEPROM slots.
+ * Saving is explicit and only writes, if positions, trim or reverse changed since the newest snapshot.
+ * This costs SNAPSHOT_NUMBER_OF_SLOTS * (5 + 5 * MAX_EASING_SERVOS) bytes EEPROM, starting at SNAPSHOT_EEPROM_START_ADDRESS.
+ */
+//#define ENABLE_POSITION_SNAPSHOT
+
+/*
+ * Define `ENABLE_CALIBRATION_STORE` to store 0 and 180 degree values, trim, reverse, min and max constraint, speed and slew rate limit
+ * of all servos with saveCalibrationStore() in one versioned EEPROM record with a CRC.
+ * attach() applies the stored values of its servo index, so no sketch specific EEPROM code is required.
+ * The record is checked only once at the first attach(), then each attach() reads only its own entry.
+ * This costs 4 + 17 * MAX_EASING_SERVOS bytes EEPROM, starting at CALIBRATION_STORE_EEPROM_START_ADDRESS.
+ */
+//#define ENABLE_CALIBRATION_STORE
+
+/*
+ * Define `ENABLE_SERVO_DRIVER_INTERFACE` to enable setDriver(), which sets a table of driver functions for a servo.
+ * This allows to mix different expanders, native servo pins and custom outputs in one sketch.
+ * Servos without a driver table use the driver selected by USE_PCA9685_SERVO_EXPANDER etc.
+ * The table ServoEasingSimulationDriver records the pulses in a RAM buffer, e.g. for testing on a host.
+ * This costs 2 bytes RAM per servo on AVR and one pointer check for each write.
+ */
+//#define ENABLE_SERVO_DRIVER_INTERFACE
+
+/*
+ * Define `ENABLE_PCA9685_BURST_WRITE` to collect the PCA9685 values written by updateAllServos() of the default engine
+ * and send them at its end with one auto increment I2C transfer for each range of contiguous changed channels of an expander.
+ * The number of channels in one transfer is limited by the buffer size of the Wire library, e.g. 7 channels for 32 bytes on AVR.
+ * This costs 37 bytes RAM for each expander on AVR.
+ */
+//#define ENABLE_PCA9685_BURST_WRITE
+
+/*
+ * Define `ENABLE_PCA9685_SHADOW_REGISTERS` to keep a copy of the PWM registers of each expander and let the burst write
+ * send only the register bytes which changed. The ON registers of a channel never change and the high byte of OFF rarely changes.
+ * This implies ENABLE_PCA9685_BURST_WRITE and costs additional 34 bytes RAM for each expander.
+ */
+//#define ENABLE_PCA9685_SHADOW_REGISTERS
+
+/*
+ * Define `ENABLE_PCA9685_ALL_LED_WRITE` to send the values of writeAllServos() and detachAllServos() with one ALL_LED transfer
+ * for each expander, whose 16 channels are all used by servos and get the same pulse. Then the ON times are no longer distributed
+ * over the 20 ms period until the next move of each servo.
+ * It also enables emergencyStopAllServos(), which switches all outputs of the used expanders off with one transfer for each expander.
+ * This implies ENABLE_PCA9685_BURST_WRITE.
+ */
+//#define ENABLE_PCA9685_ALL_LED_WRITE
+#if (defined(ENABLE_PCA9685_SHADOW_REGISTERS) || defined(ENABLE_PCA9685_ALL_LED_WRITE)) && !defined(ENABLE_PCA9685_BURST_WRITE)
+#define ENABLE_PCA9685_BURST_WRITE
+#endif
+
+// Internal: write() only sets a target, which is processed by update()
+#if defined(ENABLE_SLEW_RATE_LIMITED_WRITE) || defined(ENABLE_INPUT_FILTER)
+#define ENABLE_WRITE_TARGET_TRACKING
+#endif
+
 // Enable this if you want to measure timing by toggling pin12 on an arduino
 //#define MEASURE_SERVO_EASING_INTERRUPT_TIMING
 #if defined(MEASURE_SERVO_EASING_INTERRUPT_TIMING)
@@ -180,6 +309,33 @@
 // @formatter:on
 
 /*
+ * Version 2.4.0 - work in progress
+ * - Added `startEaseToArrayPositions()` and `startEaseToArrayPositions_P()` to set up, synchronize and start all servos in one pass.
+ * - Added `setSlewRateLimit()` for write() with limited speed and acceleration, enabled by `ENABLE_SLEW_RATE_LIMITED_WRITE`.
+ * - Added `setInputFilter()` with IIR, one euro and deadband integer filters for write(), enabled by `ENABLE_INPUT_FILTER`.
+ * - Added user easing functions with user data pointer `registerUserEaseInFunctionWithUserData()` and `registerUserEaseInFunctionFixedPoint()` for float free user functions.
+ * - Added `startGroupMoveD()` for coupled moves of servo groups computed by one user function per update.
+ * - Added `setMinMaxConstraint()` to clamp all servo values, enabled by `ENABLE_MIN_AND_MAX_CONSTRAINTS`.
+ * - Added `setCalibrationTable()` for nonlinear degree to microseconds mapping, enabled by `ENABLE_CALIBRATION_TABLE`.
+ * - Degree conversions and trim and reverse now use factors and offsets computed at attach(), setTrim() and setReverseOperation().
+ * - Degree conversions now round, so a result may differ by 1 microsecond, unit or degree from version 2.3.2.
+ * - Added `setVelocity()` for continuous rotating servos with acceleration limit and deadband compensation, enabled by `ENABLE_VELOCITY_MODE`.
+ * - Added angle estimate and `rotateBy()` for continuous rotating servos, enabled by `ENABLE_DEAD_RECKONING`.
+ * - Added `setIdlePowerOffMillis()` to switch off the pulse of idle servos, enabled by `ENABLE_IDLE_POWER_OFF`.
+ * - `updateAllServos()`, `isOneServoMoving()` and `synchronizeAllServosAndStartInterrupt()` only process started servos, which are found by count trailing zeros in a mask of MAX_EASING_SERVOS bits.
+ * - attach() and detach() use a list of free servo indexes. Different MAX_EASING_SERVOS for library and sketch give a linker error.
+ * - Added class `ServoEasingPacked` with 11 bytes RAM per servo for PCA9685 expanders.
+ * - Servo list, clock and interrupt start are now part of class `ServoEasingEngine`. Multiple engines are enabled by `ENABLE_SERVO_EASING_ENGINES`.
+ * - Added class `ServoEasingGroup` to synchronize, stop and update groups of servos independently.
+ * - Added `saveServoPositionSnapshot()` and `restoreServoPositionSnapshot()` to start without a jump after power up, enabled by `ENABLE_POSITION_SNAPSHOT`.
+ * - Added calibration store in EEPROM which is applied at `attach()` and a dump tool in extras, enabled by `ENABLE_CALIBRATION_STORE`.
+ * - Driver specific code moved from `#if` blocks into compile time selected driver structs.
+ * - Added driver function tables for each servo and a simulation driver, enabled by `ENABLE_SERVO_DRIVER_INTERFACE`.
+ * - Added burst write of all changed PCA9685 channels at the end of `updateAllServos()`, enabled by `ENABLE_PCA9685_BURST_WRITE`.
+ * - Added PCA9685 shadow registers to send only changed register bytes, enabled by `ENABLE_PCA9685_SHADOW_REGISTERS`.
+ * - Added `detachAllServos()`, and PCA9685 ALL_LED writes for identical values and `emergencyStopAllServos()`, enabled by `ENABLE_PCA9685_ALL_LED_WRITE`.
+ * - Added host tests in extras/HostTest.
+ *
  * Version 2.3.2 - 9/2020
  * - Removed blocking wait for ATmega32U4 Serial in examples.
  * - Improved output for Arduino Serial Plotter.
@@ -382,6 +538,15 @@
 #define EASE_USER_BOUNCING      0x6F
 
 #define EASE_FUNCTION_DEGREE_INDICATOR_OFFSET 256 // Offset to decide if the user function returns degree instead of 0.0 to 1.0. => returns 256 for 0 degree.
+#define EASE_FIXED_POINT_ONE    0x4000 // 1.0 for registerUserEaseInFunctionFixedPoint(). Allows results from -2.0 (-0x8000) to 1.99994 (0x7FFF).
+
+#if defined(ENABLE_INPUT_FILTER)
+// Filter types for setInputFilter()
+#define INPUT_FILTER_NONE       0x00
+#define INPUT_FILTER_IIR        0x01 // Exponential smoothing. Parameter is shift, 1 to 4 is sensible.
+#define INPUT_FILTER_ONE_EURO   0x02 // Like IIR, but the less smoothing the faster the input changes
+#define INPUT_FILTER_DEADBAND   0x03 // Ignore changes smaller or equal parameter
+#endif
 
 // some PCA9685 specific constants
 #define PCA9685_GENERAL_CALL_ADDRESS 0x00
@@ -393,10 +558,118 @@
 #define PCA9685_MODE_1_AUTOINCREMENT  5
 #define PCA9685_MODE_1_SLEEP          4
 #define PCA9685_FIRST_PWM_REGISTER  0x06
+#define PCA9685_ALL_LED_ON_L_REGISTER 0xFA // followed by ALL_LED_ON_H, ALL_LED_OFF_L and ALL_LED_OFF_H
 #define PCA9685_PRESCALE_REGISTER   0xFE
 
+#define PCA9685_FULL_OFF_VALUE      4096 // Bit 4 of OFF_H register -> output is always off
+
 #define PCA9685_PRESCALER_FOR_20_MS ((25000000L /(4096L * 50))-1) // = 121 / 0x79 at 50 Hz
 
+#if defined(USE_PCA9685_SERVO_EXPANDER)
+#  if !defined(PCA9685_MAX_I2C_BUSES)
+#define PCA9685_MAX_I2C_BUSES       2 // Number of I2C buses with PCA9685 expanders, e.g. Wire and Wire1
+#  endif
+bool initializePCA9685Bus(TwoWire * aI2CClass);
+#endif
+
+#if defined(USE_PCA9685_SERVO_EXPANDER) && defined(ENABLE_PCA9685_BURST_WRITE)
+#  if !defined(PCA9685_BURST_MAX_EXPANDERS)
+#define PCA9685_BURST_MAX_EXPANDERS     ((MAX_EASING_SERVOS + (PCA9685_MAX_CHANNELS - 1)) / PCA9685_MAX_CHANNELS)
+#  endif
+#  if !defined(PCA9685_MAX_BYTES_PER_BURST)
+// 1 register address byte and the register bytes must fit into the buffer of the Wire library
+#    if defined(I2C_BUFFER_LENGTH)
+#define PCA9685_MAX_BYTES_PER_BURST     (I2C_BUFFER_LENGTH - 1)
+#    elif defined(BUFFER_LENGTH)
+#define PCA9685_MAX_BYTES_PER_BURST     (BUFFER_LENGTH - 1)
+#    else
+#define PCA9685_MAX_BYTES_PER_BURST     31 // for the 32 bytes buffer of AVR
+#    endif
+#  endif
+#define PCA9685_MAX_CHANNELS_PER_BURST  (PCA9685_MAX_BYTES_PER_BURST / 4) // 7 for AVR
+#define PCA9685_ALL_CHANNELS            0xFF // for clearBufferedPCA9685PWM()
+#  if !defined(PCA9685_MAX_GAP_BYTES)
+// Unchanged bytes between changed ones are sent instead of starting a new transfer with I2C address and register address.
+// 2 gives the minimal bus time, but each new transfer also costs the fixed CPU time of a Wire transaction.
+// 3 sends the OFF_L bytes of adjacent channels, which are 3 bytes apart, in one transfer.
+// For 32 moving servos this gives 4 instead of 31 transactions per update for 20% more bus time.
+#define PCA9685_MAX_GAP_BYTES           3
+#  endif
+struct PCA9685BurstBuffer {
+    TwoWire * I2CClass; // NULL -> entry is unused
+    uint8_t PCA9685I2CAddress;
+    uint16_t ChannelChangedMask; // bit n -> PulseUnits[n] must be sent at the next flush
+    uint16_t PulseUnits[PCA9685_MAX_CHANNELS];
+#  if defined(ENABLE_PCA9685_SHADOW_REGISTERS)
+    uint16_t ShadowIsValidMask; // bit n -> the registers of channel n contain ShadowPulseUnits[n]
+    uint16_t ShadowPulseUnits[PCA9685_MAX_CHANNELS];
+#  endif
+};
+extern bool sPCA9685BurstIsActive; // true while updateAllServos() of the default engine runs
+bool bufferPCA9685PWM(TwoWire * aI2CClass, uint8_t aPCA9685I2CAddress, uint8_t aChannel, uint16_t aPulseUnits);
+void clearBufferedPCA9685PWM(TwoWire * aI2CClass, uint8_t aPCA9685I2CAddress, uint8_t aChannel);
+void flushPCA9685Bursts();
+#  if defined(ENABLE_PCA9685_SHADOW_REGISTERS)
+uint32_t getPCA9685NumberOfSavedBytes();
+#  endif
+#  if defined(ENABLE_PCA9685_ALL_LED_WRITE)
+extern bool sPCA9685AllLEDWriteIsAllowed; // true -> flushPCA9685Bursts() uses the ALL_LED registers for identical values of all 16 channels
+bool startPCA9685AllLEDWrite();
+void emergencyStopAllServos();
+#  endif
+#endif
+
+#if defined(ENABLE_DEAD_RECKONING)
+#define VELOCITY_CALIBRATION_POINTS     5 // Values for 0, 25, 50, 75 and 100 percent velocity
+#define MILLIDEGREE_PER_TURN            360000L
+#endif
+
+#if defined(ENABLE_CALIBRATION_TABLE)
+#define CALIBRATION_TABLE_MAX_POINTS    17 // -> 16 segments of 11.25 degree
+/*
+ * Piecewise linear mapping between degree and microseconds or units, computed once by setCalibrationTable().
+ * Must be provided by the user, since it is too big to be part of each ServoEasing object.
+ * Segment i covers degree (i * 180 / NumberOfSegments) to ((i + 1) * 180 / NumberOfSegments).
+ */
+struct ServoEasingCalibrationTable {
+    uint8_t NumberOfSegments;
+    uint16_t DegreeToSegmentFactorShift16; // (NumberOfSegments << 16) / 180 -> segment = (degree * factor) >> 16
+    // Degree to microseconds or units: value = Offset + ((degree * SlopeShift8) >> 8)
+    int16_t OffsetMicrosecondsOrUnits[CALIBRATION_TABLE_MAX_POINTS - 1];
+    int16_t SlopeShift8[CALIBRATION_TABLE_MAX_POINTS - 1];
+    // Microseconds or units to degree: degree = (InverseOffsetShift16 + value * InverseSlopeShift16) >> 16
+    int16_t MicrosecondsOrUnitsAtPoint[CALIBRATION_TABLE_MAX_POINTS];
+    int32_t InverseOffsetShift16[CALIBRATION_TABLE_MAX_POINTS - 1];
+    int32_t InverseSlopeShift16[CALIBRATION_TABLE_MAX_POINTS - 1];
+};
+#endif
+
+class ServoEasingEngine;
+extern ServoEasingEngine sServoEasingDefaultEngine;
+
+#if defined(ENABLE_SERVO_DRIVER_INTERFACE)
+class ServoEasing;
+/*
+ * Function table of a servo driver. The driver gets microseconds, trim, reverse and constraints are already applied.
+ * Tables are constant, so they can reside in flash on ARM and ESP, and no heap is required.
+ */
+struct ServoEasingDriverInterface {
+    bool (*begin)(ServoEasing *aServo); // called by attach() and at re-engage after idle power off. Return false, if the servo can not be used.
+    void (*writeFrame)(ServoEasing *aServo, int aMicroseconds); // pulse for the next frame, it may be buffered until flush()
+    void (*flush)(); // may be NULL. Called after all servos are updated by updateAllServos() and after each direct write(), but not by update()
+    void (*detach)(ServoEasing *aServo); // called by detach() and at idle power off
+};
+#  if !defined(MAX_SERVO_DRIVERS)
+#define MAX_SERVO_DRIVERS   4 // number of different driver tables, which are flushed by flushAllServoDrivers()
+#  endif
+void flushAllServoDrivers();
+#endif
+#if defined(ENABLE_SERVO_EASING_ENGINES)
+#define SERVO_ENGINE(aServoEasingPointer) ((aServoEasingPointer)->mEngine)
+#else
+#define SERVO_ENGINE(aServoEasingPointer) (&sServoEasingDefaultEngine) // no pointer required for only one engine
+#endif
+
 class ServoEasing
 #if ! defined(DO_NOT_USE_SERVO_LIB)
         : public Servo
@@ -406,9 +679,11 @@ public:
 
 #if defined(USE_PCA9685_SERVO_EXPANDER)
 #if defined(ARDUINO_SAM_DUE)
-    ServoEasing(uint8_t aPCA9685I2CAddress, TwoWire *aI2CClass = &Wire1);
+    ServoEasing(uint8_t aPCA9685I2CAddress, TwoWire *aI2CClass = &Wire1,
+            MaxEasingServosMustBeEqualForAllFiles<MAX_EASING_SERVOS> * aMaxEasingServosCheck = NULL);
 #else
-    ServoEasing(uint8_t aPCA9685I2CAddress, TwoWire *aI2CClass = &Wire);
+    ServoEasing(uint8_t aPCA9685I2CAddress, TwoWire *aI2CClass = &Wire,
+            MaxEasingServosMustBeEqualForAllFiles<MAX_EASING_SERVOS> * aMaxEasingServosCheck = NULL);
 #endif
     void I2CInit();
     void PCA9685Reset();
@@ -416,10 +691,11 @@ public:
     void I2CWriteByte(uint8_t aAddress, uint8_t aData);
     void setPWM(uint16_t aPWMOffValueAsUnits);
     void setPWM(uint16_t aPWMOnStartValueAsUnits, uint16_t aPWMPulseDurationAsUnits);
+    bool isConnectedToPCA9685Expander();
     // main mapping function for us to PCA9685 Units (20000/4096 = 4.88 us)
     int MicrosecondsToPCA9685Units(int aMicroseconds);
 #endif
-    ServoEasing();
+    ServoEasing(MaxEasingServosMustBeEqualForAllFiles<MAX_EASING_SERVOS> * aMaxEasingServosCheck = NULL); // parameter is only for link time check
 
     uint8_t attach(int aPin);
     // Here no units accepted, only microseconds!
@@ -428,6 +704,15 @@ public:
             int aServoHighDegree);
 
     void detach();
+#if defined(ENABLE_SERVO_EASING_ENGINES)
+    void setEngine(ServoEasingEngine * aServoEasingEngine); // must be called before attach()
+#endif
+#if defined(ENABLE_CALIBRATION_STORE)
+    bool loadCalibration(); // called by attach()
+#endif
+#if defined(ENABLE_SERVO_DRIVER_INTERFACE)
+    bool setDriver(const ServoEasingDriverInterface *aDriver); // must be called before attach()
+#endif
     void setReverseOperation(bool aOperateServoReverse);  // You should call it before using setTrim
 
     void setTrim(int aTrimDegrees, bool aDoWrite = false);
@@ -438,15 +723,72 @@ public:
     uint_fast8_t getEasingType();
 
     void registerUserEaseInFunction(float (*aUserEaseInFunction)(float aPercentageOfCompletion));
+    void registerUserEaseInFunctionWithUserData(
+            float (*aUserEaseInFunction)(float aPercentageOfCompletion, ServoEasing * aServoEasing, void * aUserDataPointer),
+            void * aUserDataPointer = NULL);
+    void registerUserEaseInFunctionFixedPoint(
+            int16_t (*aUserEaseInFunction)(int16_t aPercentageOfCompletionFixedPoint, ServoEasing * aServoEasing,
+                    void * aUserDataPointer), void * aUserDataPointer = NULL);
+    void * getUserDataPointer();
 
     float callEasingFunction(float aPercentageOfCompletion);    // used in update()
+    int32_t callEasingFunctionFixedPoint(int16_t aPercentageOfCompletion); // used in update()
 #endif
 
     void write(int aValue);                         // Apply trim and reverse to the value and write it direct to the Servo library.
     void writeMicrosecondsOrUnits(int aValue);
+    void writeMicrosecondsOrUnitsDirect(int aValue); // Ignores slew rate limit and filter. Called by update(), not intended for sketches.
 
     void setSpeed(uint_fast16_t aDegreesPerSecond);             // This speed is taken if no speed argument is given.
     uint_fast16_t getSpeed();
+#if defined(ENABLE_SLEW_RATE_LIMITED_WRITE)
+    void setSlewRateLimit(uint_fast16_t aMaxDegreesPerSecond, uint_fast16_t aMaxDegreesPerSecondSquared = 0);
+    bool updateSlewRateLimitedMove(int aTargetMicrosecondsOrUnits);
+#endif
+#if defined(ENABLE_VELOCITY_MODE)
+    void setVelocityModeParameters(int aStopMicroseconds, int aMicrosecondsForMaxPositiveVelocity, uint8_t aDeadbandMicroseconds = 0,
+            uint_fast16_t aMaxAccelerationPercentPerSecond = 0);
+    void setVelocity(int aVelocityPercent, bool aStartUpdateByInterrupt = true);
+    int getVelocity();
+    bool updateVelocity();
+    int VelocityToMicrosecondsOrUnits(int32_t aVelocityShift8);
+#endif
+#if defined(ENABLE_DEAD_RECKONING)
+    void setVelocityCalibration(const uint16_t * aDegreesPerSecondArray, const uint16_t * aDegreesPerSecondArrayForNegativeVelocity = NULL);
+    uint16_t VelocityToDegreesPerSecond(int32_t aVelocityShift8);
+    void integrateEstimatedAngle();
+    void addToEstimatedAngle(int32_t aMillidegree);
+    int32_t getEstimatedAngleMillidegree();
+    int32_t getEstimatedTurns();
+    void setEstimatedAngleMillidegree(int32_t aEstimatedAngleMillidegree);
+    bool rotateBy(int aDegrees, int aVelocityPercent, bool aStartUpdateByInterrupt = true);
+#endif
+#if defined(ENABLE_IDLE_POWER_OFF)
+    void setIdlePowerOffMillis(uint16_t aMillisUntilPowerOff);
+    bool checkIdlePowerOff();
+    void armIdlePowerOff();
+    void powerOff();
+    void reengage();
+    bool isPoweredOff();
+    uint16_t getNumberOfPowerOffs();
+    uint32_t getPowerOffMillis();
+#endif
+#if defined(ENABLE_MIN_AND_MAX_CONSTRAINTS)
+    void setMinMaxConstraint(int aMinDegreeOrMicrosecond, int aMaxDegreeOrMicrosecond);
+    void removeMinMaxConstraint();
+    void computeMinMaxConstraintWithTrimAndReverse();
+    uint16_t getNumberOfClampedWrites();
+#endif
+#if defined(ENABLE_INPUT_FILTER)
+    void setInputFilter(uint8_t aFilterType, uint8_t aParameter, uint8_t aSpeedCoefficient = 0);
+    uint16_t getNumberOfSuppressedWrites();
+    void resetInputFilterStatistics();
+    bool updateInputFilter(int * aFilteredMicrosecondsOrUnits);
+#endif
+#if defined(ENABLE_WRITE_TARGET_TRACKING)
+    bool isWriteTargetTracked();
+    bool updateWriteTarget();
+#endif
     void easeTo(int aDegree);                                   // blocking move to new position using mLastSpeed
     void easeTo(int aDegree, uint_fast16_t aDegreesPerSecond);      // blocking move to new position using speed
     void easeToD(int aDegree, uint_fast16_t aMillisForMove);        // blocking move to new position using duration
@@ -473,6 +815,11 @@ public:
     int MicrosecondsOrUnitsToDegree(int aMicrosecondsOrUnits);
     int DegreeToMicrosecondsOrUnits(int aDegree);
     int DegreeToMicrosecondsOrUnitsWithTrimAndReverse(int aDegree);
+    void computeConversionFactorsAndOffsets();
+#if defined(ENABLE_CALIBRATION_TABLE)
+    bool setCalibrationTable(ServoEasingCalibrationTable * aCalibrationTable, const int * aMicrosecondsArray, uint8_t aNumberOfPoints);
+    void removeCalibrationTable();
+#endif
 
     void synchronizeServosAndStartInterrupt(bool doUpdateByInterrupt);
 
@@ -498,10 +845,65 @@ public:
     uint8_t mEasingType; // EASE_LINEAR, EASE_QUADRATIC_IN_OUT, EASE_CUBIC_IN_OUT, EASE_QUARTIC_IN_OUT
 
     float (*mUserEaseInFunction)(float aPercentageOfCompletion);
+    float (*mUserEaseInFunctionWithUserData)(float aPercentageOfCompletion, ServoEasing * aServoEasing, void * aUserDataPointer);
+    int16_t (*mUserEaseInFunctionFixedPoint)(int16_t aPercentageOfCompletionFixedPoint, ServoEasing * aServoEasing,
+            void * aUserDataPointer);
+    void * mUserDataPointer; // passed to user functions together with this
 #endif
 
     volatile bool mServoMoves;
 
+#if defined(ENABLE_WRITE_TARGET_TRACKING)
+    /*
+     * Values for movements started by write() if a slew rate limit or an input filter is set
+     */
+    volatile bool mIsTrackingTarget;  // true -> update() does a filtered and / or slew rate limited move to mTargetMicrosecondsOrUnits
+    int mTargetMicrosecondsOrUnits;   // last value written by write() or writeMicrosecondsOrUnits()
+#endif
+#if defined(ENABLE_SLEW_RATE_LIMITED_WRITE)
+    int32_t mTrackingPositionShift8;  // current position with 8 bit fraction
+    int16_t mTrackingVelocity;        // in (microseconds or units / 256) per millisecond
+    uint16_t mSlewRateMaxVelocity;     // in (microseconds or units / 256) per millisecond. 0 -> no limit
+    uint16_t mSlewRateMaxAcceleration; // in (microseconds or units / 65536) per millisecond squared. 0 -> no limit
+#endif
+#if defined(ENABLE_VELOCITY_MODE)
+    /*
+     * Values for continuous rotating servos. Velocity is in percent of the maximum velocity with 8 bit fraction.
+     */
+    volatile bool mIsVelocityMove;        // true -> update() ramps velocity to mTargetVelocityShift8
+    int16_t mVelocityShift8;
+    int16_t mTargetVelocityShift8;
+    int mVelocityStopMicrosecondsOrUnits;  // calibrated pulse for velocity 0
+    uint8_t mVelocityDeadbandMicrosecondsOrUnits; // pulses nearer to stop pulse do not move the servo
+    int16_t mVelocityFactorShift16;        // (pulse for max velocity - stop pulse - deadband) / 100 percent / 256. Negative if pulses decrease with velocity.
+    uint16_t mVelocityMaxAccelerationShift8; // in percent / 256 per millisecond. 0 -> no limit
+#endif
+#if defined(ENABLE_DEAD_RECKONING)
+    const uint16_t * mVelocityCalibrationPositive; // degree per second for 0, 25, 50, 75 and 100 percent velocity
+    const uint16_t * mVelocityCalibrationNegative; // the same for negative velocities
+    int32_t mEstimatedAngleMillidegree;   // 0 to MILLIDEGREE_PER_TURN - 1
+    int32_t mEstimatedTurns;
+    uint32_t mMillisAtLastIntegration;
+    int32_t mRotateByRemainingMillidegree;
+    int8_t mRotateByDirection;             // 0 -> no rotateBy() active, 1 or -1 -> direction of rotateBy()
+#endif
+#if defined(ENABLE_IDLE_POWER_OFF)
+    volatile bool mIsPoweredOff;         // true -> pulse is switched off, next write re-engages the servo
+    uint16_t mIdlePowerOffMillis;        // 0 -> no automatic power off
+    uint32_t mMillisAtLastActivity;      // millis() of last write, or of power off if mIsPoweredOff is true
+    uint16_t mNumberOfPowerOffs;
+    uint32_t mPowerOffMillis;            // accumulated time of completed power off periods
+#endif
+#if defined(ENABLE_INPUT_FILTER)
+    uint8_t mInputFilterType;            // INPUT_FILTER_NONE, INPUT_FILTER_IIR, INPUT_FILTER_ONE_EURO or INPUT_FILTER_DEADBAND
+    uint8_t mInputFilterParameter;       // shift for IIR and one euro, deadband in microseconds or units for deadband
+    uint8_t mInputFilterSpeedCoefficient; // one euro only: increase of filter coefficient (/256) per microsecond or unit per update
+    int32_t mInputFilterStateShift8;     // filter output with 8 bit fraction
+    int mInputFilterLastInput;           // one euro only: input at last update
+    int mInputFilterDerivative;          // one euro only: smoothed change of input per update
+    volatile uint16_t mNumberOfSuppressedWrites; // number of updates, where the filtered value equals the current servo value
+#endif
+
 #if defined(USE_PCA9685_SERVO_EXPANDER)
 #if defined(USE_SERVO_LIB)
     bool mServoIsConnectedToExpander; // to distinguish between different servo drivers
@@ -511,7 +913,13 @@ public:
 #endif
     uint8_t mServoPin; // pin number or NO_SERVO_ATTACHED_PIN_NUMBER - at least required for Lightweight Servo Library
 
-    uint8_t mServoIndex; // Index in sServoArray or INVALID_SERVO if error while attach() or if detached
+    uint8_t mServoIndex; // Index in mServoArray of the engine or INVALID_SERVO if error while attach() or if detached
+#if defined(ENABLE_SERVO_EASING_ENGINES)
+    ServoEasingEngine * mEngine; // engine, which holds this servo in its list
+#endif
+#if defined(ENABLE_SERVO_DRIVER_INTERFACE)
+    const ServoEasingDriverInterface * mDriver; // NULL -> driver selected at compile time
+#endif
 
     uint32_t mMillisAtStartMove;
     uint_fast16_t mMillisForCompleteMove;
@@ -526,7 +934,254 @@ public:
 
     int mServo0DegreeMicrosecondsOrUnits;
     int mServo180DegreeMicrosecondsOrUnits;
+
+    /*
+     * Computed by computeConversionFactorsAndOffsets() to avoid divisions and repeated trim and reverse computations
+     */
+    int16_t mDegreeToMicrosecondsOrUnitsFactorShift8;   // ((mServo180DegreeMicrosecondsOrUnits - mServo0DegreeMicrosecondsOrUnits) * 256) / 180
+    int32_t mMicrosecondsOrUnitsToDegreeFactorShift16;  // (180 * 65536) / (mServo180DegreeMicrosecondsOrUnits - mServo0DegreeMicrosecondsOrUnits)
+    int mTrimAndReverseOffsetMicrosecondsOrUnits;       // value written = offset + value or offset - value if reverse
+
+#if defined(ENABLE_CALIBRATION_TABLE)
+    ServoEasingCalibrationTable * mCalibrationTable; // NULL -> linear mapping between mServo0DegreeMicrosecondsOrUnits and mServo180DegreeMicrosecondsOrUnits
+#endif
+#if defined(ENABLE_MIN_AND_MAX_CONSTRAINTS)
+    int mMinMicrosecondsOrUnits; // Limits as given by setMinMaxConstraint(). Both 0 -> no constraint.
+    int mMaxMicrosecondsOrUnits;
+    int mMinMicrosecondsOrUnitsWithTrimAndReverse; // Limits for the values written to the servo, computed once from the ones above
+    int mMaxMicrosecondsOrUnitsWithTrimAndReverse;
+    uint16_t mNumberOfClampedWrites;
+#endif
+};
+
+/*
+ * Output driver policies. Each one contains the driver specific parts of attach(), detach(), power off and write as static inline functions.
+ * The policy of the configured driver is selected once at compile time as ServoEasingBuiltinDriver, which is used by ServoEasing as ServoEasingDriver,
+ * so the functions of ServoEasing contain no driver #if and the write path is inlined.
+ * Only for the mixed setup of PCA9685 expanders and Servo library, the driver is chosen per servo by mServoIsConnectedToExpander.
+ * A class template for each driver is not possible, since the servo list of the engine and all *AllServos() functions
+ * require one common type, and virtual functions would cost more than the one flag check of the mixed setup.
+ */
+#if defined(USE_PCA9685_SERVO_EXPANDER)
+struct ServoEasingPCA9685Driver {
+    static int toMicrosecondsOrUnits(ServoEasing *aServo, int aMicroseconds) {
+        return aServo->MicrosecondsToPCA9685Units(aMicroseconds);
+    }
+    static uint8_t attach(ServoEasing *aServo, int aMicrosecondsForServo0Degree, int aMicrosecondsForServo180Degree) {
+        (void) aMicrosecondsForServo0Degree;
+        (void) aMicrosecondsForServo180Degree;
+        initializePCA9685Bus(aServo->mI2CClass); // init and reset only at the first attach for this bus
+        aServo->PCA9685Init(); // initialize at every attach is simpler but initializing once for every board would be sufficient.
+        return aServo->mServoIndex;
+    }
+    static void detach(ServoEasing *aServo) {
+#if defined(ENABLE_PCA9685_ALL_LED_WRITE)
+        if (bufferPCA9685PWM(aServo->mI2CClass, aServo->mPCA9685I2CAddress, aServo->mServoPin, PCA9685_FULL_OFF_VALUE)) {
+            return; // sent by flushPCA9685Bursts(), with one ALL_LED transfer if all 16 channels are detached
+        }
+#endif
+        aServo->setPWM(0); // set signal fully off
+    }
+    static void powerOff(ServoEasing *aServo) {
+        aServo->setPWM(PCA9685_FULL_OFF_VALUE);
+    }
+    static void reengage(ServoEasing *aServo) {
+        (void) aServo; // full off bit is cleared by the following write of the pulse
+    }
+    static void write(ServoEasing *aServo, int aValue) {
+#if defined(ENABLE_PCA9685_BURST_WRITE)
+        if (bufferPCA9685PWM(aServo->mI2CClass, aServo->mPCA9685I2CAddress, aServo->mServoPin, aValue)) {
+            return; // sent by flushPCA9685Bursts() at the end of updateAllServos()
+        }
+#endif
+        // Distribute the servo start time over the 20 ms period. Unexpectedly this even saves 20 bytes Flash for an ATMega328P
+        aServo->setPWM(aServo->mServoPin * ((4096 - (DEFAULT_PCA9685_UNITS_FOR_180_DEGREE + 100)) / 15), aValue); // mServoPin * 233
+    }
+};
+#endif
+
+#if defined(USE_LEIGHTWEIGHT_SERVO_LIB)
+struct ServoEasingLightweightDriver {
+    static int toMicrosecondsOrUnits(ServoEasing *aServo, int aMicroseconds) {
+        (void) aServo;
+        return aMicroseconds;
+    }
+    static uint8_t attach(ServoEasing *aServo, int aMicrosecondsForServo0Degree, int aMicrosecondsForServo180Degree) {
+        (void) aMicrosecondsForServo0Degree;
+        (void) aMicrosecondsForServo180Degree;
+        if (aServo->mServoPin != 9 && aServo->mServoPin != 10) {
+            return false;
+        }
+        return aServo->mServoPin;
+    }
+    static void detach(ServoEasing *aServo) {
+        deinitLightweightServoPin9_10(aServo->mServoPin == 9); // disable output and change to input
+    }
+    static void powerOff(ServoEasing *aServo) {
+        deinitLightweightServoPin9_10(aServo->mServoPin == 9);
+    }
+    static void reengage(ServoEasing *aServo) {
+        initLightweightServoPin9_10(aServo->mServoPin == 9, aServo->mServoPin == 10);
+    }
+    static void write(ServoEasing *aServo, int aValue) {
+        writeMicrosecondsLightweightServo(aValue, (aServo->mServoPin == 9));
+    }
+};
+
+#elif ! defined(DO_NOT_USE_SERVO_LIB)
+struct ServoEasingServoLibDriver {
+    static int toMicrosecondsOrUnits(ServoEasing *aServo, int aMicroseconds) {
+        (void) aServo;
+        return aMicroseconds;
+    }
+    static uint8_t attach(ServoEasing *aServo, int aMicrosecondsForServo0Degree, int aMicrosecondsForServo180Degree) {
+        if (aServo->mServoIndex == INVALID_SERVO) {
+            return INVALID_SERVO;
+        }
+#  if defined(ARDUINO_ARCH_APOLLO3)
+        aServo->Servo::attach(aServo->mServoPin, aMicrosecondsForServo0Degree, aMicrosecondsForServo180Degree);
+        return aServo->mServoPin; // Sparkfun apollo3 Servo library has no return value for attach :-(
+#  else
+        return aServo->Servo::attach(aServo->mServoPin, aMicrosecondsForServo0Degree, aMicrosecondsForServo180Degree);
+#  endif
+    }
+    static void detach(ServoEasing *aServo) {
+        aServo->Servo::detach();
+    }
+    static void powerOff(ServoEasing *aServo) {
+        aServo->Servo::detach();
+    }
+    static void reengage(ServoEasing *aServo) {
+        aServo->Servo::attach(aServo->mServoPin, aServo->mServo0DegreeMicrosecondsOrUnits, aServo->mServo180DegreeMicrosecondsOrUnits);
+    }
+    static void write(ServoEasing *aServo, int aValue) {
+        aServo->Servo::writeMicroseconds(aValue); // requires 7 us
+    }
+};
+#endif
+
+#if defined(USE_PCA9685_SERVO_EXPANDER) && defined(USE_SERVO_LIB)
+struct ServoEasingMixedDriver {
+    static int toMicrosecondsOrUnits(ServoEasing *aServo, int aMicroseconds) {
+        if (aServo->mServoIsConnectedToExpander) {
+            return ServoEasingPCA9685Driver::toMicrosecondsOrUnits(aServo, aMicroseconds);
+        }
+        return ServoEasingServoLibDriver::toMicrosecondsOrUnits(aServo, aMicroseconds);
+    }
+    static uint8_t attach(ServoEasing *aServo, int aMicrosecondsForServo0Degree, int aMicrosecondsForServo180Degree) {
+        if (aServo->mServoIsConnectedToExpander) {
+            return ServoEasingPCA9685Driver::attach(aServo, aMicrosecondsForServo0Degree, aMicrosecondsForServo180Degree);
+        }
+        return ServoEasingServoLibDriver::attach(aServo, aMicrosecondsForServo0Degree, aMicrosecondsForServo180Degree);
+    }
+    static void detach(ServoEasing *aServo) {
+        if (aServo->mServoIsConnectedToExpander) {
+            ServoEasingPCA9685Driver::detach(aServo);
+        } else {
+            ServoEasingServoLibDriver::detach(aServo);
+        }
+    }
+    static void powerOff(ServoEasing *aServo) {
+        if (aServo->mServoIsConnectedToExpander) {
+            ServoEasingPCA9685Driver::powerOff(aServo);
+        } else {
+            ServoEasingServoLibDriver::powerOff(aServo);
+        }
+    }
+    static void reengage(ServoEasing *aServo) {
+        if (!aServo->mServoIsConnectedToExpander) {
+            ServoEasingServoLibDriver::reengage(aServo);
+        }
+    }
+    static void write(ServoEasing *aServo, int aValue) {
+        if (aServo->mServoIsConnectedToExpander) {
+            ServoEasingPCA9685Driver::write(aServo, aValue);
+        } else {
+            ServoEasingServoLibDriver::write(aServo, aValue);
+        }
+    }
+};
+typedef ServoEasingMixedDriver ServoEasingBuiltinDriver;
+#elif defined(USE_PCA9685_SERVO_EXPANDER)
+typedef ServoEasingPCA9685Driver ServoEasingBuiltinDriver;
+#elif defined(USE_LEIGHTWEIGHT_SERVO_LIB)
+typedef ServoEasingLightweightDriver ServoEasingBuiltinDriver;
+#else
+typedef ServoEasingServoLibDriver ServoEasingBuiltinDriver;
+#endif
+
+#if defined(ENABLE_SERVO_DRIVER_INTERFACE)
+/*
+ * Uses the driver table of the servo if one is set by setDriver()
+ */
+struct ServoEasingRuntimeDriver {
+    static int toMicrosecondsOrUnits(ServoEasing *aServo, int aMicroseconds) {
+        if (aServo->mDriver != NULL) {
+            return aMicroseconds;
+        }
+        return ServoEasingBuiltinDriver::toMicrosecondsOrUnits(aServo, aMicroseconds);
+    }
+    static uint8_t attach(ServoEasing *aServo, int aMicrosecondsForServo0Degree, int aMicrosecondsForServo180Degree) {
+        if (aServo->mDriver != NULL) {
+            if (aServo->mServoIndex == INVALID_SERVO || !aServo->mDriver->begin(aServo)) {
+                return INVALID_SERVO;
+            }
+            return aServo->mServoIndex;
+        }
+        return ServoEasingBuiltinDriver::attach(aServo, aMicrosecondsForServo0Degree, aMicrosecondsForServo180Degree);
+    }
+    static void detach(ServoEasing *aServo) {
+        if (aServo->mDriver != NULL) {
+            aServo->mDriver->detach(aServo);
+        } else {
+            ServoEasingBuiltinDriver::detach(aServo);
+        }
+    }
+    static void powerOff(ServoEasing *aServo) {
+        if (aServo->mDriver != NULL) {
+            aServo->mDriver->detach(aServo);
+        } else {
+            ServoEasingBuiltinDriver::powerOff(aServo);
+        }
+    }
+    static void reengage(ServoEasing *aServo) {
+        if (aServo->mDriver != NULL) {
+            aServo->mDriver->begin(aServo);
+        } else {
+            ServoEasingBuiltinDriver::reengage(aServo);
+        }
+    }
+    static void write(ServoEasing *aServo, int aValue) {
+        if (aServo->mDriver != NULL) {
+            aServo->mDriver->writeFrame(aServo, aValue);
+        } else {
+            ServoEasingBuiltinDriver::write(aServo, aValue);
+        }
+    }
 };
+typedef ServoEasingRuntimeDriver ServoEasingDriver;
+
+/*
+ * Simulation driver, which records all pulses in a ring buffer
+ */
+#  if !defined(SIMULATION_DRIVER_NUMBER_OF_RECORDS)
+#define SIMULATION_DRIVER_NUMBER_OF_RECORDS 32
+#  endif
+struct ServoEasingSimulationRecord {
+    uint32_t Millis;
+    uint8_t ServoIndex;
+    int16_t Microseconds; // 0 -> detached
+};
+extern const ServoEasingDriverInterface ServoEasingSimulationDriver;
+extern ServoEasingSimulationRecord sSimulationRecordArray[SIMULATION_DRIVER_NUMBER_OF_RECORDS];
+extern uint16_t sSimulationNumberOfRecords; // Total number of records, wraps at 0xFFFF
+extern uint16_t sSimulationNumberOfFlushes;
+extern uint16_t sSimulationWriteIndex; // Index of the next record. The newest one is at the index before, the oldest one at this index if the array is full.
+extern bool sSimulationRecordArrayIsFull;
+void printSimulationRecords(Print *aSerial);
+#else
+typedef ServoEasingBuiltinDriver ServoEasingDriver;
+#endif
 
 /*
  * It is required for ESP32, where the timer interrupt routine does not block the loop. Maybe it runs on another CPU?
@@ -538,17 +1193,157 @@ extern volatile bool sInterruptsAreActive; // true if interrupts are still activ
 bool areInterruptsActive(); // The recommended test if at least one servo is moving yet.
 
 /*
- * Array of all servos to enable synchronized movings
- * Servos are inserted in the order, in which they are attached
- * I use an fixed array and not a list, since accessing an array is much easier and faster.
- * Using an dynamic array may be possible, but in this case we must first malloc(), then memcpy() and then free(), which leads to heap fragmentation.
+ * Bit n is set if servo n may require an update, i.e. it was started and not yet found stopped by updateAllServos().
+ * A cleared bit guarantees, that the servo is not moving. This allows updateAllServos() and isOneServoMoving() to skip idle servos.
+ * The mask is an array of words of the native int size, so MAX_EASING_SERVOS is not limited by the size of an integer type.
+ * getNextIndex() finds the next set bit by count trailing zeros, so the loops visit only the servos with a set bit.
  */
-extern uint_fast8_t sServoArrayMaxIndex; // maximum index of an attached servo in sServoArray[]
-extern ServoEasing * sServoArray[MAX_EASING_SERVOS];
-extern int sServoNextPositionArray[MAX_EASING_SERVOS]; // use int since we want to support negative values
+#if MAX_EASING_SERVOS >= INVALID_SERVO
+#error "MAX_EASING_SERVOS must be less than 255, since 255 is INVALID_SERVO"
+#endif
+typedef unsigned int ServoEasingMaskWord_t; // 16 bit on AVR, 32 bit on ARM and ESP, as required by __builtin_ctz()
+#define SERVO_EASING_MASK_WORD_BITS     (sizeof(ServoEasingMaskWord_t) * 8)
+#define SERVO_EASING_MASK_WORDS         ((MAX_EASING_SERVOS + SERVO_EASING_MASK_WORD_BITS - 1) / SERVO_EASING_MASK_WORD_BITS)
+
+struct ServoEasingMask {
+    volatile ServoEasingMaskWord_t Words[SERVO_EASING_MASK_WORDS]; // bits are set by the main program and cleared by the interrupt
+
+    void clearAll() {
+        for (uint_fast8_t i = 0; i < SERVO_EASING_MASK_WORDS; ++i) {
+            Words[i] = 0;
+        }
+    }
+    void setBit(uint_fast8_t aIndex) {
+        Words[aIndex / SERVO_EASING_MASK_WORD_BITS] |= ((ServoEasingMaskWord_t) 1) << (aIndex % SERVO_EASING_MASK_WORD_BITS);
+    }
+    void clearBit(uint_fast8_t aIndex) {
+        Words[aIndex / SERVO_EASING_MASK_WORD_BITS] &= ~(((ServoEasingMaskWord_t) 1) << (aIndex % SERVO_EASING_MASK_WORD_BITS));
+    }
+    bool isBitSet(uint_fast8_t aIndex) const {
+        return Words[aIndex / SERVO_EASING_MASK_WORD_BITS] & (((ServoEasingMaskWord_t) 1) << (aIndex % SERVO_EASING_MASK_WORD_BITS));
+    }
+    bool isEmpty() const;
+    bool intersects(const ServoEasingMask & aMask) const;
+    void setBits(const ServoEasingMask & aMask);
+    void clearBits(const ServoEasingMask & aMask);
+    // @return index of the first set bit >= aStartIndex, which is also set in aAndMask if given, or MAX_EASING_SERVOS if none
+    uint_fast8_t getNextIndex(uint_fast8_t aStartIndex, const ServoEasingMask * aAndMask = NULL) const;
+};
 
 /*
- * Functions working on all servos in the list
+ * List of servos with their move state, clock and interrupt start.
+ * The global functions working on all servos like updateAllServos() use the default engine sServoEasingDefaultEngine,
+ * which is updated by the ServoEasing timer interrupt.
+ * Other engines must be updated by calling their updateAllServos() e.g. from another timer or from a task on the other core of an ESP32.
+ * aStartUpdateFunction is called at the start of a move to start this update. If NULL, updateAllServos() must be polled.
+ * ServoEasingPacked servos are only supported by the default engine.
+ */
+class ServoEasingEngine {
+public:
+#if defined(ENABLE_SERVO_EASING_ENGINES)
+    ServoEasingEngine(unsigned long (*aMillisFunction)() = &millis, void (*aStartUpdateFunction)() = NULL);
+#else
+    ServoEasingEngine();
+#endif
+
+    uint_fast8_t registerServo(ServoEasing * aServoEasingObjectPtr); // returns index or INVALID_SERVO if list is full
+    void unregisterServo(uint_fast8_t aServoIndex);
+    void startUpdateByInterrupt(bool aSkipIfActive = false);
+    void setServoUpdateMaskBit(uint_fast8_t aServoIndex);
+    void clearServoUpdateMaskBit(uint_fast8_t aServoIndex);
+    bool updateGroupMoves(); // calls updateGroupMove() of all groups of this engine
+    void stopGroupMoves();
+
+    // Inline, since called at each update
+    unsigned long getMillis() {
+#if defined(ENABLE_SERVO_EASING_ENGINES)
+        return mMillisFunction();
+#else
+        return millis();
+#endif
+    }
+    bool isDefaultEngine() {
+#if defined(ENABLE_SERVO_EASING_ENGINES)
+        return this == &sServoEasingDefaultEngine;
+#else
+        return true;
+#endif
+    }
+    bool isServoInGroupMove(uint_fast8_t aServoIndex) {
+        return aServoIndex != INVALID_SERVO && mGroupMoveMask.isBitSet(aServoIndex);
+    }
+
+    /*
+     * Functions working on all servos of this engine, see the global functions with the same name
+     */
+    void writeAllServos(int aValue);
+    void setSpeedForAllServos(uint_fast16_t aDegreesPerSecond);
+#if defined(va_arg)
+    void setDegreeForAllServos(uint_fast8_t aNumberOfValues, va_list * aDegreeValues);
+#endif
+#if defined(va_start)
+    void setDegreeForAllServos(uint_fast8_t aNumberOfValues, ...);
+#endif
+    bool setEaseToForAllServos();
+    bool setEaseToForAllServos(uint_fast16_t aDegreesPerSecond);
+    bool setEaseToDForAllServos(uint_fast16_t aMillisForMove);
+    void setEaseToForAllServosSynchronizeAndStartInterrupt();
+    void setEaseToForAllServosSynchronizeAndStartInterrupt(uint_fast16_t aDegreesPerSecond);
+    void synchronizeAndEaseToArrayPositions();
+    void synchronizeAndEaseToArrayPositions(uint_fast16_t aDegreesPerSecond);
+    bool startEaseToArrayPositions(const int * aDegreeArray, uint_fast8_t aNumberOfServos, const uint16_t * aDegreesPerSecondArray = NULL,
+            const uint8_t * aEasingTypeArray = NULL, bool aStartUpdateByInterrupt = true);
+    bool startEaseToArrayPositions_P(const int * aDegreeArrayPGM, uint_fast8_t aNumberOfServos,
+            const uint16_t * aDegreesPerSecondArray = NULL, const uint8_t * aEasingTypeArray = NULL, bool aStartUpdateByInterrupt = true);
+    bool startEaseToArrayPositions(const int * aDegreeArray, bool aDegreeArrayIsInProgmem, uint_fast8_t aNumberOfServos,
+            const uint16_t * aDegreesPerSecondArray, const uint8_t * aEasingTypeArray, bool aStartUpdateByInterrupt);
+    void printArrayPositions(Print * aSerial);
+    bool isOneServoMoving();
+    void stopAllServos();
+    void detachAllServos();
+    bool updateAllServos();
+#if defined(ENABLE_IDLE_POWER_OFF)
+    void setIdlePowerOffMillisForAllServos(uint16_t aMillisUntilPowerOff);
+#endif
+    void synchronizeAllServosAndStartInterrupt(bool aStartUpdateByInterrupt = true);
+#ifndef PROVIDE_ONLY_LINEAR_MOVEMENT
+    void setEasingTypeForAllServos(uint_fast8_t aEasingType);
+#endif
+    void updateAndWaitForAllServosToStop();
+    bool delayAndUpdateAndWaitForAllServosToStop(unsigned long aMillisDelay, bool aTerminateDelayIfAllServosStopped = false);
+    void synchronizeAllServosStartAndWaitForAllServosToStop();
+
+    /*
+     * Array of all servos to enable synchronized movings
+     * Servos are inserted in the order, in which they are attached
+     * I use an fixed array and not a list, since accessing an array is much easier and faster.
+     * Using an dynamic array may be possible, but in this case we must first malloc(), then memcpy() and then free(), which leads to heap fragmentation.
+     */
+    ServoEasing * mServoArray[MAX_EASING_SERVOS];
+    int mServoNextPositionArray[MAX_EASING_SERVOS]; // use int since we want to support negative values
+    uint_fast8_t mServoArrayMaxIndex; // maximum index of an attached servo in mServoArray[]
+    uint8_t mServoArrayFreeIndex; // first free index or MAX_EASING_SERVOS if all are used
+    uint8_t mServoArrayNextFreeIndex[MAX_EASING_SERVOS]; // free indexes as linked list, so attach() and detach() need no search
+    ServoEasingMask mServoUpdateMask; // bits are set at start of a move and cleared by updateAllServos()
+    ServoEasingMask mGroupMoveMask; // servos written by an active group move and not by their update()
+#if defined(ENABLE_IDLE_POWER_OFF)
+    volatile bool mIdlePowerOffIsPending; // true if at least one idle servo waits for its power off. Keeps the interrupt running.
+#endif
+#if defined(ENABLE_SERVO_EASING_ENGINES)
+    unsigned long (*mMillisFunction)();
+    void (*mStartUpdateFunction)(); // NULL -> updateAllServos() of this engine is polled
+#endif
+};
+
+/*
+ * The servo list of the default engine with the names of former versions
+ */
+extern uint_fast8_t & sServoArrayMaxIndex; // maximum index of an attached servo in sServoArray[]
+extern ServoEasing * (&sServoArray)[MAX_EASING_SERVOS];
+extern int (&sServoNextPositionArray)[MAX_EASING_SERVOS];
+
+/*
+ * Functions working on all servos in the list of the default engine
  */
 void writeAllServos(int aValue);
 void setSpeedForAllServos(uint_fast16_t aDegreesPerSecond);
@@ -567,10 +1362,39 @@ void setEaseToForAllServosSynchronizeAndStartInterrupt(uint_fast16_t aDegreesPer
 void synchronizeAndEaseToArrayPositions();
 void synchronizeAndEaseToArrayPositions(uint_fast16_t aDegreesPerSecond);
 
+/*
+ * Bulk versions of setDegreeForAllServos() + setEaseToForAllServos() + synchronizeAllServosAndStartInterrupt() in one pass.
+ * The arrays are indexed like sServoArray[], i.e. in the order of attach(). NULL for the speed or easing type array
+ * means, that the speed / easing type already set for each servo is taken.
+ */
+bool startEaseToArrayPositions(const int * aDegreeArray, uint_fast8_t aNumberOfServos, const uint16_t * aDegreesPerSecondArray = NULL,
+        const uint8_t * aEasingTypeArray = NULL, bool aStartUpdateByInterrupt = true);
+bool startEaseToArrayPositions_P(const int * aDegreeArrayPGM, uint_fast8_t aNumberOfServos,
+        const uint16_t * aDegreesPerSecondArray = NULL, const uint8_t * aEasingTypeArray = NULL, bool aStartUpdateByInterrupt = true);
+
+/*
+ * Coupled group move e.g. for inverse kinematics. The group function is called once per update with the
+ * percentage of completion from 0.0 to 1.0 and must fill aDegreeArray[] for all servos of the group.
+ * aDegreeArray[0] is the servo of the group with the lowest index. The array is preset with the current angles.
+ * The group move is updated by updateAllServos() of the engine, not by update() of the single servos.
+ * These functions use an internal group of the servos sServoArray[aFirstServoIndex] to
+ * sServoArray[aFirstServoIndex + aNumberOfServos - 1] of the default engine. Use ServoEasingGroup::startGroupMoveD() for other groups.
+ */
+typedef void (*ServoEasingGroupMoveFunction)(float aPercentageOfCompletion, int * aDegreeArray, void * aUserDataPointer);
+bool startGroupMoveD(ServoEasingGroupMoveFunction aGroupMoveFunction, uint_fast8_t aFirstServoIndex, uint_fast8_t aNumberOfServos,
+        uint_fast16_t aMillisForMove, void * aUserDataPointer = NULL, bool aStartUpdateByInterrupt = true);
+void stopGroupMove(); // stops all group moves of the default engine
+bool isGroupMoveActive(); // true if a group move of the default engine is active
+bool isServoIndexInActiveGroupMove(uint_fast8_t aServoIndex);
+
 void printArrayPositions(Print * aSerial);
 bool isOneServoMoving();
 void stopAllServos();
+void detachAllServos();
 bool updateAllServos();
+#if defined(ENABLE_IDLE_POWER_OFF)
+void setIdlePowerOffMillisForAllServos(uint16_t aMillisUntilPowerOff);
+#endif
 void synchronizeAllServosAndStartInterrupt(bool aStartUpdateByInterrupt = true);
 
 #ifndef PROVIDE_ONLY_LINEAR_MOVEMENT
@@ -587,6 +1411,192 @@ void disableServoEasingInterrupt();
 
 int clipDegreeSpecial(uint_fast8_t aDegreeToClip);
 
+/*
+ * Group of attached servos of one engine, e.g. the servos of one leg, which are synchronized, stopped and updated
+ * independently of the servos of other groups. A servo can be member of multiple groups.
+ * Servos are stored as bitmask of their servo index, so add them after attach() and remove them before detach().
+ * Degree values for setDegreeForAllServos() and printArrayPositions() are in the order of the servo indexes.
+ */
+class ServoEasingGroup {
+public:
+    ServoEasingGroup();
+    ~ServoEasingGroup();
+    static void removeServoIndexFromAllGroups(ServoEasingEngine * aEngine, uint_fast8_t aServoIndex); // called by detach()
+    bool addServo(ServoEasing * aServoEasingObjectPtr); // returns false if servo is not attached or belongs to another engine
+    void removeServo(ServoEasing * aServoEasingObjectPtr);
+    bool isMember(ServoEasing * aServoEasingObjectPtr);
+
+    void writeAllServos(int aValue);
+    void setSpeedForAllServos(uint_fast16_t aDegreesPerSecond);
+#if defined(va_arg)
+    void setDegreeForAllServos(uint_fast8_t aNumberOfValues, va_list * aDegreeValues);
+#endif
+#if defined(va_start)
+    void setDegreeForAllServos(uint_fast8_t aNumberOfValues, ...);
+#endif
+    bool setEaseToForAllServos();
+    bool setEaseToForAllServos(uint_fast16_t aDegreesPerSecond);
+    bool setEaseToDForAllServos(uint_fast16_t aMillisForMove);
+    void setEaseToForAllServosSynchronizeAndStartInterrupt();
+    void setEaseToForAllServosSynchronizeAndStartInterrupt(uint_fast16_t aDegreesPerSecond);
+    void synchronizeAndEaseToArrayPositions();
+    void synchronizeAndEaseToArrayPositions(uint_fast16_t aDegreesPerSecond);
+    void printArrayPositions(Print * aSerial);
+    bool isOneServoMoving();
+    void stopAllServos();
+    void detachAllServos();
+    bool updateAllServos();
+#if defined(ENABLE_IDLE_POWER_OFF)
+    void setIdlePowerOffMillisForAllServos(uint16_t aMillisUntilPowerOff);
+#endif
+    void synchronizeAllServosAndStartInterrupt(bool aStartUpdateByInterrupt = true);
+#ifndef PROVIDE_ONLY_LINEAR_MOVEMENT
+    void setEasingTypeForAllServos(uint_fast8_t aEasingType);
+#endif
+    void updateAndWaitForAllServosToStop();
+    bool delayAndUpdateAndWaitForAllServosToStop(unsigned long aMillisDelay, bool aTerminateDelayIfAllServosStopped = false);
+    void synchronizeAllServosStartAndWaitForAllServosToStop();
+
+    bool startGroupMoveD(ServoEasingGroupMoveFunction aGroupMoveFunction, uint_fast16_t aMillisForMove, void * aUserDataPointer = NULL,
+            bool aStartUpdateByInterrupt = true);
+    bool updateGroupMove(); // called by updateAllServos() of the engine
+    void stopGroupMove();
+    bool isGroupMoveActive();
+
+    ServoEasingMask mServoMask; // bit n is set if servo with index n is member of this group
+#if defined(ENABLE_SERVO_EASING_ENGINES)
+    ServoEasingEngine * mEngine; // engine of all servos of this group
+#endif
+    ServoEasingGroup * mNextGroup; // list of all groups, to remove the index of a detached servo, before it is reused by attach()
+
+    /*
+     * State of the coupled group move
+     */
+    ServoEasingGroupMoveFunction mGroupMoveFunction; // != NULL -> group move is active
+    void * mGroupMoveUserDataPointer;
+    uint32_t mGroupMoveMillisAtStart;
+    uint16_t mGroupMoveMillisForCompleteMove;
+    uint8_t mGroupMoveNumberOfServos; // size of the degree array passed to mGroupMoveFunction
+};
+
+#if defined(ENABLE_POSITION_SNAPSHOT)
+#  if !defined(SNAPSHOT_EEPROM_START_ADDRESS)
+#define SNAPSHOT_EEPROM_START_ADDRESS   0
+#  endif
+#  if !defined(SNAPSHOT_NUMBER_OF_SLOTS)
+#define SNAPSHOT_NUMBER_OF_SLOTS        4 // The snapshot is written to the next slot each time, to spread the EEPROM wear
+#  endif
+#define SNAPSHOT_ENTRY_SIZE             5 // 16 bit position, 16 bit trim, 8 bit reverse flag
+#define SNAPSHOT_SLOT_SIZE              (3 + (MAX_EASING_SERVOS * SNAPSHOT_ENTRY_SIZE) + 2) // 16 bit sequence number, 8 bit number of servos, entries, 16 bit CRC
+#  if defined(E2END) && (SNAPSHOT_EEPROM_START_ADDRESS + (SNAPSHOT_NUMBER_OF_SLOTS * SNAPSHOT_SLOT_SIZE)) > (E2END + 1)
+#error "Position snapshot does not fit into EEPROM. Reduce SNAPSHOT_NUMBER_OF_SLOTS or MAX_EASING_SERVOS."
+#  endif
+/*
+ * Snapshot of the servos of the default engine. Call restoreServoPositionSnapshot() after attach() of all servos.
+ */
+bool saveServoPositionSnapshot();
+bool restoreServoPositionSnapshot();
+#endif
+
+#if defined(ENABLE_CALIBRATION_STORE)
+#  if !defined(CALIBRATION_STORE_EEPROM_START_ADDRESS)
+#    if defined(ENABLE_POSITION_SNAPSHOT)
+#define CALIBRATION_STORE_EEPROM_START_ADDRESS  (SNAPSHOT_EEPROM_START_ADDRESS + (SNAPSHOT_NUMBER_OF_SLOTS * SNAPSHOT_SLOT_SIZE)) // behind the snapshot slots
+#    else
+#define CALIBRATION_STORE_EEPROM_START_ADDRESS  0
+#    endif
+#  endif
+#define CALIBRATION_STORE_VERSION       2 // Increment at each change of the record layout. A record with another version is ignored.
+#define CALIBRATION_ENTRY_SIZE          17 // 0 and 180 degree, trim, min, max, speed, slew rate velocity and acceleration, all 16 bit, 8 bit flags
+#define CALIBRATION_STORE_SIZE          (2 + (MAX_EASING_SERVOS * CALIBRATION_ENTRY_SIZE) + 2) // 8 bit version, 8 bit number of servos, entries, 16 bit CRC
+#define CALIBRATION_FLAG_REVERSE        0x01
+#define CALIBRATION_FLAG_PCA9685_UNITS  0x02 // values are PCA9685 units and not microseconds. Entries of the other unit are not applied.
+#define CALIBRATION_FLAG_NO_SERVO       0x80 // entry of an unused servo index is not applied
+#define CALIBRATION_DUMP_LINE_SIZE      (1 + CALIBRATION_ENTRY_SIZE + 2) // servo index, entry, 16 bit CRC of the line -> 40 hex digits
+#  if defined(E2END) && (CALIBRATION_STORE_EEPROM_START_ADDRESS + CALIBRATION_STORE_SIZE) > (E2END + 1)
+#error "Calibration store does not fit into EEPROM. Reduce MAX_EASING_SERVOS or CALIBRATION_STORE_EEPROM_START_ADDRESS."
+#  endif
+/*
+ * Calibration of the servos of the default engine. It is applied by attach() if the store has a valid entry for the servo index.
+ * The dump is one line of hex bytes for each entry, to be read and written by extras/ServoEasingCalibration.py.
+ */
+bool saveCalibrationStore();
+void clearCalibrationStore();
+void printCalibrationStoreDump(Print * aSerial);
+bool readCalibrationStoreDump(Stream * aSerial);
+#endif
+
+#if defined(ENABLE_CALIBRATION_STORE)
+#define SERVO_EASING_EEPROM_SIZE    (CALIBRATION_STORE_EEPROM_START_ADDRESS + CALIBRATION_STORE_SIZE) // for EEPROM.begin() of ESP8266 and ESP32
+#elif defined(ENABLE_POSITION_SNAPSHOT)
+#define SERVO_EASING_EEPROM_SIZE    (SNAPSHOT_EEPROM_START_ADDRESS + (SNAPSHOT_NUMBER_OF_SLOTS * SNAPSHOT_SLOT_SIZE))
+#endif
+
+#if defined(USE_PCA9685_SERVO_EXPANDER)
+/*
+ * Compact servo for many servos at PCA9685 expanders on CPUs with little RAM. 11 bytes per servo.
+ * Calibration and expander address are shared by all servos of one profile.
+ * Supports only easing types without user functions, moves up to 65 seconds and no trim.
+ */
+#define PACKED_SERVO_MAX_PROFILES   4
+
+struct ServoEasingPackedProfile {
+    TwoWire * I2CClass;
+    uint8_t PCA9685I2CAddress;
+    int16_t Servo0DegreeUnits;
+    int16_t Servo180DegreeUnits;
+};
+extern ServoEasingPackedProfile * sPackedServoProfileArray[PACKED_SERVO_MAX_PROFILES];
+void setPackedServoProfile(uint_fast8_t aProfileIndex, ServoEasingPackedProfile * aProfile, uint8_t aPCA9685I2CAddress,
+        int aMicrosecondsForServo0Degree = DEFAULT_MICROSECONDS_FOR_0_DEGREE,
+        int aMicrosecondsForServo180Degree = DEFAULT_MICROSECONDS_FOR_180_DEGREE, TwoWire * aI2CClass = &Wire);
+
+class ServoEasingPacked {
+public:
+    bool attach(uint_fast8_t aPCA9685Channel, uint_fast8_t aProfileIndex = 0); // false if profile is not set
+    void setReverseOperation(bool aOperateServoReverse);
+#ifndef PROVIDE_ONLY_LINEAR_MOVEMENT
+    void setEasingType(uint_fast8_t aEasingType);
+#endif
+    void write(int aDegree);
+    void writeUnits(int aUnits);
+    bool startEaseTo(int aDegree, uint_fast16_t aDegreesPerSecond, bool aStartUpdateByInterrupt = true);
+    bool startEaseToD(int aDegree, uint16_t aMillisForMove, bool aStartUpdateByInterrupt = true);
+    void stop();
+    bool update();
+    bool isMoving();
+    int getCurrentAngle();
+    int DegreeToUnits(int aDegree);
+    int UnitsToDegree(int aUnits);
+
+    uint16_t mCurrentUnits :12;
+    uint16_t mPCA9685Channel :4;
+    uint16_t mStartUnits :12;
+    uint16_t mProfileIndex :2;
+    uint16_t mOperateServoReverse :1;
+    uint16_t mServoMoves :1;          // is only set by the main program and only cleared by update()
+    int16_t mDeltaUnits;
+    uint16_t mMillisAtStartMove;      // lower 16 bit of millis()
+    uint16_t mMillisForCompleteMove;
+    uint8_t mEasingType;
+};
+#if __cplusplus >= 201103L
+#  if defined(__AVR__)
+static_assert(sizeof(ServoEasingPacked) <= 11, "ServoEasingPacked got bigger than 11 bytes");
+#  else
+// 16 and 32 bit platforms pad it to 12 bytes
+static_assert(sizeof(ServoEasingPacked) <= 12, "ServoEasingPacked got bigger than 12 bytes");
+#  endif
+#endif
+
+extern ServoEasingPacked * sPackedServoArray;
+extern uint8_t sNumberOfPackedServos;
+void setPackedServoArray(ServoEasingPacked * aPackedServoArray, uint8_t aNumberOfPackedServos);
+bool updateAllPackedServos();
+bool isOnePackedServoMoving();
+void stopAllPackedServos();
+#endif // defined(USE_PCA9685_SERVO_EXPANDER)
+
 /*
  * Included easing functions
  */
@@ -603,6 +1613,9 @@ float ElasticEaseIn(float aPercentageOfCompletion);
 // Non symmetric functions
 float EaseOutBounce(float aPercentageOfCompletion);
 
+float callIncludedEasingFunction(uint_fast8_t aEasingType, float aPercentageOfCompletion);
+float callIncludedEasingFunctionWithCallStyle(uint_fast8_t aEasingType, float aPercentageOfCompletion);
+
 extern float (*sEaseFunctionArray[])(float aPercentageOfCompletion);
 
 #define STR_HELPER(x) #x